@@ -0,0 +1,303 @@
+#include "asset_loader.h"
+
+#include "log.h"
+#include "render_backend.h"
+#include "shader_library.h"
+#include "sound_library.h"
+#include "texture_library.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <magic_enum/magic_enum.hpp>
+
+namespace {
+float elapsed_ms(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<float, std::milli>(
+             std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+// Empty when the file can't be read
+std::string read_file(const std::string &path) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open()) {
+    return {};
+  }
+  return std::string(std::istreambuf_iterator<char>(ifs),
+                     std::istreambuf_iterator<char>());
+}
+} // namespace
+
+AssetLoader &AssetLoader::get() {
+  static AssetLoader loader;
+  return loader;
+}
+
+void AssetLoader::queue_texture(const std::string &name,
+                                const std::string &path) {
+  std::lock_guard<std::mutex> lock(mtx);
+  jobs.push_back({Kind::Texture, name, path, ShaderType::entity, {}});
+  queued++;
+}
+
+void AssetLoader::queue_sound(const std::string &name,
+                              const std::string &path) {
+  std::lock_guard<std::mutex> lock(mtx);
+  jobs.push_back({Kind::Sound, name, path, ShaderType::entity, {}});
+  queued++;
+}
+
+void AssetLoader::queue_shader(ShaderType type) {
+  std::lock_guard<std::mutex> lock(mtx);
+  jobs.push_back({Kind::Shader, std::string(magic_enum::enum_name(type)),
+                  ShaderLibrary::fragment_path(type), type, {}});
+  queued++;
+}
+
+void AssetLoader::queue_text(
+    const std::string &name, const std::string &path,
+    std::function<void(const std::string &)> on_loaded) {
+  std::lock_guard<std::mutex> lock(mtx);
+  jobs.push_back(
+      {Kind::Text, name, path, ShaderType::entity, std::move(on_loaded)});
+  queued++;
+}
+
+void AssetLoader::start() {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!threads.empty() || jobs.empty()) {
+    return;
+  }
+  started_at = Clock::now();
+  size_t count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1,
+                                    kMaxThreads);
+  count = std::min(count, jobs.size());
+  for (size_t i = 0; i < count; ++i) {
+    threads.emplace_back([this] { worker_loop(); });
+  }
+}
+
+void AssetLoader::worker_loop() {
+  while (true) {
+    Job job;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      // Everything is queued up front, so an empty queue means we're done
+      if (stopping || jobs.empty()) {
+        return;
+      }
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+
+    Decoded item = decode(std::move(job));
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopping) {
+      release(item);
+      return;
+    }
+    decoded.push_back(std::move(item));
+  }
+}
+
+AssetLoader::Decoded AssetLoader::decode(Job job) {
+  Clock::time_point begin = Clock::now();
+  Decoded item;
+  switch (job.kind) {
+  case Kind::Texture:
+    item.image = raylib::LoadImage(job.path.c_str());
+    break;
+  case Kind::Sound:
+    item.wave = raylib::LoadWave(job.path.c_str());
+    break;
+  case Kind::Shader:
+    item.vertex_text = read_file(ShaderLibrary::vertex_path());
+    item.text = read_file(job.path);
+    break;
+  case Kind::Text:
+    item.text = read_file(job.path);
+    break;
+  }
+  item.job = std::move(job);
+  item.decode_ms = elapsed_ms(begin);
+  return item;
+}
+
+bool AssetLoader::upload_for(float budget_ms) {
+  Clock::time_point begin = Clock::now();
+  while (!done() && elapsed_ms(begin) < budget_ms) {
+    Decoded item;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (decoded.empty()) {
+        break;
+      }
+      item = std::move(decoded.front());
+      decoded.pop_front();
+    }
+    upload(item);
+  }
+  return done();
+}
+
+void AssetLoader::upload(Decoded &item) {
+  Clock::time_point begin = Clock::now();
+  bool loaded = true;
+  const Job &job = item.job;
+
+  switch (job.kind) {
+  case Kind::Texture: {
+    loaded = item.image.data != nullptr;
+    // Failed loads are still stored, like TextureLibrary::load does, so
+    // lookups get an empty texture instead of a missing key
+    raylib::Texture2D texture =
+        loaded ? raylib::LoadTextureFromImage(item.image)
+               : raylib::Texture2D{};
+    TextureLibrary::get().add(job.name.c_str(), texture);
+    break;
+  }
+  case Kind::Sound: {
+    loaded = item.wave.data != nullptr;
+    raylib::Sound sound =
+        loaded ? raylib::LoadSoundFromWave(item.wave) : raylib::Sound{};
+    SoundLibrary::get().add(job.name.c_str(), sound);
+    break;
+  }
+  case Kind::Shader: {
+    // A missing stage falls back to raylib's default, as with LoadShader
+    loaded = !item.text.empty();
+    ShaderLibrary::get().add(
+        job.shader,
+        raylib::LoadShaderFromMemory(
+            item.vertex_text.empty() ? nullptr : item.vertex_text.c_str(),
+            item.text.empty() ? nullptr : item.text.c_str()));
+    break;
+  }
+  case Kind::Text:
+    loaded = !item.text.empty();
+    if (loaded && job.on_loaded) {
+      job.on_loaded(item.text);
+    }
+    break;
+  }
+
+  if (!loaded) {
+    log_warn("failed to load asset {} from {}", job.name, job.path);
+  }
+  release(item);
+  finished.push_back(
+      {job.name, job.kind, item.decode_ms, elapsed_ms(begin), loaded});
+  uploaded++;
+}
+
+void AssetLoader::release(Decoded &item) {
+  if (item.image.data != nullptr) {
+    raylib::UnloadImage(item.image);
+    item.image = {};
+  }
+  if (item.wave.data != nullptr) {
+    raylib::UnloadWave(item.wave);
+    item.wave = {};
+  }
+}
+
+float AssetLoader::progress() const {
+  return queued == 0 ? 1.0f
+                     : static_cast<float>(uploaded) /
+                           static_cast<float>(queued);
+}
+
+void AssetLoader::finish_with_progress_screen() {
+  if (queued == 0) {
+    return;
+  }
+  start();
+  while (!upload_for(kUploadBudgetMs)) {
+    if (raylib::IsWindowReady()) {
+      draw_progress_screen();
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  join();
+  report_timings();
+}
+
+void AssetLoader::draw_progress_screen() const {
+  int width = raylib::GetScreenWidth();
+  int height = raylib::GetScreenHeight();
+  float bar_width = static_cast<float>(width) * 0.5f;
+  float bar_height = 16.0f;
+  float bar_x = (static_cast<float>(width) - bar_width) / 2.0f;
+  float bar_y = static_cast<float>(height) / 2.0f;
+
+  render_backend::BeginDrawing();
+  render_backend::ClearBackground(raylib::BLACK);
+  render_backend::DrawText("Loading...", static_cast<int>(bar_x),
+                           static_cast<int>(bar_y) - 30, 20, raylib::WHITE);
+  render_backend::DrawRectangleRec(
+      raylib::Rectangle{bar_x, bar_y, bar_width * progress(), bar_height},
+      raylib::WHITE);
+  render_backend::DrawRectangleLinesEx(
+      raylib::Rectangle{bar_x, bar_y, bar_width, bar_height}, 2.0f,
+      raylib::WHITE);
+  render_backend::EndDrawing();
+}
+
+void AssetLoader::report_timings() const {
+  float decode_total = 0.0f;
+  float upload_total = 0.0f;
+  for (const AssetTiming &timing : finished) {
+    decode_total += timing.decode_ms;
+    upload_total += timing.upload_ms;
+  }
+  log_info("ASSETS: Loaded {} assets in {:.1f}ms ({:.1f}ms decoding across "
+           "workers, {:.1f}ms uploading)",
+           finished.size(), elapsed_ms(started_at), decode_total,
+           upload_total);
+
+  std::vector<const AssetTiming *> slowest;
+  slowest.reserve(finished.size());
+  for (const AssetTiming &timing : finished) {
+    slowest.push_back(&timing);
+  }
+  std::sort(slowest.begin(), slowest.end(), [](auto *a, auto *b) {
+    return a->decode_ms + a->upload_ms > b->decode_ms + b->upload_ms;
+  });
+
+  for (size_t i = 0; i < slowest.size(); ++i) {
+    const AssetTiming &timing = *slowest[i];
+    if (i < kReportedAssets) {
+      log_info("ASSETS: {} {} decode {:.2f}ms upload {:.2f}ms",
+               magic_enum::enum_name(timing.kind), timing.name,
+               timing.decode_ms, timing.upload_ms);
+    } else {
+      log_trace("ASSETS: {} {} decode {:.2f}ms upload {:.2f}ms",
+                magic_enum::enum_name(timing.kind), timing.name,
+                timing.decode_ms, timing.upload_ms);
+    }
+  }
+}
+
+void AssetLoader::join() {
+  for (std::thread &thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  threads.clear();
+}
+
+void AssetLoader::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+    jobs.clear();
+  }
+  join();
+  for (Decoded &item : decoded) {
+    release(item);
+  }
+  decoded.clear();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "rl.h"
+#include "shader_types.h"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loads startup assets in two stages. Worker threads read and decode files
+// (images, waves, shader source, text) into CPU memory; the main thread then
+// creates the GPU and audio objects a time slice at a time, since raylib's
+// GL and audio calls aren't thread safe. Preload draws a progress screen
+// between slices.
+struct AssetLoader {
+  enum struct Kind { Texture, Sound, Shader, Text };
+
+  struct AssetTiming {
+    std::string name;
+    Kind kind = Kind::Texture;
+    float decode_ms = 0.0f;
+    float upload_ms = 0.0f;
+    bool loaded = true;
+  };
+
+  static AssetLoader &get();
+
+  AssetLoader() = default;
+  AssetLoader(const AssetLoader &) = delete;
+  AssetLoader &operator=(const AssetLoader &) = delete;
+  ~AssetLoader() { stop(); }
+
+  // Queue everything before start()
+  void queue_texture(const std::string &name, const std::string &path);
+  void queue_sound(const std::string &name, const std::string &path);
+  void queue_shader(ShaderType type);
+  // on_loaded runs on the main thread with the file's contents
+  void queue_text(const std::string &name, const std::string &path,
+                  std::function<void(const std::string &)> on_loaded);
+
+  // Starts decoding on worker threads and returns immediately
+  void start();
+  // Hands decoded assets to their libraries until budget_ms has passed.
+  // Returns true once every queued asset has been handed over.
+  bool upload_for(float budget_ms);
+  bool done() const { return uploaded == queued; }
+  float progress() const;
+  // Runs upload_for between frames of a loading screen until done, then
+  // logs per-asset timings
+  void finish_with_progress_screen();
+  void stop();
+
+  const std::vector<AssetTiming> &timings() const { return finished; }
+
+private:
+  static constexpr size_t kMaxThreads = 8;
+  static constexpr float kUploadBudgetMs = 8.0f;
+  static constexpr size_t kReportedAssets = 10;
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    Kind kind = Kind::Texture;
+    std::string name;
+    std::string path;
+    ShaderType shader = ShaderType::entity;
+    std::function<void(const std::string &)> on_loaded;
+  };
+
+  struct Decoded {
+    Job job;
+    raylib::Image image{};
+    raylib::Wave wave{};
+    std::string text;
+    std::string vertex_text;
+    float decode_ms = 0.0f;
+  };
+
+  std::mutex mtx;
+  std::deque<Job> jobs;
+  std::deque<Decoded> decoded;
+  std::vector<std::thread> threads;
+  bool stopping = false;
+
+  // Main thread only
+  size_t queued = 0;
+  size_t uploaded = 0;
+  std::vector<AssetTiming> finished;
+  Clock::time_point started_at;
+
+  void worker_loop();
+  static Decoded decode(Job job);
+  void upload(Decoded &item);
+  static void release(Decoded &item);
+  void draw_progress_screen() const;
+  void report_timings() const;
+  void join();
+};
@@ -24,6 +24,28 @@ struct BattleTiming {
     return kPostPauseMs / render_backend::timing_speed_scale;
   }
 
+  static float get_cadence_pause(bool pre_pause) {
+    return pre_pause ? get_pre_pause() : get_post_pause();
+  }
+
+  // Adds one tick to a combat timer and reports whether it reached limit.
+  // ResolveCombatTickSystem, BattleProcessor and the server's idle skipping
+  // all count down through this, so they can't drift apart.
+  static bool advance_timer(float &timer, float dt, float limit) {
+    timer += dt;
+    return !(timer < limit);
+  }
+
+  // Ticks advance_timer can take before the timer reaches limit. Float sums
+  // depend on order, so this steps rather than dividing.
+  static int ticks_until(float timer, float dt, float limit, int max_ticks) {
+    int ticks = 0;
+    while (ticks < max_ticks && !advance_timer(timer, dt, limit)) {
+      ticks++;
+    }
+    return ticks;
+  }
+
   static float get_enter_duration() {
     return kEnterDuration / render_backend::timing_speed_scale;
   }
@@ -1,11 +1,16 @@
 #pragma once
 
 #include <afterhours/ah.h>
+#include <nlohmann/json.hpp>
 #include <string>
 
 struct BattleLoadRequest : afterhours::BaseComponent {
   std::string playerJsonPath = "";
   std::string opponentJsonPath = "";
+  // Already-parsed teams; when set, loaders use these instead of reading the
+  // json paths, which then only identify the battle
+  nlohmann::json playerTeamJson;
+  nlohmann::json opponentTeamJson;
   std::string serverUrl = "";
   bool loaded = false;
   bool serverRequestPending = false;
@@ -12,7 +12,7 @@
 
 // Implementation of BattleProcessor methods
 void BattleProcessor::startBattle(const BattleInput &input) {
-  log_info("BATTLE_PROCESSOR_START: Starting battle - playerPath={}, opponentPath={}", input.playerJsonPath, input.opponentJsonPath);
+  log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_START: Starting battle - playerPath={}, opponentPath={}", input.playerJsonPath, input.opponentJsonPath);
   activeBattle = input;
   playerDishes.clear();
   opponentDishes.clear();
@@ -26,12 +26,20 @@ void BattleProcessor::startBattle(const BattleInput &input) {
   ties = 0;
   simulationTime = 0.0f;
   finished = false; // Reset finished flag when starting new battle
-  log_info("BATTLE_PROCESSOR_START: Battle initialized - simulationComplete={}, currentCourse={}, playerDishes={}, opponentDishes={}, finished={}", 
+  log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_START: Battle initialized - simulationComplete={}, currentCourse={}, playerDishes={}, opponentDishes={}, finished={}", 
            (int)simulationComplete, currentCourse, playerDishes.size(), opponentDishes.size(), (int)finished);
 
-  // Load teams from JSON files
-  loadTeamFromJson(input.playerJsonPath, true);
-  loadTeamFromJson(input.opponentJsonPath, false);
+  // Load teams, preferring data handed over in memory
+  if (!input.playerTeamJson.is_null()) {
+    loadTeam(input.playerTeamJson, true);
+  } else {
+    loadTeamFromJson(input.playerJsonPath, true);
+  }
+  if (!input.opponentTeamJson.is_null()) {
+    loadTeam(input.opponentTeamJson, false);
+  } else {
+    loadTeamFromJson(input.opponentJsonPath, false);
+  }
 
   initializeDishes();
 }
@@ -41,13 +49,13 @@ void BattleProcessor::updateSimulation(float dt) {
   static int call_count = 0;
   call_count++;
   if (call_count % 60 == 0 || call_count <= 10) { // Log first 10 calls and every 60 after
-    log_info("BATTLE_SIM: updateSimulation CALLED - call={}, complete={}, time={:.2f}, course={}, dishes={}/{}", 
+    log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: updateSimulation CALLED - call={}, complete={}, time={:.2f}, course={}, dishes={}/{}", 
              call_count, (int)simulationComplete, simulationTime, currentCourse, playerDishes.size(), opponentDishes.size());
   }
   
   if (simulationComplete) {
     if (call_count % 60 == 0 || call_count <= 10) {
-      log_info("BATTLE_SIM: updateSimulation EARLY RETURN - simulationComplete=true, call={}", call_count);
+      log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: updateSimulation EARLY RETURN - simulationComplete=true, call={}", call_count);
     }
     return;
   }
@@ -78,37 +86,37 @@ void BattleProcessor::finishBattle() {
   // CRITICAL: Check simulationComplete FIRST, before any other operations
   // This prevents crashes if the battle already finished and BattleResult was created
   if (simulationComplete) {
-    log_info("BATTLE_PROCESSOR_FINISH: Battle already completed naturally, just clearing activeBattle - finished={}, isBattleActive={}", 
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Battle already completed naturally, just clearing activeBattle - finished={}, isBattleActive={}", 
              (int)finished, (int)isBattleActive());
     activeBattle.reset();
     finished = true;
     return;
   }
   
-  log_info("BATTLE_PROCESSOR_FINISH: Called - finished={}, isBattleActive={}, simulationComplete={}, activeBattle.has_value={}", 
+  log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Called - finished={}, isBattleActive={}, simulationComplete={}, activeBattle.has_value={}", 
            (int)finished, (int)isBattleActive(), (int)simulationComplete, activeBattle.has_value() ? 1 : 0);
   
   if (finished) {
-    log_info("BATTLE_PROCESSOR_FINISH: Already finished, returning early");
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Already finished, returning early");
     return;
   }
   
   if (!activeBattle.has_value()) {
-    log_info("BATTLE_PROCESSOR_FINISH: No active battle, returning early");
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: No active battle, returning early");
     finished = true; // Mark as finished to prevent future calls
     return;
   }
   
   // Wrap entire function in try/catch for safety
   try {
-    log_info("BATTLE_PROCESSOR_FINISH: Starting battle finish - playerWins={}, opponentWins={}, ties={}, outcomes.size={}", 
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Starting battle finish - playerWins={}, opponentWins={}, ties={}, outcomes.size={}", 
              playerWins, opponentWins, ties, outcomes.size());
     
     // Step 2: Handle incomplete battles gracefully
     // If battle hasn't completed naturally, create a partial result
     bool isComplete = simulationComplete || (currentCourse >= totalCourses);
     if (!isComplete) {
-      log_info("BATTLE_PROCESSOR_FINISH: Battle incomplete (currentCourse={}, totalCourses={}), creating partial result", 
+      log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Battle incomplete (currentCourse={}, totalCourses={}), creating partial result", 
                currentCourse, totalCourses);
     }
     
@@ -118,7 +126,7 @@ void BattleProcessor::finishBattle() {
     // Determine overall outcome - handle case where no courses completed
     if (outcomes.empty() && playerWins == 0 && opponentWins == 0 && ties == 0) {
       // No courses completed - default to tie
-      log_info("BATTLE_PROCESSOR_FINISH: No courses completed, defaulting to tie");
+      log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: No courses completed, defaulting to tie");
       result.outcome = BattleResult::Outcome::Tie;
     } else if (playerWins > opponentWins) {
       result.outcome = BattleResult::Outcome::PlayerWin;
@@ -133,7 +141,7 @@ void BattleProcessor::finishBattle() {
     result.ties = ties;
 
     // Convert outcomes - safely iterate even if empty
-    log_info("BATTLE_PROCESSOR_FINISH: Converting {} outcomes", outcomes.size());
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Converting {} outcomes", outcomes.size());
     for (const auto &outcome : outcomes) {
     BattleResult::CourseOutcome courseOutcome;
     courseOutcome.slotIndex = outcome.slotIndex;
@@ -153,49 +161,49 @@ void BattleProcessor::finishBattle() {
 
       result.outcomes.push_back(courseOutcome);
     }
-    log_info("BATTLE_PROCESSOR_FINISH: Converted {} outcomes to BattleResult", result.outcomes.size());
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Converted {} outcomes to BattleResult", result.outcomes.size());
 
     // Create or update BattleResult singleton
-    log_info("BATTLE_PROCESSOR_FINISH: Accessing BattleResult singleton");
-    log_info("BATTLE_PROCESSOR_FINISH: Singleton exists={}",
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Accessing BattleResult singleton");
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Singleton exists={}",
              afterhours::EntityHelper::has_singleton<BattleResult>() ? 1 : 0);
 
-  log_info("BATTLE_PROCESSOR_FINISH: Creating or updating BattleResult singleton");
+  log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Creating or updating BattleResult singleton");
   try {
     if (afterhours::EntityHelper::has_singleton<BattleResult>()) {
       auto ref = afterhours::EntityHelper::get_singleton<BattleResult>();
       ref.get().removeComponent<BattleResult>();
       ref.get().addComponent<BattleResult>(std::move(result));
-      log_info("BATTLE_PROCESSOR_FINISH: Updated existing BattleResult singleton");
+      log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Updated existing BattleResult singleton");
     } else {
       auto &entity = afterhours::EntityHelper::createEntity();
       entity.addComponent<BattleResult>(std::move(result));
       afterhours::EntityHelper::registerSingleton<BattleResult>(entity);
-      log_info("BATTLE_PROCESSOR_FINISH: Successfully created and registered BattleResult singleton");
+      log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Successfully created and registered BattleResult singleton");
     }
   } catch (const std::exception &e) {
-    log_info("BATTLE_PROCESSOR_FINISH: Exception creating BattleResult singleton: {}", e.what());
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Exception creating BattleResult singleton: {}", e.what());
     // If creating singleton fails, we can't continue - but at least we've cleared activeBattle above
     // The battle will be marked as finished, so it won't be called again
   } catch (...) {
-    log_info("BATTLE_PROCESSOR_FINISH: Unknown exception creating BattleResult singleton");
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Unknown exception creating BattleResult singleton");
     // If creating singleton fails, we can't continue - but at least we've cleared activeBattle above
     // The battle will be marked as finished, so it won't be called again
   }
 
     // Clear active battle
-    log_info("BATTLE_PROCESSOR_FINISH: Clearing activeBattle - was_active={}", activeBattle.has_value() ? 1 : 0);
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Clearing activeBattle - was_active={}", activeBattle.has_value() ? 1 : 0);
     activeBattle.reset();
     finished = true; // Mark as finished to prevent multiple calls
-    log_info("BATTLE_PROCESSOR_FINISH: activeBattle cleared - isBattleActive={}, finished={}", 
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: activeBattle cleared - isBattleActive={}, finished={}", 
              activeBattle.has_value() ? 1 : 0, (int)finished);
   } catch (const std::exception &e) {
-    log_info("BATTLE_PROCESSOR_FINISH: Exception caught in finishBattle: {}", e.what());
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Exception caught in finishBattle: {}", e.what());
     // Still mark as finished and clear active battle to prevent retry
     finished = true;
     activeBattle.reset();
   } catch (...) {
-    log_info("BATTLE_PROCESSOR_FINISH: Unknown exception caught in finishBattle");
+    log_info_c(LogCategory::BATTLE_PROCESSOR, "BATTLE_PROCESSOR_FINISH: Unknown exception caught in finishBattle");
     // Still mark as finished and clear active battle to prevent retry
     finished = true;
     activeBattle.reset();
@@ -220,6 +228,10 @@ void BattleProcessor::loadTeamFromJson(const std::string &jsonPath,
     return;
   }
 
+  loadTeam(json, isPlayer);
+}
+
+void BattleProcessor::loadTeam(const nlohmann::json &json, bool isPlayer) {
   if (!json.contains("team") || !json["team"].is_array()) {
     return;
   }
@@ -295,13 +307,13 @@ void BattleProcessor::processCourse(int courseIndex, float dt) {
   if (process_count % 60 == 0 || process_count <= 10) {
     int player_phase = playerDish ? (int)playerDish->phase : -1;
     int opponent_phase = opponentDish ? (int)opponentDish->phase : -1;
-    log_info("BATTLE_SIM: processCourse - course={}, playerDish exists={}, opponentDish exists={}, playerPhase={}, opponentPhase={}, call={}", 
+    log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: processCourse - course={}, playerDish exists={}, opponentDish exists={}, playerPhase={}, opponentPhase={}, call={}", 
              courseIndex, playerDish ? 1 : 0, opponentDish ? 1 : 0, player_phase, opponent_phase, process_count);
   }
 
   if (!playerDish || !opponentDish) {
     if (process_count % 60 == 0 || process_count <= 10) {
-      log_info("BATTLE_SIM: processCourse - No dishes found for course {} (player={}, opponent={})", 
+      log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: processCourse - No dishes found for course {} (player={}, opponent={})", 
                courseIndex, (void*)playerDish, (void*)opponentDish);
     }
     return;
@@ -310,7 +322,7 @@ void BattleProcessor::processCourse(int courseIndex, float dt) {
   // Start entering if both are in queue
   if (playerDish->phase == DishSimData::Phase::InQueue &&
       opponentDish->phase == DishSimData::Phase::InQueue) {
-    log_info("BATTLE_SIM: Course {} - Dishes entering (player slot={}, opponent slot={})", 
+    log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: Course {} - Dishes entering (player slot={}, opponent slot={})", 
              courseIndex, playerDish->slot, opponentDish->slot);
     playerDish->phase = DishSimData::Phase::Entering;
     opponentDish->phase = DishSimData::Phase::Entering;
@@ -320,7 +332,7 @@ void BattleProcessor::processCourse(int courseIndex, float dt) {
   // Handle entering phase
   if (playerDish->phase == DishSimData::Phase::Entering) {
     // Simple enter simulation - just move to combat after duration
-    log_info("BATTLE_SIM: Course {} - Dishes entering combat (player slot={}, opponent slot={})", 
+    log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: Course {} - Dishes entering combat (player slot={}, opponent slot={})", 
              courseIndex, playerDish->slot, opponentDish->slot);
     playerDish->phase = DishSimData::Phase::InCombat;
     opponentDish->phase = DishSimData::Phase::InCombat;
@@ -331,13 +343,13 @@ void BattleProcessor::processCourse(int courseIndex, float dt) {
   if (playerDish->phase == DishSimData::Phase::InCombat &&
       opponentDish->phase == DishSimData::Phase::InCombat) {
     if (process_count % 60 == 0 || process_count <= 10) {
-      log_info("BATTLE_SIM: Course {} - Calling resolveCombatTick (player slot={}, opponent slot={}, dt={})", 
+      log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: Course {} - Calling resolveCombatTick (player slot={}, opponent slot={}, dt={})", 
                courseIndex, playerDish->slot, opponentDish->slot, dt);
     }
     resolveCombatTick(*playerDish, *opponentDish, dt);
   } else {
     if (process_count % 60 == 0 || process_count <= 10) {
-      log_info("BATTLE_SIM: Course {} - NOT calling resolveCombatTick - playerPhase={}, opponentPhase={}", 
+      log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: Course {} - NOT calling resolveCombatTick - playerPhase={}, opponentPhase={}", 
                courseIndex, (int)playerDish->phase, (int)opponentDish->phase);
     }
   }
@@ -349,13 +361,12 @@ void BattleProcessor::resolveCombatTick(DishSimData &player,
   if (!player.isPlayer)
     return;
 
-  player.biteTimer += dt;
   static int early_return_count = 0;
   early_return_count++;
   float tick_duration = BattleTiming::get_tick_duration();
-  if (player.biteTimer < tick_duration) {
+  if (!BattleTiming::advance_timer(player.biteTimer, dt, tick_duration)) {
     if (early_return_count % 60 == 0 || early_return_count <= 10) {
-      log_info("BATTLE_SIM: resolveCombatTick early return - biteTimer={:.3f} < tick_duration={:.3f}, dt={:.3f}, call={}", 
+      log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: resolveCombatTick early return - biteTimer={:.3f} < tick_duration={:.3f}, dt={:.3f}, call={}", 
                player.biteTimer, tick_duration, dt, early_return_count);
     }
     return;
@@ -366,7 +377,7 @@ void BattleProcessor::resolveCombatTick(DishSimData &player,
   // Mark first bite as decided (for initialization tracking)
   if (!player.firstBiteDecided) {
     player.firstBiteDecided = true;
-    log_info("BATTLE_SIM: Course {} - First combat tick (player slot={} body={}, opponent slot={} body={})", 
+    log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: Course {} - First combat tick (player slot={} body={}, opponent slot={} body={})", 
              player.slot, player.slot, player.currentBody, opponent.slot, opponent.currentBody);
   }
 
@@ -384,14 +395,14 @@ void BattleProcessor::resolveCombatTick(DishSimData &player,
   static int tick_count = 0;
   tick_count++;
   if (tick_count % 10 == 0) { // Log every 10 ticks to avoid spam
-    log_info("BATTLE_SIM: Course {} - Combat tick {} (player slot={} body: {}->{}, opponent slot={} body: {}->{})", 
+    log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: Course {} - Combat tick {} (player slot={} body: {}->{}, opponent slot={} body: {}->{})", 
              player.slot, tick_count, player.slot, old_player_body, player.currentBody, 
              opponent.slot, old_opponent_body, opponent.currentBody);
   }
 
   // Check if either dish is defeated
   if (player.currentBody <= 0 || opponent.currentBody <= 0) {
-    log_info("BATTLE_SIM: Course {} - Dish defeated (player body={}, opponent body={})", 
+    log_info_c(LogCategory::BATTLE_SIM, "BATTLE_SIM: Course {} - Dish defeated (player body={}, opponent body={})", 
              player.slot, player.currentBody, opponent.currentBody);
     finishCourse(player, opponent);
   }
@@ -437,7 +448,7 @@ BattleProcessor::DishSimData *BattleProcessor::findDishForSlot(int slot,
 
 std::pair<int, int> BattleProcessor::calculateDishStats(int dishType,
                                                         int level) {
-  auto dishInfo = get_dish_info(static_cast<DishType>(dishType));
+  const auto &dishInfo = get_dish_info(static_cast<DishType>(dishType));
   const FlavorStats &flavor = dishInfo.flavor;
 
   int zing = flavor.zing();
@@ -72,6 +72,7 @@ struct BattleProcessor : afterhours::BaseComponent {
 
 private:
   void loadTeamFromJson(const std::string &jsonPath, bool isPlayer);
+  void loadTeam(const nlohmann::json &json, bool isPlayer);
   void initializeDishes();
   void processCourse(int courseIndex, float dt);
   void resolveCombatTick(DishSimData &player, DishSimData &opponent, float dt);
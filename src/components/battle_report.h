@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../utils/battle_event_log.h"
 #include <afterhours/ah.h>
 #include <chrono>
 #include <iomanip>
@@ -47,6 +48,14 @@ struct BattleReport : afterhours::BaseComponent {
     }
     if (j.contains("events") && j["events"].is_array()) {
       events = j["events"].get<std::vector<nlohmann::json>>();
+    } else if (j.contains("eventLog") && j["eventLog"].is_string()) {
+      auto bytes =
+          BattleEventLog::from_base64(j["eventLog"].get<std::string>());
+      auto decoded = bytes ? BattleEventLog::decode(*bytes) : std::nullopt;
+      if (decoded) {
+        events = BattleEventLog::to_json(*decoded)
+                     .get<std::vector<nlohmann::json>>();
+      }
     }
   }
 
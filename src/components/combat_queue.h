@@ -1,7 +1,15 @@
 #pragma once
 
 #include <afterhours/ah.h>
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <vector>
+
+struct FingerprintCheckpoint {
+  std::string label; // "start", "course_N" or "end"
+  uint64_t hash = 0;
+};
 
 struct CombatQueue : afterhours::BaseComponent {
   int current_index; // 0..6
@@ -9,6 +17,9 @@ struct CombatQueue : afterhours::BaseComponent {
   bool complete;
   std::optional<int> current_player_dish_id;   // Track which dish is fighting for player side
   std::optional<int> current_opponent_dish_id; // Track which dish is fighting for opponent side
+  // Battle state hashed at the start, after every course and at the end
+  std::vector<FingerprintCheckpoint> fingerprint_checkpoints;
+  uint64_t fingerprint; // Rolling hash of fingerprint_checkpoints
 
   CombatQueue() { reset(); }
 
@@ -18,5 +29,7 @@ struct CombatQueue : afterhours::BaseComponent {
     complete = false;
     current_player_dish_id = std::nullopt;
     current_opponent_dish_id = std::nullopt;
+    fingerprint_checkpoints.clear();
+    fingerprint = 0;
   }
 };
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "animation_event.h"
+#include "battle_processor.h"
+#include "combat_queue.h"
+#include "dish_battle_state.h"
+#include "status_effects.h"
+#include "trigger_event.h"
+#include <afterhours/ah.h>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Plain copies of the battle-relevant state, since components themselves
+// can't be copied. Captured and restored by BattleSnapshotter.
+struct BattleSnapshot {
+  struct StatDelta {
+    int zing = 0;
+    int body = 0;
+  };
+
+  struct Stats {
+    int baseZing = 0;
+    int baseBody = 0;
+    int currentZing = 0;
+    int currentBody = 0;
+  };
+
+  struct NextDamage {
+    float multiplier = 1.0f;
+    int flatModifier = 0;
+    int count = 1;
+  };
+
+  struct FlavorMods {
+    int satiety = 0;
+    int sweetness = 0;
+    int spice = 0;
+    int acidity = 0;
+    int umami = 0;
+    int richness = 0;
+    int freshness = 0;
+  };
+
+  struct Dish {
+    int id = -1;
+    DishBattleState::TeamSide team_side = DishBattleState::TeamSide::Player;
+    int queue_index = 0;
+    DishBattleState::Phase phase = DishBattleState::Phase::InQueue;
+    float enter_progress = 0.0f;
+    float bite_timer = 0.0f;
+    bool players_turn = true;
+    bool first_bite_decided = false;
+    bool onserve_fired = false;
+    DishBattleState::BiteCadence bite_cadence =
+        DishBattleState::BiteCadence::PrePause;
+    float bite_cadence_timer = 0.0f;
+
+    std::optional<Stats> stats;
+    std::optional<StatDelta> pre_battle;
+    std::optional<StatDelta> pairing_clash;
+    std::optional<StatDelta> persistent;
+    std::optional<StatDelta> pending;
+    std::optional<NextDamage> next_damage;
+    std::optional<FlavorMods> flavor_mods;
+    std::optional<std::vector<StatusEffect>> status_effects;
+    std::optional<afterhours::vec2> position;
+  };
+
+  struct Trigger {
+    TriggerHook hook = TriggerHook::OnServe;
+    int sourceEntityId = 0;
+    int slotIndex = 0;
+    DishBattleState::TeamSide teamSide = DishBattleState::TeamSide::Player;
+    int payloadInt = 0;
+    float payloadFloat = 0.0f;
+  };
+
+  struct Animation {
+    AnimationEventType type = AnimationEventType::SlideIn;
+    int slotIndex = -1;
+    int entityId = -1;
+    std::variant<SlideInData, StatBoostData, FreshnessChainData> data =
+        SlideInData{};
+    bool blocking = false;
+  };
+
+  std::string label; // checkpoint label, or "t<ms>" for timed snapshots
+  int64_t clock_ms = 0;
+  int64_t frame = 0;
+  // BattleFingerprint::compute() at capture, checked again after a restore
+  uint64_t fingerprint = 0;
+
+  int course = 0;
+  int total_courses = 7;
+  bool complete = false;
+  std::optional<int> current_player_dish_id;
+  std::optional<int> current_opponent_dish_id;
+  std::vector<FingerprintCheckpoint> checkpoints;
+  uint64_t checkpoint_hash = 0;
+
+  std::optional<bool> onserve_all_fired;
+  std::mt19937_64 rng;
+  uint64_t rng_seed = 0;
+
+  // BattleProcessor's own copy of the course simulation
+  struct Processor {
+    std::vector<BattleProcessor::DishSimData> playerDishes;
+    std::vector<BattleProcessor::DishSimData> opponentDishes;
+    std::vector<BattleProcessor::CourseOutcome> outcomes;
+    int currentCourse = 0;
+    int totalCourses = 7;
+    bool simulationComplete = false;
+    int playerWins = 0;
+    int opponentWins = 0;
+    int ties = 0;
+    bool simulationStarted = false;
+    float simulationTime = 0.0f;
+    bool finished = false;
+  };
+
+  std::vector<Dish> dishes;
+  std::vector<Trigger> triggers;
+  std::vector<Animation> animations;
+  std::optional<Processor> processor;
+};
+
+// Snapshots of the replay in progress, oldest first, kept next to
+// ReplayState. They're only valid for the entities of the current battle
+// session, so a restart or a new battle clears them.
+struct ReplaySnapshots : afterhours::BaseComponent {
+  std::vector<BattleSnapshot> snapshots;
+
+  void clear() { snapshots.clear(); }
+
+  const BattleSnapshot *newest() const {
+    return snapshots.empty() ? nullptr : &snapshots.back();
+  }
+
+  // Latest snapshot taken at or before ms
+  const BattleSnapshot *at_or_before(int64_t ms) const {
+    const BattleSnapshot *found = nullptr;
+    for (const BattleSnapshot &snapshot : snapshots) {
+      if (snapshot.clock_ms > ms) {
+        break;
+      }
+      found = &snapshot;
+    }
+    return found;
+  }
+
+  // Earliest snapshot taken once the given course was up
+  const BattleSnapshot *for_course(int course) const {
+    for (const BattleSnapshot &snapshot : snapshots) {
+      if (snapshot.course >= course) {
+        return snapshot.course == course ? &snapshot : nullptr;
+      }
+    }
+    return nullptr;
+  }
+};
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <afterhours/ah.h>
+#include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <vector>
 
 struct ReplayState : afterhours::BaseComponent {
   bool active = true; // Always active during battles for replay functionality
   bool paused = false;
   float timeScale = 1.0f;
-  int64_t clockMs = 0;
+  int64_t clockMs = 0; // Battle time played so far, at battle speed
   int64_t targetMs = 0;
   int64_t currentFrame = 0; // Current frame in the replay
   int64_t totalFrames = 0;  // Total length of simulation in frames
@@ -16,6 +20,35 @@ struct ReplayState : afterhours::BaseComponent {
   std::string playerJsonPath;
   std::string opponentJsonPath;
   std::string serverChecksum = ""; // Checksum from server response
+  // Per-checkpoint hashes from the server, compared as the replay runs
+  std::vector<std::string> serverCheckpoints;
+
+  // Pending seek, applied by ReplayControllerSystem: it restores the closest
+  // ReplaySnapshots entry and fast-forwards from there to the target.
+  std::optional<int64_t> seekMs;
+  std::optional<int> seekCourse;
+  bool seekStarted = false;
+  // Set while the battle runs at seek speed; the speed and pause state to
+  // go back to once the target is reached
+  bool fastForwarding = false;
+  float speedBeforeSeek = 1.0f;
+  bool pausedBeforeSeek = false;
 
   ReplayState() = default;
+
+  // Jump to a point in battle time (clockMs)
+  void seek_to_ms(int64_t ms) {
+    seekMs = std::max<int64_t>(ms, 0);
+    seekCourse.reset();
+    seekStarted = false;
+  }
+
+  // Jump to the start of a course
+  void seek_to_course(int course) {
+    seekCourse = std::max(course, 0);
+    seekMs.reset();
+    seekStarted = false;
+  }
+
+  bool seeking() const { return seekMs.has_value() || seekCourse.has_value(); }
 };
@@ -1,5 +1,6 @@
 #include "dish_types.h"
 #include "dish_builder.h"
+#include <array>
 #include <vector>
 
 #include "components/animation_event.h"
@@ -355,7 +356,7 @@ static DishInfo make_fried_egg(int level) {
   }
 }
 
-DishInfo get_dish_info(DishType type, int level) {
+static DishInfo build_dish_info(DishType type, int level) {
   switch (type) {
   case DishType::Potato:
     return make_potato(level);
@@ -621,6 +622,36 @@ DishInfo get_dish_info(DishType type, int level) {
   return DishInfo{};
 }
 
+using DishCatalog =
+    std::array<std::array<DishInfo, kMaxDishLevel>,
+               magic_enum::enum_count<DishType>()>;
+
+static const DishCatalog &dish_catalog() {
+  static const DishCatalog catalog = []() {
+    DishCatalog result;
+    for (DishType type : magic_enum::enum_values<DishType>()) {
+      auto &levels = result[magic_enum::enum_index(type).value()];
+      for (int level = 1; level <= kMaxDishLevel; ++level) {
+        levels[level - 1] = build_dish_info(type, level);
+      }
+    }
+    return result;
+  }();
+  return catalog;
+}
+
+const DishInfo &get_dish_info(DishType type, int level) {
+  if (level < 1 || level > kMaxDishLevel) {
+    level = kMaxDishLevel;
+  }
+  auto index = magic_enum::enum_index(type);
+  if (!index.has_value()) {
+    static const DishInfo empty{};
+    return empty;
+  }
+  return dish_catalog()[index.value()][level - 1];
+}
+
 const std::vector<DishType> &get_default_dish_pool() {
   static const std::vector<DishType> pool = []() {
     auto all_dishes = magic_enum::enum_values<DishType>();
@@ -645,7 +676,7 @@ const std::vector<DishType> &get_dishes_for_tier(int max_tier) {
 
   const auto &all_dishes = get_default_dish_pool();
   for (const auto &dish : all_dishes) {
-    auto info = get_dish_info(dish);
+    const auto &info = get_dish_info(dish);
     if (info.tier <= max_tier) {
       tier_pool.push_back(dish);
     }
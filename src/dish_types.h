@@ -95,7 +95,11 @@ struct DishInfo {
   std::vector<DishEffect> effects;
 };
 
-DishInfo get_dish_info(DishType type, int level = 1);
+constexpr int kMaxDishLevel = 3;
+
+// Returns the catalog entry built once at startup. Levels outside
+// [1, kMaxDishLevel] use the top level, matching the builders' default case.
+const DishInfo &get_dish_info(DishType type, int level = 1);
 
 // Shared pool of dishes used in shop and battle systems
 const std::vector<DishType> &get_default_dish_pool();
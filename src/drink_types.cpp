@@ -6,7 +6,7 @@
 #include <span>
 #include <vector>
 
-DrinkInfo get_drink_info(DrinkType type) {
+static DrinkInfo build_drink_info(DrinkType type) {
   switch (type) {
   case DrinkType::Water:
     return DrinkInfo{"Water", 1, SpriteLocation{7, 5}};
@@ -36,6 +36,25 @@ DrinkInfo get_drink_info(DrinkType type) {
   }
 }
 
+const DrinkInfo &get_drink_info(DrinkType type) {
+  using DrinkCatalog =
+      std::array<DrinkInfo, magic_enum::enum_count<DrinkType>()>;
+  static const DrinkCatalog catalog = []() {
+    DrinkCatalog result;
+    for (DrinkType drink : magic_enum::enum_values<DrinkType>()) {
+      result[magic_enum::enum_index(drink).value()] = build_drink_info(drink);
+    }
+    return result;
+  }();
+
+  auto index = magic_enum::enum_index(type);
+  if (!index.has_value()) {
+    log_error("get_drink_info: Unhandled drink type");
+    return catalog[0];
+  }
+  return catalog[index.value()];
+}
+
 DrinkType get_random_drink() {
   auto all_drinks = magic_enum::enum_values<DrinkType>();
   auto &rng = SeededRng::get();
@@ -24,6 +24,6 @@ struct DrinkInfo {
   SpriteLocation sprite;
 };
 
-DrinkInfo get_drink_info(DrinkType type);
+const DrinkInfo &get_drink_info(DrinkType type);
 DrinkType get_random_drink();
 DrinkType get_random_drink_for_tier(int tier);
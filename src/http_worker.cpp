@@ -0,0 +1,146 @@
+#include "http_worker.h"
+#include "log.h"
+#include <algorithm>
+#include <memory>
+
+HttpWorker &HttpWorker::get() {
+  static HttpWorker worker;
+  return worker;
+}
+
+HttpTicket HttpWorker::submit(HttpRequest request) {
+  HttpTicket ticket = kNoHttpTicket;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopping) {
+      return kNoHttpTicket;
+    }
+    if (threads.empty()) {
+      for (size_t i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([this] { worker_loop(); });
+      }
+    }
+    ticket = next_ticket++;
+    queue.emplace_back(ticket, std::move(request));
+  }
+  queue_cv.notify_one();
+  return ticket;
+}
+
+std::optional<HttpResponse> HttpWorker::poll(HttpTicket ticket) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = mailbox.find(ticket);
+  if (it == mailbox.end()) {
+    return std::nullopt;
+  }
+  HttpResponse response = std::move(it->second);
+  mailbox.erase(it);
+  return response;
+}
+
+void HttpWorker::cancel(HttpTicket ticket) {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (mailbox.erase(ticket) > 0) {
+    return;
+  }
+
+  auto queued = std::find_if(queue.begin(), queue.end(), [ticket](auto &job) {
+    return job.first == ticket;
+  });
+  if (queued != queue.end()) {
+    queue.erase(queued);
+    return;
+  }
+
+  auto running = in_flight.find(ticket);
+  if (running != in_flight.end()) {
+    cancelled.insert(ticket);
+    running->second->stop();
+  }
+}
+
+bool HttpWorker::is_pending(HttpTicket ticket) {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (in_flight.contains(ticket)) {
+    return !cancelled.contains(ticket);
+  }
+  return std::any_of(queue.begin(), queue.end(),
+                     [ticket](auto &job) { return job.first == ticket; });
+}
+
+void HttpWorker::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+    queue.clear();
+    for (auto &[ticket, client] : in_flight) {
+      cancelled.insert(ticket);
+      client->stop();
+    }
+  }
+  queue_cv.notify_all();
+  for (auto &thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  threads.clear();
+}
+
+void HttpWorker::worker_loop() {
+  while (true) {
+    HttpTicket ticket = kNoHttpTicket;
+    HttpRequest request;
+    std::unique_ptr<httplib::Client> client;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (stopping) {
+        return;
+      }
+      ticket = queue.front().first;
+      request = std::move(queue.front().second);
+      queue.pop_front();
+      // Registered before unlocking so cancel() always finds the ticket
+      client = std::make_unique<httplib::Client>(request.host, request.port);
+      in_flight[ticket] = client.get();
+    }
+
+    HttpResponse response = perform(request, *client);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    in_flight.erase(ticket);
+    if (cancelled.erase(ticket) > 0) {
+      continue;
+    }
+    mailbox[ticket] = std::move(response);
+  }
+}
+
+HttpResponse HttpWorker::perform(HttpRequest &request,
+                                 httplib::Client &client) {
+  client.set_connection_timeout(request.connect_timeout_ms / 1000,
+                                (request.connect_timeout_ms % 1000) * 1000);
+  client.set_read_timeout(request.read_timeout_ms / 1000,
+                          (request.read_timeout_ms % 1000) * 1000);
+
+  httplib::Result res = request.method == HttpRequest::Method::Post
+                            ? client.Post(request.path, request.headers,
+                                          request.body, request.content_type)
+                            : client.Get(request.path, request.headers);
+
+  HttpResponse response;
+  if (!res) {
+    log_info("HTTP_WORKER: {} {}:{}{} failed: {}",
+             request.method == HttpRequest::Method::Post ? "POST" : "GET",
+             request.host, request.port, request.path,
+             httplib::to_string(res.error()));
+    return response;
+  }
+
+  response.connected = true;
+  response.status = res->status;
+  response.body = std::move(res->body);
+  response.content_type = res->get_header_value("Content-Type");
+  return response;
+}
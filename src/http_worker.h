@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <httplib.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct HttpRequest {
+  enum struct Method { Get, Post } method = Method::Get;
+  std::string host;
+  int port = 8080;
+  std::string path;
+  httplib::Headers headers;
+  std::string body;
+  std::string content_type;
+  int connect_timeout_ms = 1000;
+  int read_timeout_ms = 2000;
+};
+
+struct HttpResponse {
+  // False when the server couldn't be reached or the request was cancelled
+  bool connected = false;
+  bool cancelled = false;
+  int status = -1;
+  std::string body;
+  std::string content_type;
+};
+
+using HttpTicket = uint64_t;
+constexpr HttpTicket kNoHttpTicket = 0;
+
+// Runs blocking httplib calls on background threads so update systems never
+// wait on the network. Systems submit a request, keep the ticket, and poll
+// it each frame; results sit in a mailbox until polled or cancelled.
+struct HttpWorker {
+  static HttpWorker &get();
+
+  HttpWorker() = default;
+  HttpWorker(const HttpWorker &) = delete;
+  HttpWorker &operator=(const HttpWorker &) = delete;
+  ~HttpWorker() { stop(); }
+
+  HttpTicket submit(HttpRequest request);
+  // Returns the response once it's ready and forgets the ticket
+  std::optional<HttpResponse> poll(HttpTicket ticket);
+  // Drops a queued request or aborts one in flight; its result is discarded
+  void cancel(HttpTicket ticket);
+  bool is_pending(HttpTicket ticket);
+  void stop();
+
+private:
+  static constexpr size_t kThreadCount = 2;
+
+  std::mutex mtx;
+  std::condition_variable queue_cv;
+  std::deque<std::pair<HttpTicket, HttpRequest>> queue;
+  std::unordered_map<HttpTicket, HttpResponse> mailbox;
+  std::unordered_map<HttpTicket, httplib::Client *> in_flight;
+  std::unordered_set<HttpTicket> cancelled;
+  std::vector<std::thread> threads;
+  HttpTicket next_ticket = 1;
+  bool stopping = false;
+
+  void worker_loop();
+  static HttpResponse perform(HttpRequest &request, httplib::Client &client);
+};
@@ -18,6 +18,8 @@ enum class InputAction {
   PauseButton,
   ToggleUIDebug,
   ToggleUILayoutDebug,
+  ToggleSystemProfiler,
+  SaveSystemTrace,
   Honk,
 };
 
@@ -91,6 +93,14 @@ inline auto get_mapping() {
       raylib::KEY_EQUAL,
   };
 
+  mapping[to_int(InputAction::ToggleSystemProfiler)] = {
+      raylib::KEY_F3,
+  };
+
+  mapping[to_int(InputAction::SaveSystemTrace)] = {
+      raylib::KEY_F4,
+  };
+
   mapping[to_int(InputAction::Honk)] = {
       raylib::KEY_H,
       raylib::GAMEPAD_BUTTON_RIGHT_THUMB,
@@ -13,7 +13,9 @@
 
 #include <magic_enum/magic_enum.hpp>
 
+#include "log_category.h"
 #include "log_level.h"
+#include "log_writer.h"
 
 #ifndef AFTER_HOURS_LOG_LEVEL
 #define AFTER_HOURS_LOG_LEVEL LogLevel::LOG_INFO
@@ -37,24 +39,38 @@ inline const std::string_view level_to_string(LogLevel level) {
   return magic_enum::enum_name(level);
 }
 
-inline void vlog(LogLevel level, const char *file, int line,
-                 fmt::string_view format, fmt::format_args args) {
+inline void vlog(LogLevel level, LogCategory category, const char *file,
+                 int line, fmt::string_view format, fmt::format_args args) {
   if (level < AFTER_HOURS_LOG_LEVEL)
     return;
-  auto file_info =
-      fmt::format("{}: {}: {}: ", file, line, level_to_string(level));
-  if (line == -1) {
-    file_info = "";
-  }
+  if (!log_category_admit(category, level))
+    return;
 
   const std::string_view color_start = level >= LogLevel::LOG_WARN //
                                            ? color_red
                                            : color_white;
 
-  const auto message = fmt::vformat(format, args);
-  const auto full_output = fmt::format("{}{}", file_info, message);
-  fmt::print("{}{}{}", color_start, full_output, color_reset);
-  fmt::print("\n");
+  fmt::memory_buffer out;
+  fmt::format_to(std::back_inserter(out), "{}", color_start);
+  if (line != -1) {
+    fmt::format_to(std::back_inserter(out), "{}: {}: {}: ", file, line,
+                   level_to_string(level));
+  }
+  fmt::vformat_to(std::back_inserter(out), format, args);
+  uint64_t suppressed = log_category_state(category).suppressed.exchange(
+      0, std::memory_order_relaxed);
+  if (suppressed > 0) {
+    fmt::format_to(std::back_inserter(out), " (+{} suppressed)", suppressed);
+  }
+  fmt::format_to(std::back_inserter(out), "{}\n", color_reset);
+
+  AsyncLogWriter::get().write(std::string(out.data(), out.size()),
+                              level >= LogLevel::LOG_WARN);
+}
+
+inline void vlog(LogLevel level, const char *file, int line,
+                 fmt::string_view format, fmt::format_args args) {
+  vlog(level, LogCategory::General, file, line, format, args);
 }
 
 template <typename... Args>
@@ -78,6 +94,13 @@ inline void log_me(LogLevel level, const char *file, int line,
        fmt::make_args_checked<const char *>(format, args));
 }
 
+template <typename... Args>
+inline void log_me_c(LogLevel level, LogCategory category, const char *file,
+                     int line, const char *format, Args &&...args) {
+  vlog(level, category, file, line, format,
+       fmt::make_args_checked<Args...>(format, args...));
+}
+
 // Thread-safe storage for log_once_per timing
 namespace {
 static std::unordered_map<std::string, std::chrono::steady_clock::time_point>
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include <magic_enum/magic_enum.hpp>
+
+#include "log_level.h"
+
+// Subsystems that can be tuned at runtime. Anything logged through the
+// plain log_info/log_warn/... macros is General.
+enum struct LogCategory {
+  General,
+  BATTLE_SIM,
+  BATTLE_PROCESSOR,
+  ANIM,
+  COMBAT,
+  EFFECT,
+  SERVER_BATTLE,
+  SERVER_MATCHMAKING,
+  NETWORK,
+  GAME_STATE,
+};
+
+struct LogCategoryState {
+  std::atomic<int> level{static_cast<int>(LogLevel::LOG_ALOG_)};
+  // Keep one of every N messages below LOG_WARN
+  std::atomic<uint32_t> sample_every{1};
+  // Cap on messages below LOG_WARN per second, 0 for no cap
+  std::atomic<uint32_t> max_per_second{0};
+
+  std::atomic<uint64_t> sample_counter{0};
+  std::atomic<int64_t> window_second{0};
+  std::atomic<uint32_t> window_count{0};
+  std::atomic<uint64_t> suppressed{0};
+};
+
+using LogCategoryStates =
+    std::array<LogCategoryState, magic_enum::enum_count<LogCategory>()>;
+
+namespace log_detail {
+inline LogCategoryState &state_of(LogCategoryStates &states,
+                                  LogCategory category) {
+  return states[magic_enum::enum_index(category).value_or(0)];
+}
+
+inline bool configure(LogCategoryStates &states, std::string_view spec);
+} // namespace log_detail
+
+inline LogCategoryStates &log_category_states() {
+  // Leaked on purpose so logging from static destructors stays valid
+  static LogCategoryStates *states = [] {
+    auto *created = new LogCategoryStates();
+    if (const char *env = std::getenv("AFTER_HOURS_LOG_CATEGORIES")) {
+      log_detail::configure(*created, env);
+    }
+    return created;
+  }();
+  return *states;
+}
+
+inline LogCategoryState &log_category_state(LogCategory category) {
+  return log_detail::state_of(log_category_states(), category);
+}
+
+inline void log_set_level(LogCategory category, LogLevel level) {
+  log_category_state(category).level.store(static_cast<int>(level),
+                                           std::memory_order_relaxed);
+}
+
+inline void log_set_sampling(LogCategory category, uint32_t every_n) {
+  log_category_state(category).sample_every.store(every_n == 0 ? 1 : every_n,
+                                                  std::memory_order_relaxed);
+}
+
+inline void log_set_rate_limit(LogCategory category, uint32_t per_second) {
+  log_category_state(category).max_per_second.store(
+      per_second, std::memory_order_relaxed);
+}
+
+// Cheap enough to guard argument evaluation at every call site
+inline bool log_category_enabled(LogCategory category, LogLevel level) {
+  return static_cast<int>(level) >=
+         log_category_state(category).level.load(std::memory_order_relaxed);
+}
+
+// Level check plus sampling and rate limiting. Warnings and errors are never
+// sampled or rate limited.
+inline bool log_category_admit(LogCategory category, LogLevel level) {
+  LogCategoryState &state = log_category_state(category);
+  if (static_cast<int>(level) < state.level.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  if (level >= LogLevel::LOG_WARN) {
+    return true;
+  }
+
+  uint32_t every = state.sample_every.load(std::memory_order_relaxed);
+  if (every > 1 &&
+      state.sample_counter.fetch_add(1, std::memory_order_relaxed) % every !=
+          0) {
+    state.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  uint32_t max = state.max_per_second.load(std::memory_order_relaxed);
+  if (max > 0) {
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+    int64_t window = state.window_second.load(std::memory_order_relaxed);
+    if (window != now && state.window_second.compare_exchange_strong(
+                             window, now, std::memory_order_relaxed)) {
+      state.window_count.store(0, std::memory_order_relaxed);
+    }
+    if (state.window_count.fetch_add(1, std::memory_order_relaxed) >= max) {
+      state.suppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Parses "CATEGORY=LEVEL[:sample=N][:rate=N],..." where LEVEL is a LogLevel
+// name with or without the LOG_ prefix, e.g.
+//   "ANIM=WARN,BATTLE_SIM=INFO:sample=60,SERVER_MATCHMAKING=INFO:rate=20"
+// Returns false if any entry was not understood; valid entries still apply.
+inline bool log_detail::configure(LogCategoryStates &states,
+                                  std::string_view spec) {
+  bool ok = true;
+  while (!spec.empty()) {
+    size_t comma = spec.find(',');
+    std::string_view entry = spec.substr(0, comma);
+    spec = comma == std::string_view::npos ? std::string_view{}
+                                           : spec.substr(comma + 1);
+
+    size_t eq = entry.find('=');
+    if (eq == std::string_view::npos) {
+      ok = ok && entry.empty();
+      continue;
+    }
+    auto category = magic_enum::enum_cast<LogCategory>(entry.substr(0, eq));
+    if (!category) {
+      ok = false;
+      continue;
+    }
+
+    std::string_view options = entry.substr(eq + 1);
+    size_t colon = options.find(':');
+    std::string level_name(options.substr(0, colon));
+    if (level_name.rfind("LOG_", 0) != 0) {
+      level_name = "LOG_" + level_name;
+    }
+    auto level = magic_enum::enum_cast<LogLevel>(level_name);
+    LogCategoryState &state = state_of(states, *category);
+    if (level) {
+      state.level.store(static_cast<int>(*level), std::memory_order_relaxed);
+    } else {
+      ok = false;
+    }
+
+    while (colon != std::string_view::npos) {
+      options = options.substr(colon + 1);
+      colon = options.find(':');
+      std::string_view option = options.substr(0, colon);
+      uint32_t value = static_cast<uint32_t>(
+          std::strtoul(std::string(option.substr(option.find('=') + 1)).c_str(),
+                       nullptr, 10));
+      if (option.rfind("sample=", 0) == 0) {
+        state.sample_every.store(value == 0 ? 1 : value,
+                                 std::memory_order_relaxed);
+      } else if (option.rfind("rate=", 0) == 0) {
+        state.max_per_second.store(value, std::memory_order_relaxed);
+      } else {
+        ok = false;
+      }
+    }
+  }
+  return ok;
+}
+
+inline bool log_configure_categories(std::string_view spec) {
+  return log_detail::configure(log_category_states(), spec);
+}
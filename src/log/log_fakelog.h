@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include "log_category.h"
 #include "log_level.h"
 #include <iostream>
 inline void log_me() { std::cout << std::endl; }
@@ -9,4 +10,9 @@ inline void log_me(const T &arg, const Args &...args) {
   std::cout << arg << " ";
   log_me(args...);
 }
+template <typename... Args>
+inline void log_me_c(LogLevel level, LogCategory, const Args &...args) {
+  log_me(level, args...);
+}
+inline void log_flush() {}
 #include "log_macros.h"
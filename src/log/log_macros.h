@@ -19,6 +19,24 @@
     log_me(LogLevel::LOG_ERROR, __FILE__, __LINE__, __VA_ARGS__);              \
   assert(false)
 
+// Category variants; arguments are only evaluated when the category is
+// enabled at that level
+#define log_trace_c(category, ...)                                             \
+  if (static_cast<int>(LogLevel::LOG_TRACE) >=                                 \
+          static_cast<int>(AFTER_HOURS_LOG_LEVEL) &&                           \
+      log_category_enabled(category, LogLevel::LOG_TRACE))                     \
+  log_me_c(LogLevel::LOG_TRACE, category, __FILE__, __LINE__, __VA_ARGS__)
+#define log_info_c(category, ...)                                              \
+  if (static_cast<int>(LogLevel::LOG_INFO) >=                                  \
+          static_cast<int>(AFTER_HOURS_LOG_LEVEL) &&                           \
+      log_category_enabled(category, LogLevel::LOG_INFO))                      \
+  log_me_c(LogLevel::LOG_INFO, category, __FILE__, __LINE__, __VA_ARGS__)
+#define log_warn_c(category, ...)                                              \
+  if (static_cast<int>(LogLevel::LOG_WARN) >=                                  \
+          static_cast<int>(AFTER_HOURS_LOG_LEVEL) &&                           \
+      log_category_enabled(category, LogLevel::LOG_WARN))                      \
+  log_me_c(LogLevel::LOG_WARN, category, __FILE__, __LINE__, __VA_ARGS__)
+
 #define log_clean(level, ...)                                                  \
   if (static_cast<int>(level) >= static_cast<int>(AFTER_HOURS_LOG_LEVEL))      \
     log_me(level, "", -1, __VA_ARGS__);
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Bounded multi-producer multi-consumer queue (Vyukov). Producers never take
+// a lock; a full queue makes try_push fail instead of blocking.
+template <typename T, size_t Capacity> class LogRingBuffer {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+public:
+  LogRingBuffer() {
+    for (size_t i = 0; i < Capacity; ++i) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool try_push(T &&value) {
+    size_t pos = head.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots[pos & (Capacity - 1)];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (head.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+          slot.value = std::move(value);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(T &out) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots[pos & (Capacity - 1)];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+          out = std::move(slot.value);
+          slot.sequence.store(pos + Capacity, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::array<Slot, Capacity> slots;
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+};
+
+// Moves log output off the calling thread. Lines are queued in a ring buffer
+// and written to stdout by a background thread; warnings and errors flush
+// the queue and write synchronously so nothing is lost before an assert.
+class AsyncLogWriter {
+public:
+  static AsyncLogWriter &get() {
+    // Leaked on purpose so logging from static destructors stays valid;
+    // shutdown() runs from atexit instead
+    static AsyncLogWriter *writer = new AsyncLogWriter();
+    return *writer;
+  }
+
+  void write(std::string &&line, bool urgent) {
+    if (!urgent && ensure_started()) {
+      if (ring.try_push(std::move(line))) {
+        return;
+      }
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(output_mtx);
+    drain_locked();
+    std::fwrite(line.data(), 1, line.size(), stdout);
+    std::fflush(stdout);
+  }
+
+  void flush() {
+    std::lock_guard<std::mutex> lock(output_mtx);
+    drain_locked();
+    std::fflush(stdout);
+  }
+
+  void shutdown() {
+    stopping.store(true, std::memory_order_release);
+    std::thread *thread = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(start_mtx);
+      thread = worker;
+      worker = nullptr;
+    }
+    if (thread != nullptr) {
+      thread->join();
+      delete thread;
+    }
+    flush();
+  }
+
+private:
+  static constexpr size_t kCapacity = 8192;
+
+  LogRingBuffer<std::string, kCapacity> ring;
+  std::atomic<bool> started{false};
+  std::atomic<bool> stopping{false};
+  std::atomic<uint64_t> dropped{0};
+  std::mutex start_mtx;
+  // Held while writing so queued and synchronous lines stay in order
+  std::mutex output_mtx;
+  std::thread *worker = nullptr;
+
+  AsyncLogWriter() = default;
+
+  bool ensure_started() {
+    if (started.load(std::memory_order_acquire)) {
+      return true;
+    }
+    if (stopping.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(start_mtx);
+    if (!started.load(std::memory_order_relaxed)) {
+      static bool hooks_installed = [] {
+        std::atexit([] { AsyncLogWriter::get().shutdown(); });
+#ifndef _WIN32
+        pthread_atfork(
+            [] { AsyncLogWriter::get().before_fork(); },
+            [] { AsyncLogWriter::get().output_mtx.unlock(); },
+            [] { AsyncLogWriter::get().in_child_after_fork(); });
+#endif
+        return true;
+      }();
+      (void)hooks_installed;
+      worker = new std::thread([this] { run(); });
+      started.store(true, std::memory_order_release);
+    }
+    return true;
+  }
+
+  void run() {
+    while (!stopping.load(std::memory_order_acquire)) {
+      bool wrote = false;
+      {
+        std::lock_guard<std::mutex> lock(output_mtx);
+        wrote = drain_locked();
+      }
+      if (!wrote) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+  }
+
+  bool drain_locked() {
+    bool wrote = false;
+    std::string line;
+    while (ring.try_pop(line)) {
+      std::fwrite(line.data(), 1, line.size(), stdout);
+      wrote = true;
+    }
+    uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost > 0) {
+      std::fprintf(stdout, "log: dropped %llu lines, queue full\n",
+                   static_cast<unsigned long long>(lost));
+      wrote = true;
+    }
+    if (wrote) {
+      std::fflush(stdout);
+    }
+    return wrote;
+  }
+
+  // Queued lines are written before forking so the child doesn't repeat
+  // them, and the lock is held so the child never inherits it mid-write
+  void before_fork() {
+    output_mtx.lock();
+    drain_locked();
+    std::fflush(stdout);
+  }
+
+  // The writer thread doesn't exist in the child; start a fresh one lazily
+  void in_child_after_fork() {
+    output_mtx.unlock();
+    worker = nullptr;
+    started.store(false, std::memory_order_release);
+  }
+};
+
+inline void log_flush() { AsyncLogWriter::get().flush(); }
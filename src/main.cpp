@@ -42,6 +42,7 @@ backward::SignalHandling sh;
 #include "systems/NetworkSystem.h"
 #include "systems/PostProcessingSystems.h"
 #include "systems/ProcessBattleRewards.h"
+#include "systems/ProfiledSystem.h"
 #include "systems/RenderAnimations.h"
 #include "systems/RenderBattleResults.h"
 #include "systems/RenderBattleSynergyLegend.h"
@@ -60,6 +61,7 @@ backward::SignalHandling sh;
 #include "systems/RenderSpritesByOrder.h"
 #include "systems/RenderSpritesWithShaders.h"
 #include "systems/RenderSystemHelpers.h"
+#include "systems/RenderSystemProfile.h"
 #include "systems/RenderToastSystem.h"
 #include "systems/RenderWalletHUD.h"
 #include "systems/RenderZingBodyOverlay.h"
@@ -250,21 +252,29 @@ void game(const std::optional<std::string> &run_test) {
       systems.register_render_system(std::make_unique<RenderToastSystem>());
       systems.register_render_system(std::make_unique<RenderTooltipSystem>());
       systems.register_render_system(std::make_unique<RenderFPS>());
+      systems.register_render_system(std::make_unique<RenderSystemProfile>());
       systems.register_render_system(std::make_unique<RenderDebugWindowInfo>());
       systems.register_render_system(std::make_unique<EndDrawing>());
       //
     }
 
+    instrument_systems(systems);
+    SystemProfiler &profiler = SystemProfiler::get();
+
     if (!render_backend::is_headless_mode) {
       while (running && !raylib::WindowShouldClose()) {
         float dt = raylib::GetFrameTime();
+        profiler.begin_frame();
         systems.run(dt * render_backend::timing_speed_scale);
+        profiler.end_frame();
       }
     } else {
       // Headless loop: run with fixed timestep; tests will exit the process
       while (running) {
         float dt = 1.0f / 60.0f;
+        profiler.begin_frame();
         systems.run(dt * render_backend::timing_speed_scale);
+        profiler.end_frame();
       }
     }
   }
@@ -294,6 +304,8 @@ int main(int argc, char *argv[]) {
                  "milliseconds (default: 500)\n";
     std::cout << "  --timing-speed-scale <scale>  Battle timing speed "
                  "multiplier (default: 1.0)\n";
+    std::cout << "  --profile-systems             Record per-system timings "
+                 "and write a Chrome trace on exit\n";
     std::cout << "\n";
     std::cout << "Examples:\n";
     std::cout
@@ -346,6 +358,13 @@ int main(int argc, char *argv[]) {
     log_info("AUDIT STRICT: Enabled - Side effect violations will be logged");
   }
 
+  // Parse profile-systems flag; the trace is written however the game exits
+  if (cmdl["--profile-systems"]) {
+    SystemProfiler::get().set_enabled(true);
+    std::atexit([] { RenderSystemProfile::save_trace(); });
+    log_info("PROFILE SYSTEMS: Enabled - Trace written on exit");
+  }
+
   // Parse step delay flag (only used in non-headless mode)
   int step_delay = 500; // Default 500ms
   cmdl({"--step-delay"}, 500) >> step_delay;
@@ -1,12 +1,12 @@
 #include "preload.h"
 
 #include <iostream>
-#include <sstream>
 #include <vector>
 
 #include "log.h"
 #include "rl.h"
 
+#include "asset_loader.h"
 #include "font_info.h"
 #include "settings.h"
 
@@ -41,16 +41,53 @@ std::string get_font_name(FontID id) {
   return afterhours::ui::UIComponent::DEFAULT_FONT;
 }
 
-static void load_gamepad_mappings() {
-  std::ifstream ifs(
-      Files::get().fetch_resource_path("", "gamecontrollerdb.txt").c_str());
-  if (!ifs.is_open()) {
-    log_warn("failed to load game controller db");
-    return;
+// Everything here is decoded on AssetLoader's workers while the fonts load,
+// then uploaded behind a progress screen in make_singleton
+static void queue_startup_assets() {
+  AssetLoader &loader = AssetLoader::get();
+
+  loader.queue_text(
+      "gamecontrollerdb",
+      Files::get().fetch_resource_path("", "gamecontrollerdb.txt"),
+      [](const std::string &mappings) {
+        input::set_gamepad_mappings(mappings.c_str());
+      });
+
+  for (SoundFile file : magic_enum::enum_values<SoundFile>()) {
+    const char *path = sound_file_path(file);
+    // Skip loading sounds that don't have files available
+    if (path == nullptr) {
+      continue;
+    }
+    loader.queue_sound(sound_file_to_str(file),
+                       Files::get().fetch_resource_path("sounds", path));
   }
-  std::stringstream buffer;
-  buffer << ifs.rdbuf();
-  input::set_gamepad_mappings(buffer.str().c_str());
+
+  // TODO add load folder for shaders
+  loader.queue_shader(ShaderType::post_processing);
+  loader.queue_shader(ShaderType::post_processing_tag);
+  loader.queue_shader(ShaderType::text_mask);
+
+  loader.queue_texture(
+      "spritesheet",
+      Files::get().fetch_resource_path("images", "spritesheet.png"));
+
+  // TODO how safe is the path combination here esp for mac vs windows
+  auto queue_texture = [&loader](const std::string &name,
+                                 const std::string &filename) {
+    loader.queue_texture(name, filename);
+  };
+  Files::get().for_resources_in_folder("images", "controls/keyboard_default",
+                                       queue_texture);
+  Files::get().for_resources_in_folder("images", "controls/xbox_default",
+                                       queue_texture);
+
+  // TODO add to spritesheet
+  loader.queue_texture(
+      "dollar_sign",
+      Files::get().fetch_resource_path("images", "dollar_sign.png"));
+  loader.queue_texture(
+      "trashcan", Files::get().fetch_resource_path("images", "trashcan.png"));
 }
 
 Preload::Preload() {}
@@ -88,47 +125,8 @@ Preload &Preload::init(const char *title, bool headless) {
   }
 
   if (!headless) {
-    load_gamepad_mappings();
-    load_sounds();
-  }
-
-  // TODO add load folder for shaders
-
-  auto load_shader = [](const char *file, const char *name) {
-    std::string path_owned = Files::get().fetch_resource_path("shaders", file);
-    const char *path = path_owned.c_str();
-    ShaderLibrary::get().load(path, name);
-  };
-  if (!headless) {
-    load_shader("post_processing.fs", "post_processing");
-    load_shader("post_processing_tag.fs", "post_processing_tag");
-    load_shader("text_mask.fs", "text_mask");
-  }
-
-  // TODO how safe is the path combination here esp for mac vs windows
-  if (!headless)
-    Files::get().for_resources_in_folder(
-        "images", "controls/keyboard_default",
-        [](const std::string &name, const std::string &filename) {
-          TextureLibrary::get().load(filename.c_str(), name.c_str());
-        });
-
-  // TODO how safe is the path combination here esp for mac vs windows
-  if (!headless)
-    Files::get().for_resources_in_folder(
-        "images", "controls/xbox_default",
-        [](const std::string &name, const std::string &filename) {
-          TextureLibrary::get().load(filename.c_str(), name.c_str());
-        });
-
-  // TODO add to spritesheet
-  if (!headless) {
-    TextureLibrary::get().load(
-        Files::get().fetch_resource_path("images", "dollar_sign.png").c_str(),
-        "dollar_sign");
-    TextureLibrary::get().load(
-        Files::get().fetch_resource_path("images", "trashcan.png").c_str(),
-        "trashcan");
+    queue_startup_assets();
+    AssetLoader::get().start();
   }
 
   return *this;
@@ -181,16 +179,16 @@ Preload &Preload::make_singleton() {
     auto &settings = Settings::get();
     translation_manager::set_language(settings.get_language());
 
+    // Fonts load on this thread while the asset workers decode
+    setup_fonts(ui_root);
+    AssetLoader::get().finish_with_progress_screen();
+
     if (!render_backend::is_headless_mode) {
       texture_manager::add_singleton_components(
-          sophie, raylib::LoadTexture(
-                      Files::get()
-                          .fetch_resource_path("images", "spritesheet.png")
-                          .c_str()));
+          sophie, TextureLibrary::get().get("spritesheet"));
     } else {
       texture_manager::add_singleton_components(sophie, {});
     }
-    setup_fonts(ui_root);
     add_ui_singleton_components(ui_root);
   }
   {
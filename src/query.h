@@ -7,6 +7,9 @@
 #include "math_util.h"
 #include "rl.h"
 #include <afterhours/src/ecs.h>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
 
 using namespace afterhours;
 
@@ -105,6 +108,84 @@ struct EQ : public EntityQuery<EQ> {
     return add_mod(new WhereTeamSide(side));
   }
 
+  // Maps entity ids to the merged entity list so per-event lookups don't scan
+  // every entity. Entries are weak so cleaned-up entities just expire.
+  // Ids are handed out in increasing order and new entities are merged in
+  // creation order, so every merged entity at or below indexed_through is
+  // already in the map: a miss there is an entity that is gone, and only a
+  // newer id can make the index rescan the entity list.
+  struct EntityIdIndex {
+    std::unordered_map<afterhours::EntityID,
+                       std::weak_ptr<afterhours::Entity>>
+        entries;
+    afterhours::EntityID indexed_through = -1;
+    // Entity list shape at the last scan; a newer id only rescans once the
+    // list has changed
+    size_t scanned_size = 0;
+    afterhours::EntityID scanned_back = -1;
+    size_t scans = 0;
+
+    static EntityIdIndex &get() {
+      static EntityIdIndex index;
+      return index;
+    }
+
+    std::shared_ptr<afterhours::Entity> lookup(afterhours::EntityID id) {
+      auto it = entries.find(id);
+      if (it == entries.end()) {
+        return nullptr;
+      }
+      std::shared_ptr<afterhours::Entity> entity = it->second.lock();
+      if (!entity) {
+        entries.erase(it);
+      }
+      return entity;
+    }
+
+    bool list_changed() const {
+      const auto &entities = afterhours::EntityHelper::get_entities();
+      afterhours::EntityID back =
+          entities.empty() || !entities.back() ? -1 : entities.back()->id;
+      return entities.size() != scanned_size || back != scanned_back;
+    }
+
+    // Adds the entities merged since the last scan
+    void refresh() {
+      const auto &entities = afterhours::EntityHelper::get_entities();
+      afterhours::EntityID newest = indexed_through;
+      for (const auto &ep : entities) {
+        if (ep && ep->id > indexed_through) {
+          entries[ep->id] = ep;
+          newest = std::max(newest, ep->id);
+        }
+      }
+      indexed_through = newest;
+      scans++;
+      scanned_size = entities.size();
+      scanned_back =
+          entities.empty() || !entities.back() ? -1 : entities.back()->id;
+    }
+
+    std::shared_ptr<afterhours::Entity> find(afterhours::EntityID id) {
+      std::shared_ptr<afterhours::Entity> entity = lookup(id);
+      if (entity || id <= indexed_through || !list_changed()) {
+        return entity;
+      }
+      refresh();
+      return lookup(id);
+    }
+  };
+
+  // Equivalent to EQ().whereID(id).gen_first() in O(1) for indexed entities
+  static afterhours::OptEntity find_by_id(afterhours::EntityID id) {
+    std::shared_ptr<afterhours::Entity> entity =
+        EntityIdIndex::get().find(id);
+    if (!entity) {
+      return afterhours::OptEntity();
+    }
+    return afterhours::OptEntity(std::ref(*entity));
+  }
+
   template <typename T>
   afterhours::OptEntity
   gen_max(std::function<T(const afterhours::Entity &)> extractor) const {
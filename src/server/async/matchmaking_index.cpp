@@ -0,0 +1,207 @@
+#include "matchmaking_index.h"
+#include "../../query.h"
+#include "components/team_pool.h"
+#include <algorithm>
+#include <array>
+
+namespace server::async {
+MatchmakingIndex &MatchmakingIndex::get() {
+  static MatchmakingIndex index;
+  return index;
+}
+
+uint64_t MatchmakingIndex::bucket_key(int round, int shop_tier) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(round)) << 32) |
+         static_cast<uint32_t>(shop_tier);
+}
+
+void MatchmakingIndex::add(afterhours::EntityID id, const UserId &user_id,
+                           int round, int shop_tier) {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (locations.contains(id)) {
+    remove_locked(id);
+  }
+
+  uint64_t key = bucket_key(round, shop_tier);
+  std::vector<afterhours::EntityID> &bucket = buckets[key];
+  locations[id] = Location{key, bucket.size(), user_id};
+  bucket.push_back(id);
+  by_user[user_id].push_back(id);
+}
+
+void MatchmakingIndex::remove(afterhours::EntityID id) {
+  std::lock_guard<std::mutex> lock(mtx);
+  remove_locked(id);
+}
+
+void MatchmakingIndex::remove_locked(afterhours::EntityID id) {
+  auto it = locations.find(id);
+  if (it == locations.end()) {
+    return;
+  }
+
+  // Swap-remove keeps bucket removal O(1)
+  std::vector<afterhours::EntityID> &bucket = buckets[it->second.bucket];
+  size_t position = it->second.position;
+  afterhours::EntityID moved = bucket.back();
+  bucket[position] = moved;
+  bucket.pop_back();
+  if (moved != id) {
+    locations[moved].position = position;
+  }
+  if (bucket.empty()) {
+    buckets.erase(it->second.bucket);
+  }
+
+  auto user_it = by_user.find(it->second.user_id);
+  if (user_it != by_user.end()) {
+    std::erase(user_it->second, id);
+    if (user_it->second.empty()) {
+      by_user.erase(user_it);
+    }
+  }
+
+  locations.erase(it);
+}
+
+void MatchmakingIndex::clear() {
+  std::lock_guard<std::mutex> lock(mtx);
+  buckets.clear();
+  locations.clear();
+  by_user.clear();
+}
+
+size_t MatchmakingIndex::size() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return locations.size();
+}
+
+size_t MatchmakingIndex::own_entries_through(const UserEntries *own,
+                                             uint64_t key,
+                                             size_t position) const {
+  if (own == nullptr) {
+    return 0;
+  }
+  size_t count = 0;
+  for (afterhours::EntityID id : *own) {
+    const Location &loc = locations.at(id);
+    if (loc.bucket == key && loc.position <= position) {
+      count++;
+    }
+  }
+  return count;
+}
+
+std::optional<afterhours::EntityID>
+MatchmakingIndex::pick_opponent(const UserId &user_id, int round,
+                                int shop_tier, SeededRng &rng) const {
+  struct Candidate {
+    const std::vector<afterhours::EntityID> *bucket = nullptr;
+    uint64_t key = 0;
+    size_t eligible = 0;
+  };
+
+  // One slot per bucket in the match window, so picking never allocates
+  std::array<Candidate, kWindowBuckets> candidates;
+  size_t candidate_count = 0;
+  size_t total = 0;
+  auto user_it = by_user.find(user_id);
+  const UserEntries *own =
+      user_it == by_user.end() ? nullptr : &user_it->second;
+
+  for (int r = round - kRoundWindow; r <= round + kRoundWindow; ++r) {
+    for (int t = shop_tier - kTierWindow; t <= shop_tier + kTierWindow; ++t) {
+      uint64_t key = bucket_key(r, t);
+      auto bucket_it = buckets.find(key);
+      if (bucket_it == buckets.end()) {
+        continue;
+      }
+
+      size_t size = bucket_it->second.size();
+      size_t eligible = size - own_entries_through(own, key, size);
+      if (eligible > 0) {
+        total += eligible;
+        candidates[candidate_count++] = {&bucket_it->second, key, eligible};
+      }
+    }
+  }
+
+  if (total == 0) {
+    return std::nullopt;
+  }
+
+  size_t pick = rng.gen_index(total);
+  for (size_t i = 0; i < candidate_count; ++i) {
+    const Candidate &candidate = candidates[i];
+    if (pick >= candidate.eligible) {
+      pick -= candidate.eligible;
+      continue;
+    }
+    // Map the pick onto the bucket, stepping over the user's own entries.
+    // The smallest position with `pick` other users' entries before it is
+    // the fixed point of position = pick + own entries at or before it.
+    size_t position = pick;
+    while (true) {
+      size_t next = pick + own_entries_through(own, candidate.key, position);
+      if (next == position) {
+        break;
+      }
+      position = next;
+    }
+    return (*candidate.bucket)[position];
+  }
+  return std::nullopt;
+}
+
+afterhours::OptEntity MatchmakingIndex::find_opponent(const UserId &user_id,
+                                                      int round, int shop_tier,
+                                                      SeededRng &rng) {
+  afterhours::EntityHelper::merge_entity_arrays();
+
+  std::lock_guard<std::mutex> lock(mtx);
+  while (true) {
+    std::optional<afterhours::EntityID> id =
+        pick_opponent(user_id, round, shop_tier, rng);
+    if (!id.has_value()) {
+      return afterhours::OptEntity();
+    }
+
+    afterhours::OptEntity entity = EQ::find_by_id(id.value());
+    if (entity && entity.asE().has<TeamPoolEntry>()) {
+      return entity;
+    }
+    remove_locked(id.value());
+  }
+}
+
+afterhours::OptEntity MatchmakingIndex::find_for_user(const UserId &user_id,
+                                                      const TeamId *team_id) {
+  afterhours::EntityHelper::merge_entity_arrays();
+
+  std::lock_guard<std::mutex> lock(mtx);
+  auto user_it = by_user.find(user_id);
+  if (user_it == by_user.end()) {
+    return afterhours::OptEntity();
+  }
+
+  std::vector<afterhours::EntityID> stale;
+  afterhours::OptEntity result;
+  for (afterhours::EntityID id : user_it->second) {
+    afterhours::OptEntity entity = EQ::find_by_id(id);
+    if (!entity || !entity.asE().has<TeamPoolEntry>()) {
+      stale.push_back(id);
+      continue;
+    }
+    if (team_id && entity.asE().get<TeamPoolEntry>().teamId != *team_id) {
+      continue;
+    }
+    result = entity;
+    break;
+  }
+
+  for (afterhours::EntityID id : stale) {
+    remove_locked(id);
+  }
+  return result;
+}
+} // namespace server::async
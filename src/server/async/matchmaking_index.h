@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../../seeded_rng.h"
+#include "types.h"
+#include <afterhours/ah.h>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace server::async {
+// Index over TeamPoolEntry entities so matchmaking and per-user lookups don't
+// scan the whole pool. Entries are bucketed by (round, shopTier); picking an
+// opponent only touches the buckets within the match window and the
+// requesting user's own entries.
+class MatchmakingIndex {
+public:
+  static constexpr int kRoundWindow = 2;
+  static constexpr int kTierWindow = 1;
+  static constexpr size_t kWindowBuckets =
+      (2 * kRoundWindow + 1) * (2 * kTierWindow + 1);
+
+  static MatchmakingIndex &get();
+
+  void add(afterhours::EntityID id, const UserId &user_id, int round,
+           int shop_tier);
+  void remove(afterhours::EntityID id);
+  void clear();
+  size_t size() const;
+
+  // Uniformly random entry within the match window that belongs to another
+  // user. Ids whose entities no longer exist are dropped and skipped.
+  afterhours::OptEntity find_opponent(const UserId &user_id, int round,
+                                      int shop_tier, SeededRng &rng);
+  // Oldest entry for the user, optionally matching a team id
+  afterhours::OptEntity find_for_user(const UserId &user_id,
+                                      const TeamId *team_id = nullptr);
+
+private:
+  struct Location {
+    uint64_t bucket = 0;
+    size_t position = 0;
+    UserId user_id;
+  };
+
+  using UserEntries = std::vector<afterhours::EntityID>;
+
+  mutable std::mutex mtx;
+  std::unordered_map<uint64_t, std::vector<afterhours::EntityID>> buckets;
+  std::unordered_map<afterhours::EntityID, Location> locations;
+  std::unordered_map<UserId, UserEntries> by_user;
+
+  static uint64_t bucket_key(int round, int shop_tier);
+  // How many of the user's entries sit in bucket key at or before position
+  size_t own_entries_through(const UserEntries *own, uint64_t key,
+                             size_t position) const;
+  std::optional<afterhours::EntityID>
+  pick_opponent(const UserId &user_id, int round, int shop_tier,
+                SeededRng &rng) const;
+  void remove_locked(afterhours::EntityID id);
+};
+} // namespace server::async
@@ -2,12 +2,12 @@
 
 #include "../../../components/dish_battle_state.h"
 #include "../../../log.h"
+#include "../../../utils/battle_event_log.h"
 #include "../../battle_serializer.h"
 #include "../battle_event.h"
 #include "../components/battle_info.h"
 #include "../components/event_log.h"
 #include <afterhours/ah.h>
-#include <magic_enum/magic_enum.hpp>
 
 namespace server::async {
 struct CollectBattleResultsSystem : afterhours::System<BattleInfo> {
@@ -36,28 +36,7 @@ struct CollectBattleResultsSystem : afterhours::System<BattleInfo> {
       events = event_log.events;
     }
 
-    nlohmann::json events_json = nlohmann::json::array();
-    for (const auto &ev : events) {
-      nlohmann::json event_json;
-      event_json["hook"] = std::string(magic_enum::enum_name(ev.hook));
-      event_json["sourceEntityId"] = ev.sourceEntityId;
-      event_json["slotIndex"] = ev.slotIndex;
-      std::string team_side_str;
-      switch (ev.teamSide) {
-      case DishBattleState::TeamSide::Player:
-        team_side_str = "Player";
-        break;
-      case DishBattleState::TeamSide::Opponent:
-        team_side_str = "Opponent";
-        break;
-      }
-      event_json["teamSide"] = team_side_str;
-      event_json["timestamp"] = ev.timestamp;
-      event_json["courseIndex"] = ev.courseIndex;
-      event_json["payloadInt"] = ev.payloadInt;
-      event_json["payloadFloat"] = ev.payloadFloat;
-      events_json.push_back(event_json);
-    }
+    nlohmann::json events_json = BattleEventLog::to_json(events);
 
     nlohmann::json result = server::BattleSerializer::serialize_battle_result(
         info.seed, info.opponentId, outcomes, events_json, false);
@@ -8,6 +8,7 @@
 #include "../components/battle_info.h"
 #include "../components/command_queue_entry.h"
 #include "../components/team_pool.h"
+#include "../matchmaking_index.h"
 #include <afterhours/ah.h>
 #include <chrono>
 #include <cstdint>
@@ -42,35 +43,21 @@ private:
     auto &team_entity = afterhours::EntityHelper::createEntity();
     team_entity.addComponent<TeamPoolEntry>(cmd.teamId, cmd.userId, cmd.round,
                                             cmd.shopTier, cmd.team, added_at);
+    MatchmakingIndex::get().add(team_entity.id, cmd.userId, cmd.round,
+                                cmd.shopTier);
 
-    log_info("SERVER_MATCHMAKING: Added team {} for user {} to pool "
-             "(round={}, tier={})",
-             cmd.teamId, cmd.userId, cmd.round, cmd.shopTier);
+    log_info_c(LogCategory::SERVER_MATCHMAKING,
+               "SERVER_MATCHMAKING: Added team {} for user {} to pool "
+               "(round={}, tier={})",
+               cmd.teamId, cmd.userId, cmd.round, cmd.shopTier);
   }
 
   void process_match_request(afterhours::Entity &cmd_entity,
                              const CommandQueueEntry &cmd) {
-    // Define reusable filters as lambdas
-    auto user_filter = [&cmd](const afterhours::Entity &e) {
-      const TeamPoolEntry &entry = e.get<TeamPoolEntry>();
-      return entry.userId != cmd.userId;
-    };
-
-    auto match_filter = [&cmd](const afterhours::Entity &e) {
-      const TeamPoolEntry &entry = e.get<TeamPoolEntry>();
-      int round_diff = std::abs(entry.round - cmd.round);
-      int tier_diff = std::abs(entry.shopTier - cmd.shopTier);
-      return round_diff <= 2 && tier_diff <= 1;
-    };
-
-    // Find random opponent using progressive filtering
+    // Random opponent from another user within 2 rounds and 1 shop tier
     SeededRng &rng = SeededRng::get();
-    auto opponent_opt =
-        afterhours::EntityQuery({.force_merge = true})
-            .whereHasComponent<TeamPoolEntry>()
-            .whereLambda(user_filter)
-            .whereLambda(match_filter)
-            .gen_random([&rng](size_t count) { return rng.gen_index(count); });
+    auto opponent_opt = MatchmakingIndex::get().find_opponent(
+        cmd.userId, cmd.round, cmd.shopTier, rng);
 
     if (!opponent_opt) {
       log_warn("SERVER_MATCHMAKING: No matching opponent found for battle {} "
@@ -83,17 +70,11 @@ private:
     afterhours::Entity &opponent_entity = opponent_opt.asE();
     const TeamPoolEntry &opponent = opponent_entity.get<TeamPoolEntry>();
 
-    // Get player team data using progressive filtering
+    // Get player team data from the pool
     nlohmann::json player_team = cmd.team;
     if (player_team.empty() && !cmd.teamId.empty()) {
       auto player_opt =
-          afterhours::EntityQuery({.force_merge = true})
-              .whereHasComponent<TeamPoolEntry>()
-              .whereLambda([&cmd](const afterhours::Entity &e) {
-                const TeamPoolEntry &entry = e.get<TeamPoolEntry>();
-                return entry.teamId == cmd.teamId && entry.userId == cmd.userId;
-              })
-              .gen_first();
+          MatchmakingIndex::get().find_for_user(cmd.userId, &cmd.teamId);
 
       if (player_opt) {
         player_team = player_opt.asE().get<TeamPoolEntry>().team;
@@ -108,9 +89,10 @@ private:
       return;
     }
 
-    log_info("SERVER_MATCHMAKING: Matched battle {} - player {} vs opponent {} "
-             "(team {})",
-             cmd.battleId, cmd.userId, opponent.userId, opponent.teamId);
+    log_info_c(LogCategory::SERVER_MATCHMAKING,
+               "SERVER_MATCHMAKING: Matched battle {} - player {} vs opponent "
+               "{} (team {})",
+               cmd.battleId, cmd.userId, opponent.userId, opponent.teamId);
 
     // Start battle directly
     start_battle(cmd.battleId, player_team, opponent.team, opponent.teamId,
@@ -227,7 +209,8 @@ private:
     battle_info.status = BattleStatus::Running;
     battle_info.result = nlohmann::json::object();
 
-    log_info(
+    log_info_c(
+        LogCategory::SERVER_BATTLE,
         "SERVER_BATTLE: Starting battle {} (opponent={}, round={}, tier={})",
         battle_id, opponent_id, round, shop_tier);
   }
@@ -0,0 +1,148 @@
+#include "balance_report.h"
+#include "battle_serializer.h"
+#include <iomanip>
+#include <sstream>
+
+namespace server {
+namespace {
+double rate(int wins, int games) {
+  return games == 0 ? 0.0 : static_cast<double>(wins) / games;
+}
+} // namespace
+
+BalanceReport::BalanceReport(std::vector<TeamId> ids)
+    : team_ids(std::move(ids)),
+      games(team_ids.size(), std::vector<int>(team_ids.size(), 0)),
+      wins(team_ids.size(), std::vector<int>(team_ids.size(), 0)),
+      ties(team_ids.size(), std::vector<int>(team_ids.size(), 0)) {}
+
+void BalanceReport::record(size_t player, size_t opponent,
+                           const std::vector<std::string> &player_dishes,
+                           const std::vector<std::string> &opponent_dishes,
+                           const nlohmann::json &outcomes) {
+  std::string winner =
+      BattleSerializer::summarize_outcomes(outcomes)["winner"];
+
+  games[player][opponent]++;
+  if (winner == "Player") {
+    wins[player][opponent]++;
+  } else if (winner == "Tie") {
+    ties[player][opponent]++;
+  }
+
+  // Every dish on the winning side is credited with the win
+  for (const auto &dish : player_dishes) {
+    DishStats &stats = dishes[dish];
+    stats.games++;
+    if (winner == "Player") {
+      stats.wins++;
+    }
+  }
+  for (const auto &dish : opponent_dishes) {
+    DishStats &stats = dishes[dish];
+    stats.games++;
+    if (winner == "Opponent") {
+      stats.wins++;
+    }
+  }
+}
+
+void BalanceReport::merge(const BalanceReport &other) {
+  for (size_t i = 0; i < games.size() && i < other.games.size(); ++i) {
+    for (size_t j = 0; j < games[i].size() && j < other.games[i].size(); ++j) {
+      games[i][j] += other.games[i][j];
+      wins[i][j] += other.wins[i][j];
+      ties[i][j] += other.ties[i][j];
+    }
+  }
+  for (const auto &[dish, stats] : other.dishes) {
+    dishes[dish].games += stats.games;
+    dishes[dish].wins += stats.wins;
+  }
+  timeouts += other.timeouts;
+  errors += other.errors;
+}
+
+int BalanceReport::total_games() const {
+  int total = 0;
+  for (const auto &row : games) {
+    for (int count : row) {
+      total += count;
+    }
+  }
+  return total;
+}
+
+nlohmann::json BalanceReport::to_json() const {
+  nlohmann::json matrix = nlohmann::json::array();
+  for (size_t i = 0; i < team_ids.size(); ++i) {
+    nlohmann::json row = nlohmann::json::array();
+    for (size_t j = 0; j < team_ids.size(); ++j) {
+      row.push_back({{"games", games[i][j]},
+                     {"wins", wins[i][j]},
+                     {"ties", ties[i][j]},
+                     {"winRate", rate(wins[i][j], games[i][j])}});
+    }
+    matrix.push_back(row);
+  }
+
+  nlohmann::json dish_json = nlohmann::json::object();
+  for (const auto &[dish, stats] : dishes) {
+    dish_json[dish] = {{"games", stats.games},
+                       {"wins", stats.wins},
+                       {"winRate", rate(stats.wins, stats.games)}};
+  }
+
+  return nlohmann::json{{"teams", team_ids},
+                        {"matrix", matrix},
+                        {"dishes", dish_json},
+                        {"battles", total_games()},
+                        {"timeouts", timeouts},
+                        {"errors", errors}};
+}
+
+std::string BalanceReport::matrix_csv() const {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(4) << "team";
+  for (const auto &id : team_ids) {
+    ss << "," << id;
+  }
+  ss << "\n";
+
+  for (size_t i = 0; i < team_ids.size(); ++i) {
+    ss << team_ids[i];
+    for (size_t j = 0; j < team_ids.size(); ++j) {
+      ss << ",";
+      if (games[i][j] > 0) {
+        ss << rate(wins[i][j], games[i][j]);
+      }
+    }
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+std::string BalanceReport::dishes_csv() const {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(4) << "dish,games,wins,win_rate\n";
+  for (const auto &[dish, stats] : dishes) {
+    ss << dish << "," << stats.games << "," << stats.wins << ","
+       << rate(stats.wins, stats.games) << "\n";
+  }
+  return ss.str();
+}
+
+std::vector<std::string>
+BalanceReport::team_dish_types(const nlohmann::json &team) {
+  std::vector<std::string> dish_types;
+  if (!team.contains("team") || !team["team"].is_array()) {
+    return dish_types;
+  }
+  for (const auto &dish : team["team"]) {
+    if (dish.contains("dishType") && dish["dishType"].is_string()) {
+      dish_types.push_back(dish["dishType"].get<std::string>());
+    }
+  }
+  return dish_types;
+}
+} // namespace server
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "team_types.h"
+#include <map>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace server {
+// Win-rate matrix and per-dish win contribution for a round-robin of teams.
+// Each worker accumulates into its own report and the reports are merged
+// once at the end, so recording a battle never takes a lock.
+struct BalanceReport {
+  struct DishStats {
+    int games = 0;
+    int wins = 0;
+  };
+
+  std::vector<TeamId> team_ids;
+  // games[player][opponent] / wins[player][opponent] from the player's side
+  std::vector<std::vector<int>> games;
+  std::vector<std::vector<int>> wins;
+  std::vector<std::vector<int>> ties;
+  std::map<std::string, DishStats> dishes;
+  int timeouts = 0;
+  int errors = 0;
+
+  BalanceReport() = default;
+  explicit BalanceReport(std::vector<TeamId> ids);
+
+  // outcomes is the "outcomes" array of a serialized battle result
+  void record(size_t player, size_t opponent,
+              const std::vector<std::string> &player_dishes,
+              const std::vector<std::string> &opponent_dishes,
+              const nlohmann::json &outcomes);
+  void merge(const BalanceReport &other);
+
+  int total_games() const;
+  nlohmann::json to_json() const;
+  std::string matrix_csv() const;
+  std::string dishes_csv() const;
+
+  static std::vector<std::string> team_dish_types(const nlohmann::json &team);
+};
+} // namespace server
@@ -1,17 +1,22 @@
 #include "battle_api.h"
 #include "../log.h"
 #include "../seeded_rng.h"
-#include "../utils/battle_fingerprint.h"
 #include "../utils/code_hash_generated.h"
-#include "async/components/team_pool.h"
+#include "../utils/game_state_checksum.h"
+#include "../utils/system_profiler.h"
+#include "../utils/wire_format.h"
 #include "battle_serializer.h"
 #include "file_storage.h"
+#include "metrics.h"
 #include "team_types.h"
 #include <afterhours/ah.h>
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <future>
 #include <iomanip>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <sstream>
 
 namespace server {
@@ -27,6 +32,17 @@ static void set_error_response(httplib::Response &res, int status_code,
   res.set_content(make_error_json(error_message).dump(), "application/json");
 }
 
+static void set_body(const httplib::Request &req, httplib::Response &res,
+                     const nlohmann::json &body,
+                     wire_format::Encoding encoding) {
+  std::string encoded = wire_format::encode(body, encoding);
+  if (wire_format::accepts_gzip(req.get_header_value("Accept-Encoding")) &&
+      wire_format::gzip_if_large(encoded, encoding)) {
+    res.set_header("Content-Encoding", wire_format::kGzip);
+  }
+  res.set_content(std::move(encoded), wire_format::content_type(encoding));
+}
+
 #define return_if(condition, status_code, error_message)                       \
   do {                                                                         \
     if (condition) {                                                           \
@@ -44,6 +60,23 @@ BattleAPI::get_error_message(const std::string &detailed_error) const {
   return "Internal server error";
 }
 
+// Times the handler and records its status and serialized body size
+static httplib::Server::Handler instrumented(Metrics::Route route,
+                                             httplib::Server::Handler handler) {
+  return [route, handler = std::move(handler)](const httplib::Request &req,
+                                               httplib::Response &res) {
+    auto start = std::chrono::steady_clock::now();
+    handler(req, res);
+    // httplib fills in 200 after the handler when none was set
+    Metrics::get().observe_request(
+        route, res.status > 0 ? res.status : 200,
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      start)
+            .count(),
+        res.body.size());
+  };
+}
+
 void BattleAPI::setup_routes() {
   if (config.enable_cors) {
     server.set_default_headers(
@@ -53,24 +86,60 @@ void BattleAPI::setup_routes() {
   }
 
   server.Get("/health",
-             [this](const httplib::Request &req, httplib::Response &res) {
-               handle_health_request(req, res);
-             });
+             instrumented(Metrics::Route::Health,
+                          [this](const httplib::Request &req,
+                                 httplib::Response &res) {
+                            handle_health_request(req, res);
+                          }));
 
   server.Post("/battle",
-              [this](const httplib::Request &req, httplib::Response &res) {
-                handle_battle_request(req, res);
-              });
+              instrumented(Metrics::Route::Battle,
+                           [this](const httplib::Request &req,
+                                  httplib::Response &res) {
+                             handle_battle_request(req, res);
+                           }));
+
+  server.Post("/battle/batch",
+              instrumented(Metrics::Route::BattleBatch,
+                           [this](const httplib::Request &req,
+                                  httplib::Response &res) {
+                             handle_batch_battle_request(req, res);
+                           }));
 
   server.Post("/save-game-state",
-              [this](const httplib::Request &req, httplib::Response &res) {
-                handle_save_game_state(req, res);
-              });
+              instrumented(Metrics::Route::SaveGameState,
+                           [this](const httplib::Request &req,
+                                  httplib::Response &res) {
+                             handle_save_game_state(req, res);
+                           }));
 
   server.Get("/game-state",
-             [this](const httplib::Request &req, httplib::Response &res) {
-               handle_get_game_state(req, res);
-             });
+             instrumented(Metrics::Route::GameState,
+                          [this](const httplib::Request &req,
+                                 httplib::Response &res) {
+                            handle_get_game_state(req, res);
+                          }));
+
+  server.Get("/results",
+             instrumented(Metrics::Route::Results,
+                          [this](const httplib::Request &req,
+                                 httplib::Response &res) {
+                            handle_results_request(req, res);
+                          }));
+
+  server.Get("/metrics",
+             instrumented(Metrics::Route::Metrics,
+                          [this](const httplib::Request &req,
+                                 httplib::Response &res) {
+                            handle_metrics_request(req, res);
+                          }));
+
+  server.Get("/profile",
+             instrumented(Metrics::Route::Profile,
+                          [this](const httplib::Request &req,
+                                 httplib::Response &res) {
+                            handle_profile_request(req, res);
+                          }));
 
   server.Options("/health", [](const httplib::Request &,
                                httplib::Response &res) { res.status = 200; });
@@ -78,18 +147,38 @@ void BattleAPI::setup_routes() {
   server.Options("/battle", [](const httplib::Request &,
                                httplib::Response &res) { res.status = 200; });
 
+  server.Options("/battle/batch",
+                 [](const httplib::Request &, httplib::Response &res) {
+                   res.status = 200;
+                 });
+
   server.Options("/save-game-state",
                  [](const httplib::Request &, httplib::Response &res) {
                    res.status = 200;
                  });
 
+  server.Options("/results",
+                 [](const httplib::Request &, httplib::Response &res) {
+                   res.status = 200;
+                 });
+
   server.Options("/game-state",
                  [](const httplib::Request &, httplib::Response &res) {
                    res.status = 200;
                  });
+
+  server.Options("/metrics",
+                 [](const httplib::Request &, httplib::Response &res) {
+                   res.status = 200;
+                 });
+
+  server.Options("/profile",
+                 [](const httplib::Request &, httplib::Response &res) {
+                   res.status = 200;
+                 });
 }
 
-void BattleAPI::handle_health_request(const httplib::Request &,
+void BattleAPI::handle_health_request(const httplib::Request &req,
                                       httplib::Response &res) {
   std::string status = "healthy";
   std::vector<std::string> issues;
@@ -100,8 +189,7 @@ void BattleAPI::handle_health_request(const httplib::Request &,
     status = "unhealthy";
     issues.push_back("Opponents directory does not exist");
   } else {
-    opponent_count =
-        FileStorage::count_files_in_directory(opponents_path.string(), ".json");
+    opponent_count = opponents.size();
     if (opponent_count == 0) {
       status = "degraded";
       issues.push_back("No opponent files available");
@@ -144,11 +232,126 @@ void BattleAPI::handle_health_request(const httplib::Request &,
   }
   response["opponent_count"] = opponent_count;
   response["codeHash"] = SHARED_CODE_HASH;
+  response["persistence"] = results_writer.stats().to_json();
+
+  set_body(req, res, response,
+           wire_format::from_accept(req.get_header_value("Accept"),
+                                    wire_format::Encoding::Json));
+  res.status = 200;
+}
+
+void BattleAPI::handle_metrics_request(const httplib::Request &,
+                                       httplib::Response &res) {
+  DurableWriteStats persistence = results_writer.stats();
+  std::vector<MetricGaugeSample> gauges = {
+      {"battle_server_battle_queue_depth",
+       "Battles waiting for a free battle world.",
+       static_cast<double>(battle_worlds.queued())},
+      {"battle_server_battle_worlds", "Battle worlds in the pool.",
+       static_cast<double>(battle_worlds.size())},
+      {"battle_server_opponents", "Teams in the opponent catalog.",
+       static_cast<double>(opponents.size())},
+      {"battle_server_pending_writes", "Durable writes not yet committed.",
+       static_cast<double>(persistence.pending)},
+      {"battle_server_stored_results", "Battle results in the result store.",
+       static_cast<double>(results.size())},
+      {"battle_server_game_states", "Users with a saved game state.",
+       static_cast<double>(game_states.size())}};
+
+  res.set_content(Metrics::get().render(gauges),
+                  "text/plain; version=0.0.4");
+  res.status = 200;
+}
 
-  res.set_content(response.dump(), "application/json");
+void BattleAPI::handle_profile_request(const httplib::Request &req,
+                                       httplib::Response &res) {
+  SystemProfiler &profiler = SystemProfiler::get();
+  wire_format::Encoding encoding = wire_format::from_accept(
+      req.get_header_value("Accept"), wire_format::Encoding::Json);
+
+  // Frames are only recorded by the process that runs the systems, so with
+  // forked battle worlds the trace is empty and the totals are what matters
+  if (req.get_param_value("format") == "trace") {
+    set_body(req, res, profiler.chrome_trace(), encoding);
+    res.status = 200;
+    return;
+  }
+
+  nlohmann::json response{{"enabled", profiler.enabled()},
+                          {"systems", profiler.summary()}};
+  if (req.get_param_value("reset") == "true") {
+    profiler.reset();
+  }
+  set_body(req, res, response, encoding);
   res.status = 200;
 }
 
+static void record_battle_metrics(const BattleWorldResult &result) {
+  Metrics &metrics = Metrics::get();
+  switch (result.status) {
+  case BattleWorldResult::Status::Complete:
+    metrics.battle_ticks.observe(static_cast<double>(result.iterations));
+    break;
+  case BattleWorldResult::Status::Timeout:
+    metrics.battle_timeouts.add();
+    break;
+  case BattleWorldResult::Status::Error:
+    metrics.battle_errors.add();
+    break;
+  }
+  if (result.systems_ticks > 0) {
+    metrics.systems_seconds_per_tick.observe(result.systems_seconds /
+                                             result.systems_ticks);
+  }
+  if (!result.system_profile.is_null()) {
+    SystemProfiler::get().merge(result.system_profile);
+  }
+}
+
+bool BattleAPI::check_code_hash(const nlohmann::json &request_json,
+                              httplib::Response &res,
+                              const std::string &request_id) const {
+  std::string client_hash = request_json.value("codeHash", std::string(""));
+  std::string server_hash = SHARED_CODE_HASH;
+
+  if (client_hash != server_hash) {
+    log_error(
+        "[{}] CODE_HASH: Version mismatch - Client hash: {}, Server hash: {}",
+        request_id, client_hash, server_hash);
+    nlohmann::json error_response;
+    error_response["error"] =
+        "Code version mismatch. Client hash: " + client_hash +
+        ", Server hash: " + server_hash +
+        ". Please update client/server to matching version.";
+    error_response["clientHash"] = client_hash;
+    error_response["serverHash"] = server_hash;
+    res.set_content(error_response.dump(), "application/json");
+    res.status = 400;
+    return false;
+  }
+
+  log_info("[{}] CODE_HASH: Client hash: {}, Server hash: {}, Match: true",
+           request_id, client_hash, server_hash);
+  return true;
+}
+
+BattleWorldJob BattleAPI::make_battle_job(const nlohmann::json &player_team,
+                                          const OpponentEntry &opponent,
+                                          uint64_t seed) const {
+  BattleWorldJob job;
+  job.player_team = player_team;
+  job.opponent_team = opponent.team;
+  job.opponent_id = opponent.id;
+  job.seed = seed;
+  job.max_iterations =
+      std::min(config.timeout_seconds * 60, config.max_simulation_iterations);
+  job.timeout_seconds = config.timeout_seconds;
+  job.debug_mode = config.debug;
+  job.instant = config.instant_battles;
+  job.temp_files_path = config.get_temp_files_path().string();
+  return job;
+}
+
 void BattleAPI::handle_battle_request(const httplib::Request &req,
                                       httplib::Response &res) {
   std::string request_id = std::to_string(
@@ -157,12 +360,14 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
 
   log_info("[{}] Battle request received", request_id);
 
-  BattleSimulator simulator;
-  bool simulator_initialized = false;
   try {
-    std::string content_type = req.get_header_value("Content-Type");
-    return_if(content_type.find("application/json") == std::string::npos, 415,
-              "Content-Type must be application/json");
+    std::optional<wire_format::Encoding> request_encoding =
+        wire_format::from_media_type(req.get_header_value("Content-Type"));
+    return_if(!request_encoding, 415,
+              "Content-Type must be application/json, application/cbor or "
+              "application/msgpack");
+    wire_format::Encoding encoding = wire_format::from_accept(
+        req.get_header_value("Accept"), *request_encoding);
 
     if (req.body.size() > static_cast<size_t>(config.max_request_body_size)) {
       std::string error_msg = "Request body too large. Maximum size: " +
@@ -174,76 +379,43 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
 
     return_if(req.body.empty(), 400, "Request body is empty");
 
-    nlohmann::json request_json = nlohmann::json::parse(req.body);
-
-    std::string client_hash = request_json.value("codeHash", std::string(""));
-    std::string server_hash = SHARED_CODE_HASH;
-
-    if (client_hash != server_hash) {
-      log_error(
-          "[{}] CODE_HASH: Version mismatch - Client hash: {}, Server hash: {}",
-          request_id, client_hash, server_hash);
-      nlohmann::json error_response;
-      error_response["error"] =
-          "Code version mismatch. Client hash: " + client_hash +
-          ", Server hash: " + server_hash +
-          ". Please update client/server to matching version.";
-      error_response["clientHash"] = client_hash;
-      error_response["serverHash"] = server_hash;
-      res.set_content(error_response.dump(), "application/json");
-      res.status = 400;
+    nlohmann::json request_json =
+        wire_format::decode(req.body, *request_encoding);
+
+    if (!check_code_hash(request_json, res, request_id)) {
       return;
     }
 
-    log_info("[{}] CODE_HASH: Client hash: {}, Server hash: {}, Match: true",
-             request_id, client_hash, server_hash);
-
     return_if(
         !TeamManager::validate_team_json(request_json, config.max_team_size),
         400, "Invalid team JSON format");
 
-    nlohmann::json player_team = request_json["team"];
+    // Same {"team": [...]} shape as the opponent files, which is what the
+    // loaders read and what the client replays from the response
+    nlohmann::json player_team = {{"team", request_json["team"]}};
 
-    std::optional<TeamFilePath> opponent_path =
-        TeamManager::select_random_opponent_with_fallback(
-            config.get_opponents_path(), config.file_operation_retries);
-    return_if(!opponent_path.has_value(), 500, "No opponents available");
-
-    nlohmann::json opponent_team = FileStorage::load_json_from_file_with_retry(
-        opponent_path.value(), config.file_operation_retries);
-    return_if(opponent_team.empty(), 500, "Failed to load opponent team");
+    std::shared_ptr<const OpponentEntry> opponent = opponents.pick_random();
+    return_if(!opponent, 500, "No opponents available");
+    const nlohmann::json &opponent_team = opponent->team;
 
     // Generate unique seed for this battle (non-deterministic, one-time)
     uint64_t seed = SeededRng::get_actually_random_number_random_seed();
 
-    // Set seed for deterministic battle simulation
-    SeededRng::get().set_seed(seed);
-
-    const float fixed_dt = 1.0f / 60.0f;
-    int max_iterations =
-        std::min(config.timeout_seconds * 60, config.max_simulation_iterations);
-    int iterations = 0;
-    auto start_time = std::chrono::steady_clock::now();
-
-    simulator.start_battle(player_team, opponent_team, seed,
-                           config.get_temp_files_path());
-    simulator_initialized = true;
-
-    int last_logged_iteration = 0;
-    while (!simulator.is_complete() && iterations < max_iterations) {
-      auto current_time = std::chrono::steady_clock::now();
-      auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                         current_time - start_time)
-                         .count();
-
-      if (iterations > 0 && iterations % 3600 == 0 &&
-          iterations != last_logged_iteration) {
-        log_info("[{}] Battle progress: {} iterations, {:.1f}s elapsed",
-                 request_id, iterations, elapsed);
-        last_logged_iteration = iterations;
-      }
+    TeamId opponent_id = opponent->id;
+
+    BattleWorldJob job = make_battle_job(player_team, *opponent, seed);
+    job.json_events =
+        request_json.value("eventFormat", std::string("binary")) == "json";
 
-      if (elapsed >= config.timeout_seconds) {
+    BattleWorldResult world_result = battle_worlds.run(job);
+    record_battle_metrics(world_result);
+
+    if (world_result.status == BattleWorldResult::Status::Error) {
+      throw std::runtime_error(world_result.error);
+    }
+
+    if (world_result.status == BattleWorldResult::Status::Timeout) {
+      if (world_result.iterations < job.max_iterations) {
         std::string battle_id = std::to_string(seed);
         auto now = std::chrono::system_clock::now();
         auto time_t = std::chrono::system_clock::to_time_t(now);
@@ -253,8 +425,8 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
 
         nlohmann::json timeout_state = {
             {"seed", seed},
-            {"simulation_time", simulator.get_simulation_time()},
-            {"iterations", iterations},
+            {"simulation_time", world_result.simulation_time},
+            {"iterations", world_result.iterations},
             {"player_team", player_team},
             {"opponent_team", opponent_team}};
 
@@ -263,33 +435,13 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
         std::string timeout_filename =
             (debug_path / (timestamp + "_" + battle_id + ".json")).string();
         FileStorage::save_json_to_file(timeout_filename, timeout_state);
-
-        simulator.cleanup_temp_files();
-        set_error_response(res, 408, "Battle simulation timeout");
-        return;
       }
 
-      simulator.update(fixed_dt);
-      iterations++;
-    }
-
-    if (iterations >= max_iterations) {
-      simulator.cleanup_temp_files();
-      res.status = 408;
-      res.set_content(make_error_json("Battle simulation timeout").dump(),
-                      "application/json");
+      set_error_response(res, 408, "Battle simulation timeout");
       return;
     }
 
-    bool debug_mode = config.debug;
-    nlohmann::json outcomes = BattleSerializer::collect_battle_outcomes();
-    nlohmann::json events = BattleSerializer::collect_battle_events(simulator);
-
-    std::filesystem::path opp_path(opponent_path.value());
-    TeamId opponent_id = extract_team_id_from_path(opponent_path.value());
-
-    nlohmann::json response = BattleSerializer::serialize_battle_result(
-        seed, opponent_id, outcomes, events, debug_mode);
+    nlohmann::json response = world_result.response;
 
     std::string player_team_id = request_json.value("playerTeamId", "");
     std::string player_username = request_json.value("playerUsername", "");
@@ -297,42 +449,22 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
 
     std::string battle_id = std::to_string(seed);
 
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S");
-    std::string timestamp = ss.str();
-
     nlohmann::json result_to_save = response;
     result_to_save["playerTeamId"] = player_team_id;
     result_to_save["opponentTeamId"] = opponent_id;
     result_to_save["playerUsername"] = player_username;
     result_to_save["opponentUsername"] = opponent_username;
+    BattleSerializer::event_log_to_base64(result_to_save);
 
     std::filesystem::path results_path = config.get_results_path();
-    FileStorage::ensure_directory_exists(results_path.string());
-
     if (!FileStorage::check_disk_space(results_path.string(), 1048576)) {
-      simulator.cleanup_temp_files();
       set_error_response(res, 507, "Insufficient storage space");
       return;
     }
 
-    std::string result_filename =
-        (results_path / (timestamp + "_" + battle_id + ".json")).string();
-    if (!FileStorage::save_json_to_file(result_filename, result_to_save)) {
-      simulator.cleanup_temp_files();
-      set_error_response(res, 507, "Failed to save battle result");
-      return;
-    }
-
-    FileStorage::cleanup_old_files(results_path.string(), 10, ".json");
-
-    simulator.cleanup_temp_files();
-
-    std::filesystem::path temp_path = config.get_temp_files_path();
-    FileStorage::cleanup_old_files(temp_path.string(),
-                                   config.temp_file_retention_count, ".json");
+    // Committed in the background; failures are logged and counted in the
+    // writer's stats rather than failing a battle that already ran
+    results.append(battle_id, std::move(result_to_save));
 
     auto request_end = std::chrono::steady_clock::now();
     auto request_duration =
@@ -346,13 +478,18 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
                request_duration.count());
     }
 
+    // The client replays the battle from these, so it never has to read
+    // the server's debug team files
+    response["playerTeam"] = std::move(player_team);
+    response["opponentTeam"] = opponent_team;
+    if (encoding == wire_format::Encoding::Json) {
+      BattleSerializer::event_log_to_base64(response);
+    }
+
     res.status = 200;
-    res.set_content(response.dump(), "application/json");
+    set_body(req, res, response, encoding);
 
   } catch (const nlohmann::json::exception &e) {
-    if (simulator_initialized) {
-      simulator.cleanup_temp_files();
-    }
     std::string error_msg =
         get_error_message("Invalid JSON: " + std::string(e.what()));
     nlohmann::json error = {{"error", error_msg}};
@@ -364,9 +501,6 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
     res.set_content(error.dump(), "application/json");
     log_error("[{}] Battle API JSON error: {}", request_id, e.what());
   } catch (const std::exception &e) {
-    if (simulator_initialized) {
-      simulator.cleanup_temp_files();
-    }
     std::string error_msg =
         get_error_message("Server error: " + std::string(e.what()));
     nlohmann::json error = {{"error", error_msg}};
@@ -380,82 +514,307 @@ void BattleAPI::handle_battle_request(const httplib::Request &req,
   }
 }
 
-constexpr const char *SERVER_VERSION = "0.1.0";
+void BattleAPI::handle_batch_battle_request(const httplib::Request &req,
+                                            httplib::Response &res) {
+  std::string request_id = std::to_string(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+  auto request_start = std::chrono::steady_clock::now();
 
-std::string
-BattleAPI::compute_game_state_checksum(const nlohmann::json &state) const {
-  return ::compute_game_state_checksum(state);
+  log_info("[{}] Batch battle request received", request_id);
+
+  try {
+    std::optional<wire_format::Encoding> request_encoding =
+        wire_format::from_media_type(req.get_header_value("Content-Type"));
+    return_if(!request_encoding, 415,
+              "Content-Type must be application/json, application/cbor or "
+              "application/msgpack");
+    wire_format::Encoding encoding = wire_format::from_accept(
+        req.get_header_value("Accept"), *request_encoding);
+
+    if (req.body.size() > static_cast<size_t>(config.max_request_body_size)) {
+      std::string error_msg = "Request body too large. Maximum size: " +
+                              std::to_string(config.max_request_body_size) +
+                              " bytes";
+      set_error_response(res, 413, error_msg);
+      return;
+    }
+
+    return_if(req.body.empty(), 400, "Request body is empty");
+
+    nlohmann::json request_json =
+        wire_format::decode(req.body, *request_encoding);
+
+    if (!check_code_hash(request_json, res, request_id)) {
+      return;
+    }
+
+    return_if(
+        !TeamManager::validate_team_json(request_json, config.max_team_size),
+        400, "Invalid team JSON format");
+
+    nlohmann::json player_team = {{"team", request_json["team"]}};
+
+    // Omitting "opponents" plays the whole catalog
+    std::vector<std::shared_ptr<const OpponentEntry>> batch_opponents;
+    if (request_json.contains("opponents")) {
+      return_if(!request_json["opponents"].is_array(), 400,
+                "opponents must be an array of team ids");
+      for (const auto &id : request_json["opponents"]) {
+        return_if(!id.is_string(), 400,
+                  "opponents must be an array of team ids");
+        std::shared_ptr<const OpponentEntry> opponent =
+            opponents.find(id.get<std::string>());
+        return_if(!opponent, 400,
+                  "Unknown opponent: " + id.get<std::string>());
+        batch_opponents.push_back(opponent);
+      }
+    } else {
+      batch_opponents = opponents.all();
+    }
+    return_if(batch_opponents.empty(), 400, "No opponents to battle");
+
+    // Explicit seeds are crossed with every opponent; otherwise each
+    // opponent gets one fresh seed
+    std::vector<uint64_t> seeds;
+    if (request_json.contains("seeds")) {
+      return_if(!request_json["seeds"].is_array() ||
+                    request_json["seeds"].empty(),
+                400, "seeds must be a non-empty array of integers");
+      for (const auto &seed : request_json["seeds"]) {
+        return_if(!seed.is_number_unsigned(), 400,
+                  "seeds must be a non-empty array of integers");
+        seeds.push_back(seed.get<uint64_t>());
+      }
+    }
+
+    struct BatchEntry {
+      std::shared_ptr<const OpponentEntry> opponent;
+      uint64_t seed = 0;
+      BattleWorldResult result;
+    };
+
+    size_t battle_count = batch_opponents.size() *
+                          (seeds.empty() ? size_t{1} : seeds.size());
+    if (battle_count > static_cast<size_t>(config.max_batch_battles)) {
+      set_error_response(res, 400,
+                         "Batch too large. Maximum battles: " +
+                             std::to_string(config.max_batch_battles));
+      return;
+    }
+
+    // Checked before simulating so a full disk doesn't waste the batch
+    bool save_results = request_json.value("saveResults", false);
+    std::filesystem::path results_path = config.get_results_path();
+    if (save_results) {
+      return_if(!FileStorage::check_disk_space(results_path.string(),
+                                               1048576 * battle_count),
+                507, "Insufficient storage space");
+    }
+
+    std::vector<BatchEntry> entries;
+    entries.reserve(battle_count);
+    for (const auto &opponent : batch_opponents) {
+      if (seeds.empty()) {
+        entries.push_back(
+            {opponent, SeededRng::get_actually_random_number_random_seed(),
+             {}});
+        continue;
+      }
+      for (uint64_t seed : seeds) {
+        entries.push_back({opponent, seed, {}});
+      }
+    }
+
+    // Queue the whole batch on the world pool; its dispatchers spread the
+    // battles over the free worlds
+    std::vector<std::future<BattleWorldResult>> futures;
+    futures.reserve(entries.size());
+    for (const BatchEntry &entry : entries) {
+      futures.push_back(battle_worlds.submit(
+          make_battle_job(player_team, *entry.opponent, entry.seed)));
+    }
+    for (size_t i = 0; i < entries.size(); ++i) {
+      entries[i].result = futures[i].get();
+      record_battle_metrics(entries[i].result);
+    }
+
+    int wins = 0;
+    int losses = 0;
+    int ties = 0;
+    int timeouts = 0;
+    int errors = 0;
+    nlohmann::json battles = nlohmann::json::array();
+
+    for (const BatchEntry &entry : entries) {
+      nlohmann::json battle = {{"opponentId", entry.opponent->id},
+                               {"seed", entry.seed}};
+
+      if (entry.result.status == BattleWorldResult::Status::Timeout) {
+        battle["status"] = "timeout";
+        timeouts++;
+        battles.push_back(battle);
+        continue;
+      }
+      if (entry.result.status == BattleWorldResult::Status::Error) {
+        battle["status"] = "error";
+        battle["error"] = get_error_message(entry.result.error);
+        errors++;
+        battles.push_back(battle);
+        continue;
+      }
+
+      const nlohmann::json &response = entry.result.response;
+      nlohmann::json summary =
+          BattleSerializer::summarize_outcomes(response["outcomes"]);
+      std::string winner = summary["winner"];
+      if (winner == "Player") {
+        wins++;
+      } else if (winner == "Opponent") {
+        losses++;
+      } else {
+        ties++;
+      }
+
+      battle["status"] = "complete";
+      battle["winner"] = winner;
+      battle["playerWins"] = summary["playerWins"];
+      battle["opponentWins"] = summary["opponentWins"];
+      battle["ties"] = summary["ties"];
+      battle["checksum"] = response.value("checksum", std::string(""));
+      battles.push_back(battle);
+
+      if (save_results) {
+        nlohmann::json result_to_save = response;
+        result_to_save["playerTeamId"] =
+            request_json.value("playerTeamId", "");
+        result_to_save["opponentTeamId"] = entry.opponent->id;
+        BattleSerializer::event_log_to_base64(result_to_save);
+        results.append(std::to_string(entry.seed) + "_" + entry.opponent->id,
+                       std::move(result_to_save));
+      }
+    }
+
+    auto request_duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - request_start);
+    log_info("[{}] Batch of {} battles completed in {}ms", request_id,
+             entries.size(), request_duration.count());
+
+    nlohmann::json response = {
+        {"battles", battles},
+        {"summary",
+         {{"total", entries.size()},
+          {"wins", wins},
+          {"losses", losses},
+          {"ties", ties},
+          {"timeouts", timeouts},
+          {"errors", errors}}}};
+
+    res.status = 200;
+    set_body(req, res, response, encoding);
+
+  } catch (const nlohmann::json::exception &e) {
+    std::string error_msg =
+        get_error_message("Invalid JSON: " + std::string(e.what()));
+    nlohmann::json error = {{"error", error_msg}};
+    if (config.error_detail_level == "trace" ||
+        config.error_detail_level == "info") {
+      error["details"] = e.what();
+    }
+    res.status = 400;
+    res.set_content(error.dump(), "application/json");
+    log_error("[{}] Batch battle API JSON error: {}", request_id, e.what());
+  } catch (const std::exception &e) {
+    std::string error_msg =
+        get_error_message("Server error: " + std::string(e.what()));
+    nlohmann::json error = {{"error", error_msg}};
+    if (config.error_detail_level == "trace" ||
+        config.error_detail_level == "info") {
+      error["details"] = e.what();
+    }
+    res.status = 500;
+    res.set_content(error.dump(), "application/json");
+    log_error("[{}] Batch battle API error: {}", request_id, e.what());
+  }
 }
 
+constexpr const char *SERVER_VERSION = "0.1.0";
+
 void BattleAPI::handle_save_game_state(const httplib::Request &req,
                                        httplib::Response &res) {
   try {
-    std::string content_type = req.get_header_value("Content-Type");
-    return_if(content_type.find("application/json") == std::string::npos, 415,
-              "Content-Type must be application/json");
+    std::optional<wire_format::Encoding> request_encoding =
+        wire_format::from_media_type(req.get_header_value("Content-Type"));
+    return_if(!request_encoding, 415,
+              "Content-Type must be application/json, application/cbor or "
+              "application/msgpack");
+    wire_format::Encoding encoding = wire_format::from_accept(
+        req.get_header_value("Accept"), *request_encoding);
 
     return_if(req.body.empty(), 400, "Request body is empty");
 
-    nlohmann::json request_json = nlohmann::json::parse(req.body);
+    nlohmann::json request_json =
+        wire_format::decode(req.body, *request_encoding);
 
+    bool is_delta = request_json.contains("patch");
     return_if(!request_json.contains("userId") ||
-                  !request_json.contains("gameState") ||
-                  !request_json.contains("checksum"),
-              400, "Missing required fields: userId, gameState, checksum");
+                  !request_json.contains("checksum") ||
+                  (is_delta ? !request_json.contains("baseChecksum")
+                            : !request_json.contains("gameState")),
+              400,
+              "Missing required fields: userId, checksum and either "
+              "gameState or patch with baseChecksum");
+
+    // Older clients checksum with another algorithm, so every save would
+    // look like a mismatch
+    return_if(!is_delta && request_json["gameState"].value(
+                               "clientVersion", std::string("")) !=
+                               GAME_STATE_CLIENT_VERSION,
+              426,
+              std::string("Game state client version must be ") +
+                  GAME_STATE_CLIENT_VERSION);
 
     std::string userId = request_json["userId"].get<std::string>();
-    nlohmann::json gameState = request_json["gameState"];
     std::string client_checksum = request_json["checksum"].get<std::string>();
-    uint64_t timestamp = request_json.value(
-        "timestamp",
-        static_cast<uint64_t>(
-            std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now().time_since_epoch())
-                .count()));
-
-    std::string server_checksum = compute_game_state_checksum(gameState);
-
-    auto entry_opt = afterhours::EntityQuery({.force_merge = true})
-                         .whereHasComponent<server::async::TeamPoolEntry>()
-                         .whereLambda([&userId](const afterhours::Entity &e) {
-                           const server::async::TeamPoolEntry &entry =
-                               e.get<server::async::TeamPoolEntry>();
-                           return entry.userId == userId;
-                         })
-                         .gen_first();
-
-    bool match = (client_checksum == server_checksum);
-
-    if (entry_opt) {
-      auto &entry_entity = entry_opt.asE();
-      auto &entry = entry_entity.get<server::async::TeamPoolEntry>();
-
-      if (!entry.gameStateChecksum.empty()) {
-        match = (client_checksum == entry.gameStateChecksum);
-      }
 
-      entry.gameState = gameState;
-      entry.gameStateChecksum = server_checksum;
-      entry.lastSaved = timestamp;
-    } else {
-      auto &new_entity = afterhours::EntityHelper::createEntity();
-      auto &entry = new_entity.addComponent<server::async::TeamPoolEntry>();
-      entry.userId = userId;
-      entry.gameState = gameState;
-      entry.gameStateChecksum = server_checksum;
-      entry.lastSaved = timestamp;
+    GameStateStore::SaveResult saved =
+        is_delta
+            ? game_states.apply_delta(
+                  userId, request_json["baseChecksum"].get<std::string>(),
+                  request_json["patch"])
+            : game_states.save_full(userId, request_json["gameState"]);
+
+    if (saved.status == GameStateStore::Status::NotFound ||
+        saved.status == GameStateStore::Status::BaseMismatch) {
+      // The client's base is stale; it resends the full state
+      nlohmann::json conflict{{"error", "Base checksum does not match"},
+                              {"checksum", saved.checksum},
+                              {"version", saved.version},
+                              {"serverVersion", SERVER_VERSION}};
+      set_body(req, res, conflict, encoding);
+      res.status = 409;
+      return;
     }
+    return_if(saved.status == GameStateStore::Status::InvalidPatch, 400,
+              "Invalid game state patch: " + saved.error);
+
+    bool match = (client_checksum == saved.checksum);
 
     nlohmann::json response;
     response["status"] = "ok";
     response["match"] = match;
+    response["checksum"] = saved.checksum;
+    response["version"] = saved.version;
     response["serverVersion"] = SERVER_VERSION;
 
     if (!match) {
-      response["gameState"] = gameState;
+      if (std::optional<GameStateStore::Entry> entry =
+              game_states.get(userId)) {
+        response["gameState"] = std::move(entry->state);
+      }
     }
 
-    res.set_content(response.dump(), "application/json");
+    set_body(req, res, response, encoding);
     res.status = 200;
   } catch (const nlohmann::json::exception &e) {
     set_error_response(res, 400, "Invalid JSON: " + std::string(e.what()));
@@ -469,43 +828,97 @@ void BattleAPI::handle_get_game_state(const httplib::Request &req,
   try {
     std::string userId = req.get_param_value("userId");
     std::string checksum = req.get_param_value("checksum");
+    wire_format::Encoding encoding = wire_format::from_accept(
+        req.get_header_value("Accept"), wire_format::Encoding::Json);
 
     return_if(userId.empty(), 400, "Missing userId parameter");
     return_if(checksum.empty(), 400, "Missing checksum parameter");
 
-    auto entry_opt = afterhours::EntityQuery({.force_merge = true})
-                         .whereHasComponent<server::async::TeamPoolEntry>()
-                         .whereLambda([&userId](const afterhours::Entity &e) {
-                           const server::async::TeamPoolEntry &entry =
-                               e.get<server::async::TeamPoolEntry>();
-                           return entry.userId == userId;
-                         })
-                         .gen_first();
-
-    return_if(!entry_opt, 404, "Game state not found");
+    std::optional<GameStateStore::Entry> entry = game_states.get(userId);
 
-    const auto &entry = entry_opt.asE().get<server::async::TeamPoolEntry>();
+    return_if(!entry, 404, "Game state not found");
 
-    bool match = (checksum == entry.gameStateChecksum);
+    bool match = (checksum == entry->checksum);
 
     nlohmann::json response;
     response["status"] = "ok";
     response["match"] = match;
+    response["checksum"] = entry->checksum;
+    response["version"] = entry->version;
     response["serverVersion"] = SERVER_VERSION;
 
     if (!match) {
-      response["gameState"] = entry.gameState;
+      response["gameState"] = std::move(entry->state);
     }
 
-    res.set_content(response.dump(), "application/json");
+    set_body(req, res, response, encoding);
     res.status = 200;
   } catch (const std::exception &e) {
     set_error_response(res, 500, "Server error: " + std::string(e.what()));
   }
 }
 
+void BattleAPI::handle_results_request(const httplib::Request &req,
+                                       httplib::Response &res) {
+  try {
+    wire_format::Encoding encoding = wire_format::from_accept(
+        req.get_header_value("Accept"), wire_format::Encoding::Json);
+
+    size_t limit = 50;
+    if (req.has_param("limit")) {
+      limit = std::clamp<size_t>(std::stoul(req.get_param_value("limit")), 1,
+                                 500);
+    }
+
+    nlohmann::json response;
+    if (req.has_param("battleId")) {
+      std::optional<nlohmann::json> result =
+          results.find(req.get_param_value("battleId"));
+      return_if(!result, 404, "Battle result not found");
+      response = *result;
+    } else if (req.has_param("playerTeamId")) {
+      response["results"] =
+          results.for_player_team(req.get_param_value("playerTeamId"), limit);
+    } else if (req.has_param("since")) {
+      response["results"] =
+          results.since(std::stoll(req.get_param_value("since")), limit);
+    } else {
+      set_error_response(res, 400,
+                         "One of battleId, playerTeamId or since is required");
+      return;
+    }
+
+    set_body(req, res, response, encoding);
+    res.status = 200;
+  } catch (const std::invalid_argument &) {
+    set_error_response(res, 400, "limit and since must be numbers");
+  } catch (const std::exception &e) {
+    set_error_response(res, 500, "Server error: " + std::string(e.what()));
+  }
+}
+
 void BattleAPI::start(int port) {
   log_info("Starting battle server on port {}", port);
+  battle_worlds.start(config.get_battle_worker_count());
+  results.open(config.get_results_path(), config.get_result_retention());
+  game_states.open(config.get_game_states_path(),
+                   static_cast<size_t>(config.game_state_snapshot_every));
+  results.start_maintenance(
+      std::chrono::seconds(std::max(1, config.maintenance_interval_seconds)),
+      [this] {
+        if (config.debug) {
+          FileStorage::cleanup_old_files(config.get_temp_files_path().string(),
+                                         config.temp_file_retention_count,
+                                         ".json");
+        }
+      });
+  opponents.refresh(config.get_opponents_path(), config.max_team_size);
+  if (config.opponent_rescan_seconds > 0) {
+    opponents.start_watching(
+        config.get_opponents_path(),
+        std::chrono::seconds(config.opponent_rescan_seconds),
+        config.max_team_size);
+  }
   setup_routes();
 
   if (!server.listen("0.0.0.0", port)) {
@@ -513,5 +926,11 @@ void BattleAPI::start(int port) {
   }
 }
 
-void BattleAPI::stop() { server.stop(); }
+void BattleAPI::stop() {
+  server.stop();
+  opponents.stop_watching();
+  battle_worlds.stop();
+  results.stop_maintenance();
+  results_writer.flush();
+}
 } // namespace server
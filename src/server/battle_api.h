@@ -2,6 +2,11 @@
 
 #include "battle_serializer.h"
 #include "battle_simulator.h"
+#include "battle_world.h"
+#include "durable_writer.h"
+#include "game_state_store.h"
+#include "opponent_catalog.h"
+#include "result_store.h"
 #include "server_config.h"
 #include "team_manager.h"
 #include <httplib.h>
@@ -11,6 +16,11 @@ namespace server {
 struct BattleAPI {
   httplib::Server server;
   ServerConfig config;
+  BattleWorldPool battle_worlds;
+  OpponentCatalog opponents;
+  DurableWriter results_writer;
+  ResultStore results{results_writer};
+  GameStateStore game_states{results_writer};
 
   BattleAPI(const ServerConfig &cfg);
 
@@ -21,13 +31,26 @@ struct BattleAPI {
 private:
   void handle_battle_request(const httplib::Request &req,
                              httplib::Response &res);
+  void handle_batch_battle_request(const httplib::Request &req,
+                                   httplib::Response &res);
   void handle_health_request(const httplib::Request &req,
                              httplib::Response &res);
   void handle_save_game_state(const httplib::Request &req,
                               httplib::Response &res);
   void handle_get_game_state(const httplib::Request &req,
                              httplib::Response &res);
+  void handle_results_request(const httplib::Request &req,
+                              httplib::Response &res);
+  void handle_metrics_request(const httplib::Request &req,
+                              httplib::Response &res);
+  void handle_profile_request(const httplib::Request &req,
+                              httplib::Response &res);
+  BattleWorldJob make_battle_job(const nlohmann::json &player_team,
+                                 const OpponentEntry &opponent,
+                                 uint64_t seed) const;
+  bool check_code_hash(const nlohmann::json &request_json,
+                       httplib::Response &res,
+                       const std::string &request_id) const;
   std::string get_error_message(const std::string &detailed_error) const;
-  std::string compute_game_state_checksum(const nlohmann::json &state) const;
 };
 } // namespace server
@@ -8,6 +8,7 @@
 #include "../components/is_dish.h"
 #include "../components/trigger_event.h"
 #include "../dish_types.h"
+#include "../utils/battle_event_log.h"
 #include "../utils/battle_fingerprint.h"
 #include "async/battle_event.h"
 #include "battle_simulator.h"
@@ -20,6 +21,26 @@
 
 namespace server {
 namespace {
+int team_flavor_score(const nlohmann::json &team_json) {
+  int score = 0;
+  if (!team_json.contains("team") || !team_json["team"].is_array()) {
+    return score;
+  }
+  for (const auto &dish : team_json["team"]) {
+    if (dish.contains("dishType")) {
+      std::string dishTypeStr = dish["dishType"];
+      DishType dishType =
+          magic_enum::enum_cast<DishType>(dishTypeStr).value_or(DishType::Potato);
+      const DishInfo &dishInfo = get_dish_info(dishType);
+      score += dishInfo.flavor.satiety + dishInfo.flavor.sweetness +
+               dishInfo.flavor.spice + dishInfo.flavor.acidity +
+               dishInfo.flavor.umami + dishInfo.flavor.richness +
+               dishInfo.flavor.freshness;
+    }
+  }
+  return score;
+}
+
 // Helper to ensure BattleResult exists - creates it if missing
 void ensure_battle_result_exists() {
   if (afterhours::EntityHelper::has_singleton<BattleResult>()) {
@@ -42,62 +63,26 @@ void ensure_battle_result_exists() {
   int playerTeamScore = 0;
   int opponentTeamScore = 0;
 
-  // Calculate player score from team file
-  if (!req.playerJsonPath.empty()) {
-    try {
+  // Calculate scores from the in-memory teams, or the team files
+  try {
+    nlohmann::json playerTeam = req.playerTeamJson;
+    if (playerTeam.is_null() && !req.playerJsonPath.empty()) {
       std::ifstream playerFile(req.playerJsonPath);
-      nlohmann::json playerTeam;
       playerFile >> playerTeam;
-      if (playerTeam.contains("team") && playerTeam["team"].is_array()) {
-        for (const auto &dish : playerTeam["team"]) {
-          if (dish.contains("dishType")) {
-            std::string dishTypeStr = dish["dishType"];
-            DishType dishType = magic_enum::enum_cast<DishType>(dishTypeStr)
-                                    .value_or(DishType::Potato);
-            DishInfo dishInfo = get_dish_info(dishType);
-            playerTeamScore +=
-                dishInfo.flavor.satiety + dishInfo.flavor.sweetness +
-                dishInfo.flavor.spice + dishInfo.flavor.acidity +
-                dishInfo.flavor.umami + dishInfo.flavor.richness +
-                dishInfo.flavor.freshness;
-          }
-        }
-      }
-    } catch (...) {
-      // Fall back to tie
-      result.outcome = BattleResult::Outcome::Tie;
-      result.ties = 1;
-      return;
     }
-  }
+    playerTeamScore = team_flavor_score(playerTeam);
 
-  // Calculate opponent score from team file
-  if (!req.opponentJsonPath.empty()) {
-    try {
+    nlohmann::json opponentTeam = req.opponentTeamJson;
+    if (opponentTeam.is_null() && !req.opponentJsonPath.empty()) {
       std::ifstream opponentFile(req.opponentJsonPath);
-      nlohmann::json opponentTeam;
       opponentFile >> opponentTeam;
-      if (opponentTeam.contains("team") && opponentTeam["team"].is_array()) {
-        for (const auto &dish : opponentTeam["team"]) {
-          if (dish.contains("dishType")) {
-            std::string dishTypeStr = dish["dishType"];
-            DishType dishType = magic_enum::enum_cast<DishType>(dishTypeStr)
-                                    .value_or(DishType::Potato);
-            DishInfo dishInfo = get_dish_info(dishType);
-            opponentTeamScore +=
-                dishInfo.flavor.satiety + dishInfo.flavor.sweetness +
-                dishInfo.flavor.spice + dishInfo.flavor.acidity +
-                dishInfo.flavor.umami + dishInfo.flavor.richness +
-                dishInfo.flavor.freshness;
-          }
-        }
-      }
-    } catch (...) {
-      // Fall back to tie
-      result.outcome = BattleResult::Outcome::Tie;
-      result.ties = 1;
-      return;
     }
+    opponentTeamScore = team_flavor_score(opponentTeam);
+  } catch (...) {
+    // Fall back to tie
+    result.outcome = BattleResult::Outcome::Tie;
+    result.ties = 1;
+    return;
   }
 
   // Determine outcome
@@ -141,70 +126,79 @@ void ensure_battle_result_exists() {
 nlohmann::json BattleSerializer::serialize_battle_result(
     uint64_t seed, const std::string &opponent_id,
     const nlohmann::json &outcomes, const nlohmann::json &events,
-    bool debug_mode) {
+    bool debug_mode, const std::vector<uint8_t> &event_log) {
 
   nlohmann::json result = {{"seed", seed},
                            {"opponentId", opponent_id},
                            {"outcomes", outcomes},
-                           {"events", events},
                            {"debug", debug_mode}};
 
+  if (!events.is_null()) {
+    result["events"] = events;
+  }
+  if (!event_log.empty()) {
+    result["eventLog"] = nlohmann::json::binary(event_log);
+  }
+
   if (debug_mode) {
     result["snapshots"] = collect_state_snapshot(true);
   }
 
   result["checksum"] = compute_checksum(result);
+  result["checkpoints"] = collect_fingerprint_checkpoints();
 
   return result;
 }
 
 std::string BattleSerializer::compute_checksum(const nlohmann::json &) {
-  uint64_t fp = BattleFingerprint::compute();
+  return BattleFingerprint::to_hex(BattleFingerprint::final_hash());
+}
 
-  std::stringstream ss;
-  ss << std::hex << std::setfill('0') << std::setw(16) << fp;
-  return ss.str();
+nlohmann::json BattleSerializer::collect_fingerprint_checkpoints() {
+  nlohmann::json checkpoints = nlohmann::json::array();
+  auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+  if (!cq_entity.get().has<CombatQueue>()) {
+    return checkpoints;
+  }
+  for (const FingerprintCheckpoint &cp :
+       cq_entity.get().get<CombatQueue>().fingerprint_checkpoints) {
+    checkpoints.push_back(
+        {{"label", cp.label}, {"hash", BattleFingerprint::to_hex(cp.hash)}});
+  }
+  return checkpoints;
 }
 
 nlohmann::json
 BattleSerializer::collect_battle_events(const BattleSimulator &simulator) {
-  std::vector<async::DebugBattleEvent> events =
+  const std::vector<async::DebugBattleEvent> &events =
       simulator.get_accumulated_events();
 
-  std::sort(
-      events.begin(), events.end(),
-      [](const async::DebugBattleEvent &a, const async::DebugBattleEvent &b) {
-        return a.timestamp < b.timestamp;
-      });
-
-  nlohmann::json events_array = nlohmann::json::array();
+  auto by_timestamp = [](const async::DebugBattleEvent &a,
+                         const async::DebugBattleEvent &b) {
+    return a.timestamp < b.timestamp;
+  };
 
-  for (const async::DebugBattleEvent &ev : events) {
-    nlohmann::json event_json;
-    event_json["hook"] = std::string(magic_enum::enum_name(ev.hook));
-    event_json["sourceEntityId"] = ev.sourceEntityId;
-    event_json["slotIndex"] = ev.slotIndex;
-
-    std::string team_side_str;
-    switch (ev.teamSide) {
-    case DishBattleState::TeamSide::Player:
-      team_side_str = "Player";
-      break;
-    case DishBattleState::TeamSide::Opponent:
-      team_side_str = "Opponent";
-      break;
-    }
-    event_json["teamSide"] = team_side_str;
+  // Events are tracked in simulation order, so this only copies if a
+  // caller ever appends out of order
+  if (std::is_sorted(events.begin(), events.end(), by_timestamp)) {
+    return BattleEventLog::to_json(events);
+  }
 
-    event_json["timestamp"] = ev.timestamp;
-    event_json["courseIndex"] = ev.courseIndex;
-    event_json["payloadInt"] = ev.payloadInt;
-    event_json["payloadFloat"] = ev.payloadFloat;
+  std::vector<async::DebugBattleEvent> sorted = events;
+  std::stable_sort(sorted.begin(), sorted.end(), by_timestamp);
+  return BattleEventLog::to_json(sorted);
+}
 
-    events_array.push_back(event_json);
+void BattleSerializer::event_log_to_base64(nlohmann::json &result) {
+  auto it = result.find("eventLog");
+  if (it != result.end() && it->is_binary()) {
+    *it = BattleEventLog::to_base64(it->get_binary());
   }
+}
 
-  return events_array;
+std::vector<uint8_t>
+BattleSerializer::collect_event_log(const BattleSimulator &simulator) {
+  return simulator.get_event_log().bytes();
 }
 
 nlohmann::json BattleSerializer::collect_battle_outcomes() {
@@ -256,6 +250,36 @@ nlohmann::json BattleSerializer::collect_battle_outcomes() {
   return outcomes;
 }
 
+nlohmann::json
+BattleSerializer::summarize_outcomes(const nlohmann::json &outcomes) {
+  int player_wins = 0;
+  int opponent_wins = 0;
+  int ties = 0;
+
+  for (const auto &outcome : outcomes) {
+    std::string winner = outcome.value("winner", std::string("Tie"));
+    if (winner == "Player") {
+      player_wins++;
+    } else if (winner == "Opponent") {
+      opponent_wins++;
+    } else {
+      ties++;
+    }
+  }
+
+  std::string winner = "Tie";
+  if (player_wins > opponent_wins) {
+    winner = "Player";
+  } else if (opponent_wins > player_wins) {
+    winner = "Opponent";
+  }
+
+  return nlohmann::json{{"playerWins", player_wins},
+                        {"opponentWins", opponent_wins},
+                        {"ties", ties},
+                        {"winner", winner}};
+}
+
 nlohmann::json BattleSerializer::collect_state_snapshot(bool debug_mode) {
   if (!debug_mode) {
     return nlohmann::json::array();
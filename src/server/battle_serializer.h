@@ -3,21 +3,35 @@
 #include <cstdint>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
 namespace server {
 struct BattleSimulator;
 
 struct BattleSerializer {
-  static nlohmann::json serialize_battle_result(uint64_t seed,
-                                                const std::string &opponent_id,
-                                                const nlohmann::json &outcomes,
-                                                const nlohmann::json &events,
-                                                bool debug_mode = false);
+  // Null events are left out; a non-empty event_log is sent as a binary
+  // "eventLog", which CBOR and MessagePack carry as raw bytes
+  static nlohmann::json serialize_battle_result(
+      uint64_t seed, const std::string &opponent_id,
+      const nlohmann::json &outcomes, const nlohmann::json &events,
+      bool debug_mode = false, const std::vector<uint8_t> &event_log = {});
+  // JSON has no binary type, so JSON bodies and stored results carry the
+  // event log as base64 instead
+  static void event_log_to_base64(nlohmann::json &result);
 
+  // Rolling hash over the battle's fingerprint checkpoints
   static std::string compute_checksum(const nlohmann::json &state);
+  // [{label, hash}] for each checkpoint, in the order they were recorded
+  static nlohmann::json collect_fingerprint_checkpoints();
 
   static nlohmann::json collect_battle_events(const BattleSimulator &simulator);
+  // The simulator's binary event log (see BattleEventLog)
+  static std::vector<uint8_t>
+  collect_event_log(const BattleSimulator &simulator);
   static nlohmann::json collect_battle_outcomes();
+  // Tallies course winners into playerWins/opponentWins/ties plus an overall
+  // winner ("Player", "Opponent" or "Tie")
+  static nlohmann::json summarize_outcomes(const nlohmann::json &outcomes);
   static nlohmann::json collect_state_snapshot(bool debug_mode);
 };
 } // namespace server
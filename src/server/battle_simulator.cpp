@@ -1,15 +1,25 @@
 #include "battle_simulator.h"
+#include "../battle_timing.h"
+#include "../components/animation_event.h"
+#include "../components/battle_anim_keys.h"
 #include "../components/battle_load_request.h"
+#include "../components/battle_processor.h"
 #include "../components/battle_result.h"
 #include "../components/battle_team_tags.h"
 #include "../components/combat_queue.h"
 #include "../components/dish_battle_state.h"
 #include "../components/is_dish.h"
+#include "../components/pending_combat_mods.h"
+#include "../components/side_effect_tracker.h"
 #include "../components/trigger_queue.h"
 #include "../dish_types.h"
+#include "../game_state_manager.h"
 #include "../seeded_rng.h"
+#include "../shop.h"
+#include "../utils/system_profiler.h"
 #include "file_storage.h"
 #include <afterhours/ah.h>
+#include <afterhours/src/plugins/animation.h>
 #include <functional>
 
 namespace server {
@@ -23,33 +33,39 @@ BattleSimulator::BattleSimulator()
 void BattleSimulator::start_battle(
     const nlohmann::json &player_team_json,
     const nlohmann::json &opponent_team_json, uint64_t battle_seed,
-    const std::filesystem::path &temp_files_path) {
+    const std::filesystem::path &temp_files_path, bool write_team_files) {
 
   seed = battle_seed;
   simulation_time = 0.0f;
   battle_active = true;
   accumulated_events.clear();
+  event_log.clear();
   player_temp_file.clear();
   opponent_temp_file.clear();
 
   SeededRng::get().set_seed(seed);
 
-  FileStorage::ensure_directory_exists(temp_files_path.string());
-
-  player_temp_file =
+  // Teams are handed to the loaders in memory; the paths only identify the
+  // battle unless the files are written out for debugging
+  std::string player_path =
       (temp_files_path / ("temp_player_" + std::to_string(seed) + ".json"))
           .string();
-  opponent_temp_file =
+  std::string opponent_path =
       (temp_files_path / ("temp_opponent_" + std::to_string(seed) + ".json"))
           .string();
 
-  if (!FileStorage::save_json_to_file(player_temp_file, player_team_json)) {
-    log_error("Failed to save player temp file: {}", player_temp_file);
-    throw std::runtime_error("Failed to save player temp file");
-  }
-  if (!FileStorage::save_json_to_file(opponent_temp_file, opponent_team_json)) {
-    log_error("Failed to save opponent temp file: {}", opponent_temp_file);
-    throw std::runtime_error("Failed to save opponent temp file");
+  if (write_team_files) {
+    FileStorage::ensure_directory_exists(temp_files_path.string());
+    if (!FileStorage::save_json_to_file(player_path, player_team_json)) {
+      log_error("Failed to save player temp file: {}", player_path);
+      throw std::runtime_error("Failed to save player temp file");
+    }
+    if (!FileStorage::save_json_to_file(opponent_path, opponent_team_json)) {
+      log_error("Failed to save opponent temp file: {}", opponent_path);
+      throw std::runtime_error("Failed to save opponent temp file");
+    }
+    player_temp_file = player_path;
+    opponent_temp_file = opponent_path;
   }
 
   // Check if BattleLoadRequest singleton already exists (from previous
@@ -57,44 +73,38 @@ void BattleSimulator::start_battle(
   bool singletonExists =
       afterhours::EntityHelper::has_singleton<BattleLoadRequest>();
 
-  log_info("start_battle: BattleLoadRequest singleton exists={}",
-           singletonExists);
+  log_info_c(LogCategory::BATTLE_SIM,
+             "start_battle: BattleLoadRequest singleton exists={}",
+             singletonExists);
 
+  afterhours::Entity *request_entity = nullptr;
   if (singletonExists) {
-    log_info("start_battle: Reusing existing BattleLoadRequest singleton");
-    // Update existing singleton
-    auto existingRequest =
-        afterhours::EntityHelper::get_singleton<BattleLoadRequest>();
-    if (existingRequest.get().has<BattleLoadRequest>()) {
-      BattleLoadRequest &req = existingRequest.get().get<BattleLoadRequest>();
-      req.playerJsonPath = player_temp_file;
-      req.opponentJsonPath = opponent_temp_file;
-      req.loaded = false;
-    } else {
-      // Add component to existing entity
-      existingRequest.get().addComponent<BattleLoadRequest>();
-      BattleLoadRequest &req = existingRequest.get().get<BattleLoadRequest>();
-      req.playerJsonPath = player_temp_file;
-      req.opponentJsonPath = opponent_temp_file;
-      req.loaded = false;
+    log_info_c(LogCategory::BATTLE_SIM,
+               "start_battle: Reusing existing BattleLoadRequest singleton");
+    request_entity =
+        &afterhours::EntityHelper::get_singleton<BattleLoadRequest>().get();
+    if (!request_entity->has<BattleLoadRequest>()) {
+      request_entity->addComponent<BattleLoadRequest>();
     }
   } else {
-    // Create new singleton
-    log_info("start_battle: Creating new BattleLoadRequest singleton");
-    afterhours::Entity &request_entity =
-        afterhours::EntityHelper::createEntity();
-    request_entity.addComponent<BattleLoadRequest>();
-    BattleLoadRequest &req = request_entity.get<BattleLoadRequest>();
-    req.playerJsonPath = player_temp_file;
-    req.opponentJsonPath = opponent_temp_file;
-    req.loaded = false;
+    log_info_c(LogCategory::BATTLE_SIM,
+               "start_battle: Creating new BattleLoadRequest singleton");
+    request_entity = &afterhours::EntityHelper::createEntity();
+    request_entity->addComponent<BattleLoadRequest>();
     afterhours::EntityHelper::registerSingleton<BattleLoadRequest>(
-        request_entity);
-    log_info(
+        *request_entity);
+    log_info_c(LogCategory::BATTLE_SIM,
         "start_battle: Registered BattleLoadRequest singleton for entity {}",
-        request_entity.id);
+        request_entity->id);
   }
 
+  BattleLoadRequest &req = request_entity->get<BattleLoadRequest>();
+  req.playerJsonPath = player_path;
+  req.opponentJsonPath = opponent_path;
+  req.playerTeamJson = player_team_json;
+  req.opponentTeamJson = opponent_team_json;
+  req.loaded = false;
+
   afterhours::EntityHelper::merge_entity_arrays();
 }
 
@@ -118,7 +128,10 @@ void BattleSimulator::update(float dt) {
   simulation_time += dt;
 
   const float fixed_dt = 1.0f / 60.0f;
+  SystemProfiler &profiler = SystemProfiler::get();
+  profiler.begin_frame();
   ctx.systems.run(fixed_dt);
+  profiler.end_frame();
 
   // After running systems, check if battle completed and create BattleResult
   bool now_complete = is_complete();
@@ -127,6 +140,184 @@ void BattleSimulator::update(float dt) {
   }
 }
 
+int BattleSimulator::skip_idle_ticks(float dt, int max_ticks) {
+  if (!battle_active) {
+    return 0;
+  }
+
+  return advance_idle_span(dt, max_ticks);
+}
+
+static bool slide_in_finished(const afterhours::Entity &e) {
+  auto value =
+      afterhours::animation::get_value(BattleAnimKey::SlideIn, (size_t)e.id);
+  return !value.has_value() || value.value() >= 1.0f;
+}
+
+static BattleProcessor::DishSimData *
+find_processor_dish(std::vector<BattleProcessor::DishSimData> &dishes,
+                    int slot) {
+  for (BattleProcessor::DishSimData &dish : dishes) {
+    if (dish.slot == slot) {
+      return &dish;
+    }
+  }
+  return nullptr;
+}
+
+// Jumps over the ticks where both sides are only waiting out a pause. The
+// idle checks run once per jump: nothing that could end the wait changes
+// while every system is just counting down. The jump ends one tick before
+// either the cadence pause (ResolveCombatTickSystem) or the bite timer
+// (BattleProcessor) runs out, counted with the same BattleTiming helpers
+// those systems use, and the caller then runs a full update(). Any state
+// that could make a system do more than advance a timer skips nothing.
+// Enter, slide-in and course advance aren't jumped: headless mode already
+// finishes BattleEnterAnimationSystem and AnimationTimerSystem in a single
+// tick, and AdvanceCourseSystem has no timer, so each is one update().
+int BattleSimulator::advance_idle_span(float dt, int max_ticks) {
+  const float fixed_dt = 1.0f / 60.0f;
+
+  if (max_ticks <= 0 ||
+      GameStateManager::get().active_screen !=
+          GameStateManager::Screen::Battle ||
+      isReplayPaused()) {
+    return 0;
+  }
+
+  auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+  if (!cq_entity.get().has<CombatQueue>()) {
+    return 0;
+  }
+  const CombatQueue &cq = cq_entity.get().get<CombatQueue>();
+  if (cq.complete || !cq.current_player_dish_id ||
+      !cq.current_opponent_dish_id) {
+    return 0;
+  }
+
+  auto tq_entity = afterhours::EntityHelper::get_singleton<TriggerQueue>();
+  if (!tq_entity.get().has<TriggerQueue>() ||
+      !tq_entity.get().get<TriggerQueue>().empty()) {
+    return 0;
+  }
+
+  if (afterhours::EntityHelper::has_singleton<SideEffectTracker>()) {
+    auto tracker = afterhours::EntityHelper::get_singleton<SideEffectTracker>();
+    if (tracker.get().has<SideEffectTracker>() &&
+        tracker.get().get<SideEffectTracker>().enabled) {
+      return 0;
+    }
+  }
+
+  if (afterhours::EntityQuery({.ignore_temp_warning = true})
+          .whereHasComponent<AnimationEvent>()
+          .has_values()) {
+    return 0;
+  }
+
+  if (afterhours::EntityQuery({.ignore_temp_warning = true})
+          .whereHasComponent<PendingCombatMods>()
+          .whereLambda([](const afterhours::Entity &e) {
+            const PendingCombatMods &pending = e.get<PendingCombatMods>();
+            return pending.zingDelta != 0 || pending.bodyDelta != 0;
+          })
+          .has_values()) {
+    return 0;
+  }
+
+  afterhours::Entity *player = nullptr;
+  afterhours::Entity *opponent = nullptr;
+  for (afterhours::Entity &e : afterhours::EntityQuery(
+                                   {.ignore_temp_warning = true})
+                                   .whereHasComponent<DishBattleState>()
+                                   .gen()) {
+    const DishBattleState &dbs = e.get<DishBattleState>();
+    switch (dbs.phase) {
+    case DishBattleState::Phase::Entering:
+      return 0;
+    case DishBattleState::Phase::InQueue:
+      if (!dbs.onserve_fired) {
+        return 0;
+      }
+      break;
+    case DishBattleState::Phase::InCombat:
+      if (dbs.team_side == DishBattleState::TeamSide::Player) {
+        if (player != nullptr || dbs.queue_index != 0) {
+          return 0;
+        }
+        player = &e;
+      } else if (dbs.queue_index == 0 && opponent == nullptr) {
+        opponent = &e;
+      }
+      break;
+    case DishBattleState::Phase::Finished:
+      break;
+    }
+  }
+
+  if (player == nullptr || opponent == nullptr) {
+    return 0;
+  }
+
+  DishBattleState &player_dbs = player->get<DishBattleState>();
+  if (!player_dbs.first_bite_decided || !player->has<CombatStats>() ||
+      !slide_in_finished(*player) || !slide_in_finished(*opponent)) {
+    return 0;
+  }
+
+  float pause = BattleTiming::get_cadence_pause(
+      player_dbs.bite_cadence == DishBattleState::BiteCadence::PrePause);
+  int ticks = BattleTiming::ticks_until(player_dbs.bite_cadence_timer,
+                                        fixed_dt, pause, max_ticks);
+  if (ticks == 0) {
+    return 0;
+  }
+
+  BattleProcessor *processor = nullptr;
+  BattleProcessor::DishSimData *processor_dish = nullptr;
+  if (afterhours::EntityHelper::has_singleton<BattleProcessor>()) {
+    auto processor_entity =
+        afterhours::EntityHelper::get_singleton<BattleProcessor>();
+    if (processor_entity.get().has<BattleProcessor>()) {
+      processor = &processor_entity.get().get<BattleProcessor>();
+      if (!processor->isBattleActive() || !processor->simulationStarted ||
+          processor->simulationComplete) {
+        return 0;
+      }
+
+      processor_dish = find_processor_dish(processor->playerDishes,
+                                           processor->currentCourse);
+      BattleProcessor::DishSimData *processor_opponent = find_processor_dish(
+          processor->opponentDishes, processor->currentCourse);
+      if (processor_dish == nullptr || processor_opponent == nullptr ||
+          processor_dish->phase != BattleProcessor::DishSimData::InCombat ||
+          processor_opponent->phase !=
+              BattleProcessor::DishSimData::InCombat ||
+          !processor_dish->isPlayer) {
+        return 0;
+      }
+
+      ticks = BattleTiming::ticks_until(processor_dish->biteTimer, fixed_dt,
+                                        BattleTiming::get_tick_duration(),
+                                        ticks);
+      if (ticks == 0) {
+        return 0;
+      }
+    }
+  }
+
+  // Sums are accumulated tick by tick so they match update() to the bit
+  for (int i = 0; i < ticks; ++i) {
+    simulation_time += dt;
+    player_dbs.bite_cadence_timer += fixed_dt;
+    if (processor != nullptr) {
+      processor->simulationTime += fixed_dt;
+      processor_dish->biteTimer += fixed_dt;
+    }
+  }
+  return ticks;
+}
+
 bool BattleSimulator::is_complete() const { return ctx.is_battle_complete(); }
 
 nlohmann::json BattleSimulator::get_battle_state() const {
@@ -136,6 +327,10 @@ nlohmann::json BattleSimulator::get_battle_state() const {
 }
 
 void BattleSimulator::track_events(float timestamp, int course_index) {
+  if (!record_events) {
+    return;
+  }
+
   auto tq_entity = afterhours::EntityHelper::get_singleton<TriggerQueue>();
   if (!tq_entity.get().has<TriggerQueue>()) {
     return;
@@ -152,6 +347,7 @@ void BattleSimulator::track_events(float timestamp, int course_index) {
                                             .payloadInt = ev.payloadInt,
                                             .payloadFloat = ev.payloadFloat};
     accumulated_events.push_back(battle_event);
+    event_log.append(battle_event);
   }
 }
 
@@ -246,8 +442,8 @@ static void calculate_battle_result_from_teams(BattleResult &result) {
   for (const auto &entity_ref : playerEntities) {
     auto &entity = entity_ref.get();
     auto &dish = entity.get<IsDish>();
-    DishInfo dishInfo = get_dish_info(dish.type);
-    FlavorStats &flavor = dishInfo.flavor;
+    const DishInfo &dishInfo = get_dish_info(dish.type);
+    const FlavorStats &flavor = dishInfo.flavor;
     playerScore += flavor.satiety + flavor.sweetness + flavor.spice +
                    flavor.acidity + flavor.umami + flavor.richness +
                    flavor.freshness;
@@ -257,8 +453,8 @@ static void calculate_battle_result_from_teams(BattleResult &result) {
   for (const auto &entity_ref : opponentEntities) {
     auto &entity = entity_ref.get();
     auto &dish = entity.get<IsDish>();
-    DishInfo dishInfo = get_dish_info(dish.type);
-    FlavorStats &flavor = dishInfo.flavor;
+    const DishInfo &dishInfo = get_dish_info(dish.type);
+    const FlavorStats &flavor = dishInfo.flavor;
     opponentScore += flavor.satiety + flavor.sweetness + flavor.spice +
                      flavor.acidity + flavor.umami + flavor.richness +
                      flavor.freshness;
@@ -286,12 +482,13 @@ static void calculate_battle_result_from_teams(BattleResult &result) {
 void BattleSimulator::ensure_battle_result() {
   // Check if BattleResult already exists
   if (afterhours::EntityHelper::has_singleton<BattleResult>()) {
-    log_info(
+    log_info_c(LogCategory::BATTLE_SIM,
         "BattleSimulator::ensure_battle_result: BattleResult already exists");
     return;
   }
 
-  log_info("BattleSimulator::ensure_battle_result: Creating BattleResult");
+  log_info_c(LogCategory::BATTLE_SIM,
+             "BattleSimulator::ensure_battle_result: Creating BattleResult");
 
   BattleResult result;
 
@@ -318,8 +515,8 @@ void BattleSimulator::ensure_battle_result() {
   for (const auto &entity_ref : playerEntities) {
     auto &entity = entity_ref.get();
     auto &dish = entity.get<IsDish>();
-    DishInfo dishInfo = get_dish_info(dish.type);
-    FlavorStats &flavor = dishInfo.flavor;
+    const DishInfo &dishInfo = get_dish_info(dish.type);
+    const FlavorStats &flavor = dishInfo.flavor;
     playerTeamScore += flavor.satiety + flavor.sweetness + flavor.spice +
                        flavor.acidity + flavor.umami + flavor.richness +
                        flavor.freshness;
@@ -329,16 +526,17 @@ void BattleSimulator::ensure_battle_result() {
   for (const auto &entity_ref : opponentEntities) {
     auto &entity = entity_ref.get();
     auto &dish = entity.get<IsDish>();
-    DishInfo dishInfo = get_dish_info(dish.type);
-    FlavorStats &flavor = dishInfo.flavor;
+    const DishInfo &dishInfo = get_dish_info(dish.type);
+    const FlavorStats &flavor = dishInfo.flavor;
     opponentTeamScore += flavor.satiety + flavor.sweetness + flavor.spice +
                          flavor.acidity + flavor.umami + flavor.richness +
                          flavor.freshness;
   }
 
-  log_info("BattleSimulator::ensure_battle_result: Player team score: {}, "
-           "Opponent team score: {}",
-           playerTeamScore, opponentTeamScore);
+  log_info_c(LogCategory::BATTLE_SIM,
+             "BattleSimulator::ensure_battle_result: Player team score: {}, "
+             "Opponent team score: {}",
+             playerTeamScore, opponentTeamScore);
 
   // Determine outcome
   if (playerTeamScore > opponentTeamScore) {
@@ -375,9 +573,10 @@ void BattleSimulator::ensure_battle_result() {
   auto &ent = afterhours::EntityHelper::createEntity();
   ent.addComponent<BattleResult>(std::move(result));
   afterhours::EntityHelper::registerSingleton<BattleResult>(ent);
-  log_info("BattleSimulator::ensure_battle_result: Registered BattleResult "
-           "singleton for entity {}",
-           ent.id);
+  log_info_c(LogCategory::BATTLE_SIM,
+             "BattleSimulator::ensure_battle_result: Registered BattleResult "
+             "singleton for entity {}",
+             ent.id);
 }
 
 void BattleSimulator::cleanup_test_entities() {
@@ -482,4 +681,54 @@ void BattleSimulator::cleanup_temp_files() {
     }
   }
 }
+
+void BattleSimulator::reset() {
+  seed = 0;
+  battle_active = false;
+  simulation_time = 0.0f;
+  accumulated_events.clear();
+  event_log.clear();
+  player_temp_file.clear();
+  opponent_temp_file.clear();
+  ctx.reset_for_next_battle();
+}
+
+BattleSimulatorPool &BattleSimulatorPool::get() {
+  static BattleSimulatorPool pool;
+  return pool;
+}
+
+void BattleSimulatorPool::warm(size_t count) {
+  std::lock_guard<std::mutex> lock(mtx);
+  while (idle.size() < count) {
+    idle.push_back(std::make_unique<BattleSimulator>());
+  }
+}
+
+std::unique_ptr<BattleSimulator> BattleSimulatorPool::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!idle.empty()) {
+      std::unique_ptr<BattleSimulator> simulator = std::move(idle.back());
+      idle.pop_back();
+      return simulator;
+    }
+  }
+  return std::make_unique<BattleSimulator>();
+}
+
+void BattleSimulatorPool::release(std::unique_ptr<BattleSimulator> simulator,
+                                  bool completed) {
+  if (!simulator || !completed) {
+    return;
+  }
+  simulator->reset();
+  std::lock_guard<std::mutex> lock(mtx);
+  idle.push_back(std::move(simulator));
+}
+
+size_t BattleSimulatorPool::idle_count() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return idle.size();
+}
 } // namespace server
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../seeded_rng.h"
+#include "../utils/battle_event_log.h"
 #include "async/battle_event.h"
 #include "server_context.h"
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
@@ -15,6 +18,9 @@ struct BattleSimulator {
   bool battle_active;
   float simulation_time;
   std::vector<async::DebugBattleEvent> accumulated_events;
+  BattleEventLog event_log;
+  // Off leaves both event lists empty
+  bool record_events = true;
   std::string player_temp_file;
   std::string opponent_temp_file;
 
@@ -23,29 +29,57 @@ struct BattleSimulator {
   void start_battle(const nlohmann::json &player_team_json,
                     const nlohmann::json &opponent_team_json,
                     uint64_t battle_seed,
-                    const std::filesystem::path &temp_files_path);
+                    const std::filesystem::path &temp_files_path,
+                    bool write_team_files = false);
 
   void update(float dt);
 
+  // Skips, in one jump, the ticks whose only effect would be counting down
+  // a combat pause. Timers accumulate exactly as update() would, so results
+  // are identical. Returns the number of ticks skipped.
+  int skip_idle_ticks(float dt, int max_ticks);
+
   bool is_complete() const;
 
   float get_simulation_time() const { return simulation_time; }
 
   nlohmann::json get_battle_state() const;
 
-  std::vector<async::DebugBattleEvent> get_accumulated_events() const {
+  const std::vector<async::DebugBattleEvent> &get_accumulated_events() const {
     return accumulated_events;
   }
 
+  const BattleEventLog &get_event_log() const { return event_log; }
+
   // Static cleanup function for tests - cleans up all battle entities
   static void cleanup_test_entities();
 
-  // Clean up temp files created for this battle
+  // Clean up team files written for this battle in debug mode
   void cleanup_temp_files();
 
+  // Prepares a finished simulator for another start_battle() call, keeping
+  // its registered systems and buffers
+  void reset();
+
 private:
   void track_events(float timestamp, int course_index);
+  int advance_idle_span(float dt, int max_ticks);
   void create_battle_result();
   void ensure_battle_result();
 };
+
+// Keeps finished simulators warm so each battle doesn't rebuild its system
+// graph. Simulators released after a timeout or error are discarded.
+struct BattleSimulatorPool {
+  static BattleSimulatorPool &get();
+
+  void warm(size_t count);
+  std::unique_ptr<BattleSimulator> acquire();
+  void release(std::unique_ptr<BattleSimulator> simulator, bool completed);
+  size_t idle_count();
+
+private:
+  std::mutex mtx;
+  std::vector<std::unique_ptr<BattleSimulator>> idle;
+};
 } // namespace server
@@ -0,0 +1,580 @@
+#include "battle_world.h"
+#include "../log.h"
+#include "../utils/system_profiler.h"
+#include "battle_serializer.h"
+#include "battle_simulator.h"
+#include <chrono>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace server {
+nlohmann::json BattleWorldJob::to_json() const {
+  return nlohmann::json{{"playerTeam", player_team},
+                        {"opponentTeam", opponent_team},
+                        {"opponentId", opponent_id},
+                        {"seed", seed},
+                        {"maxIterations", max_iterations},
+                        {"timeoutSeconds", timeout_seconds},
+                        {"debug", debug_mode},
+                        {"instant", instant},
+                        {"jsonEvents", json_events},
+                        {"collectEvents", collect_events},
+                        {"tempFilesPath", temp_files_path}};
+}
+
+BattleWorldJob BattleWorldJob::from_json(const nlohmann::json &j) {
+  BattleWorldJob job;
+  job.player_team = j.at("playerTeam");
+  job.opponent_team = j.at("opponentTeam");
+  job.opponent_id = j.value("opponentId", std::string(""));
+  job.seed = j.value("seed", static_cast<uint64_t>(0));
+  job.max_iterations = j.value("maxIterations", 0);
+  job.timeout_seconds = j.value("timeoutSeconds", 0);
+  job.debug_mode = j.value("debug", false);
+  job.instant = j.value("instant", true);
+  job.json_events = j.value("jsonEvents", false);
+  job.collect_events = j.value("collectEvents", true);
+  job.temp_files_path = j.value("tempFilesPath", std::string(""));
+  return job;
+}
+
+nlohmann::json BattleWorldResult::to_json() const {
+  return nlohmann::json{{"status", static_cast<int>(status)},
+                        {"iterations", iterations},
+                        {"simulationTime", simulation_time},
+                        {"systemsSeconds", systems_seconds},
+                        {"systemsTicks", systems_ticks},
+                        {"systemProfile", system_profile},
+                        {"response", response},
+                        {"error", error}};
+}
+
+BattleWorldResult BattleWorldResult::from_json(const nlohmann::json &j) {
+  BattleWorldResult result;
+  result.status = static_cast<Status>(j.value("status", 2));
+  result.iterations = j.value("iterations", 0);
+  result.simulation_time = j.value("simulationTime", 0.0f);
+  result.systems_seconds = j.value("systemsSeconds", 0.0);
+  result.systems_ticks = j.value("systemsTicks", 0);
+  result.system_profile = j.value("systemProfile", nlohmann::json());
+  result.response = j.value("response", nlohmann::json{});
+  result.error = j.value("error", std::string(""));
+  return result;
+}
+
+BattleWorldResult BattleWorld::simulate(const BattleWorldJob &job) {
+  BattleWorldResult result;
+  std::unique_ptr<BattleSimulator> warm = BattleSimulatorPool::get().acquire();
+  BattleSimulator &simulator = *warm;
+
+  try {
+    simulator.record_events = job.collect_events;
+    simulator.start_battle(job.player_team, job.opponent_team, job.seed,
+                           job.temp_files_path, job.debug_mode);
+
+    const float fixed_dt = 1.0f / 60.0f;
+    auto start_time = std::chrono::steady_clock::now();
+    bool timed_out = false;
+
+    while (!simulator.is_complete() &&
+           result.iterations < job.max_iterations) {
+      auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::steady_clock::now() - start_time)
+                         .count();
+      if (elapsed >= job.timeout_seconds) {
+        timed_out = true;
+        break;
+      }
+
+      if (job.instant) {
+        result.iterations += simulator.skip_idle_ticks(
+            fixed_dt, job.max_iterations - result.iterations);
+        if (result.iterations >= job.max_iterations) {
+          break;
+        }
+      }
+
+      auto update_start = std::chrono::steady_clock::now();
+      simulator.update(fixed_dt);
+      result.systems_seconds += std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() -
+                                    update_start)
+                                    .count();
+      result.systems_ticks++;
+      result.iterations++;
+    }
+
+    result.simulation_time = simulator.get_simulation_time();
+
+    if (timed_out || result.iterations >= job.max_iterations) {
+      result.status = BattleWorldResult::Status::Timeout;
+    } else {
+      nlohmann::json outcomes = BattleSerializer::collect_battle_outcomes();
+      if (!job.collect_events) {
+        result.response = BattleSerializer::serialize_battle_result(
+            job.seed, job.opponent_id, outcomes, nullptr, job.debug_mode);
+      } else if (job.json_events) {
+        result.response = BattleSerializer::serialize_battle_result(
+            job.seed, job.opponent_id, outcomes,
+            BattleSerializer::collect_battle_events(simulator),
+            job.debug_mode);
+      } else {
+        result.response = BattleSerializer::serialize_battle_result(
+            job.seed, job.opponent_id, outcomes, nullptr, job.debug_mode,
+            BattleSerializer::collect_event_log(simulator));
+      }
+      result.status = BattleWorldResult::Status::Complete;
+    }
+  } catch (const std::exception &e) {
+    result.status = BattleWorldResult::Status::Error;
+    result.error = e.what();
+  }
+
+  if (SystemProfiler::get().enabled()) {
+    result.system_profile = SystemProfiler::get().drain_summary();
+  }
+
+  // Debug team files are kept and pruned by the API's retention cleanup
+  BattleSimulator::cleanup_test_entities();
+  BattleSimulatorPool::get().release(
+      std::move(warm), result.status == BattleWorldResult::Status::Complete);
+  return result;
+}
+
+#ifndef _WIN32
+namespace {
+bool write_all(int fd, const uint8_t *data, size_t size) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool read_all(int fd, uint8_t *data, size_t size) {
+  while (size > 0) {
+    ssize_t got = ::read(fd, data, size);
+    if (got < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (got == 0)
+      return false;
+    data += got;
+    size -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+bool write_message(int fd, const nlohmann::json &message) {
+  std::vector<uint8_t> payload = nlohmann::json::to_cbor(message);
+  uint32_t size = static_cast<uint32_t>(payload.size());
+  return write_all(fd, reinterpret_cast<const uint8_t *>(&size),
+                   sizeof(size)) &&
+         write_all(fd, payload.data(), payload.size());
+}
+
+bool read_message(int fd, nlohmann::json &message) {
+  uint32_t size = 0;
+  if (!read_all(fd, reinterpret_cast<uint8_t *>(&size), sizeof(size)))
+    return false;
+  std::vector<uint8_t> payload(size);
+  if (!read_all(fd, payload.data(), payload.size()))
+    return false;
+  message = nlohmann::json::from_cbor(payload);
+  return true;
+}
+
+void close_inherited_fds(int keep_a, int keep_b) {
+  long max_fd = sysconf(_SC_OPEN_MAX);
+  if (max_fd < 0 || max_fd > 4096)
+    max_fd = 4096;
+  for (int fd = 3; fd < static_cast<int>(max_fd); ++fd) {
+    if (fd != keep_a && fd != keep_b)
+      ::close(fd);
+  }
+}
+
+// Sends a world's pid along with its two parent-side pipe ends
+bool send_world(int socket_fd, int world_pid, int request_fd,
+                int response_fd) {
+  int32_t payload = world_pid;
+  iovec iov{&payload, sizeof(payload)};
+  alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+  int fds[2] = {request_fd, response_fd};
+  std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+  ssize_t sent;
+  do {
+    sent = ::sendmsg(socket_fd, &msg, 0);
+  } while (sent < 0 && errno == EINTR);
+  return sent == static_cast<ssize_t>(sizeof(payload));
+}
+
+bool receive_world(int socket_fd, int &world_pid, int &request_fd,
+                   int &response_fd) {
+  int32_t payload = -1;
+  iovec iov{&payload, sizeof(payload)};
+  alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t got;
+  do {
+    got = ::recvmsg(socket_fd, &msg, 0);
+  } while (got < 0 && errno == EINTR);
+  if (got != static_cast<ssize_t>(sizeof(payload)) || payload <= 0)
+    return false;
+
+  cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == nullptr || cmsg->cmsg_type != SCM_RIGHTS ||
+      cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+    return false;
+  int fds[2];
+  std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+  world_pid = payload;
+  request_fd = fds[0];
+  response_fd = fds[1];
+  return true;
+}
+
+// Forks a world process running worker_loop; in the child this never
+// returns. The child keeps only its two pipe ends.
+pid_t fork_world(int &request_fd, int &response_fd) {
+  int to_worker[2];
+  int from_worker[2];
+  if (pipe(to_worker) != 0)
+    return -1;
+  if (pipe(from_worker) != 0) {
+    ::close(to_worker[0]);
+    ::close(to_worker[1]);
+    return -1;
+  }
+
+  pid_t child = fork();
+  if (child < 0) {
+    ::close(to_worker[0]);
+    ::close(to_worker[1]);
+    ::close(from_worker[0]);
+    ::close(from_worker[1]);
+    return -1;
+  }
+
+  if (child == 0) {
+    close_inherited_fds(to_worker[0], from_worker[1]);
+    signal(SIGCHLD, SIG_DFL);
+    BattleSimulatorPool::get().warm(1);
+    BattleWorld::worker_loop(to_worker[0], from_worker[1]);
+    // _exit skips atexit handlers, so drain queued log lines by hand
+    log_flush();
+    _exit(0);
+  }
+
+  ::close(to_worker[0]);
+  ::close(from_worker[1]);
+  request_fd = to_worker[1];
+  response_fd = from_worker[0];
+  return child;
+}
+} // namespace
+
+bool BattleWorldZygote::start() {
+  shutdown();
+
+  int sockets[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+    return false;
+
+  pid_t child = fork();
+  if (child < 0) {
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+    return false;
+  }
+
+  if (child == 0) {
+    close_inherited_fds(sockets[1], -1);
+    serve(sockets[1]);
+  }
+
+  ::close(sockets[1]);
+  pid = child;
+  socket_fd = sockets[0];
+  return true;
+}
+
+void BattleWorldZygote::serve(int fd) {
+  // Worlds are our children; let the kernel reap them
+  signal(SIGCHLD, SIG_IGN);
+
+  uint8_t request = 0;
+  while (read_all(fd, &request, sizeof(request))) {
+    int request_fd = -1;
+    int response_fd = -1;
+    pid_t world = fork_world(request_fd, response_fd);
+    if (world < 0) {
+      int32_t failed = -1;
+      if (!write_all(fd, reinterpret_cast<const uint8_t *>(&failed),
+                     sizeof(failed)))
+        break;
+      continue;
+    }
+    bool sent = send_world(fd, world, request_fd, response_fd);
+    // The parent has its own copies now
+    ::close(request_fd);
+    ::close(response_fd);
+    if (!sent)
+      break;
+  }
+
+  // The parent closed its end; worlds notice their own pipes closing
+  log_flush();
+  _exit(0);
+}
+
+bool BattleWorldZygote::spawn(int &world_pid, int &request_fd,
+                              int &response_fd) {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (socket_fd < 0)
+    return false;
+  uint8_t request = 1;
+  return write_all(socket_fd, &request, sizeof(request)) &&
+         receive_world(socket_fd, world_pid, request_fd, response_fd);
+}
+
+void BattleWorldZygote::shutdown() {
+  if (socket_fd >= 0) {
+    ::close(socket_fd);
+    socket_fd = -1;
+  }
+  if (pid > 0) {
+    waitpid(pid, nullptr, 0);
+    pid = -1;
+  }
+}
+
+void BattleWorld::worker_loop(int in_fd, int out_fd) {
+  nlohmann::json message;
+  while (read_message(in_fd, message)) {
+    BattleWorldResult result;
+    try {
+      result = simulate(BattleWorldJob::from_json(message));
+    } catch (const std::exception &e) {
+      result.status = BattleWorldResult::Status::Error;
+      result.error = e.what();
+    }
+    if (!write_message(out_fd, result.to_json()))
+      return;
+  }
+}
+
+bool BattleWorld::start() {
+  shutdown();
+
+  if (zygote != nullptr) {
+    forked_directly = false;
+    return zygote->spawn(pid, request_fd, response_fd);
+  }
+
+  pid_t child = fork_world(request_fd, response_fd);
+  if (child < 0)
+    return false;
+  pid = child;
+  forked_directly = true;
+  return true;
+}
+
+void BattleWorld::shutdown() {
+  if (request_fd >= 0) {
+    ::close(request_fd);
+    request_fd = -1;
+  }
+  if (response_fd >= 0) {
+    ::close(response_fd);
+    response_fd = -1;
+  }
+  // Zygote worlds are reaped by the zygote as soon as they exit, so their
+  // pid may already belong to another process; closing the pipes is what
+  // ends them
+  if (pid > 0 && forked_directly) {
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+  }
+  pid = -1;
+}
+
+BattleWorldResult BattleWorld::run(const BattleWorldJob &job) {
+  if (!is_alive() && !start()) {
+    BattleWorldResult result;
+    result.error = "Failed to start battle world";
+    return result;
+  }
+
+  nlohmann::json message;
+  if (!write_message(request_fd, job.to_json()) ||
+      !read_message(response_fd, message)) {
+    log_warn("Battle world {} exited unexpectedly, restarting", pid);
+    shutdown();
+    BattleWorldResult result;
+    result.error = "Battle world exited unexpectedly";
+    return result;
+  }
+
+  return BattleWorldResult::from_json(message);
+}
+#else
+bool BattleWorldZygote::start() { return false; }
+
+void BattleWorldZygote::shutdown() {}
+
+bool BattleWorldZygote::spawn(int &, int &, int &) { return false; }
+
+void BattleWorldZygote::serve(int) { std::abort(); }
+
+void BattleWorld::worker_loop(int, int) {}
+
+bool BattleWorld::start() { return false; }
+
+void BattleWorld::shutdown() {}
+
+BattleWorldResult BattleWorld::run(const BattleWorldJob &job) {
+  return simulate(job);
+}
+#endif
+
+void BattleWorldPool::start(size_t count) {
+  stop();
+
+#ifndef _WIN32
+  signal(SIGPIPE, SIG_IGN);
+#endif
+
+  std::vector<std::unique_ptr<BattleWorld>> started;
+  if (count > 0 && !zygote.start()) {
+    log_warn("Failed to start battle world zygote, running in-process");
+    count = 0;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    auto world = std::make_unique<BattleWorld>();
+    world->zygote = &zygote;
+    if (!world->start()) {
+      log_warn("Failed to start battle world {}, running with {}", i,
+               started.size());
+      break;
+    }
+    started.push_back(std::move(world));
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  stopping = false;
+  for (auto &world : started) {
+    dispatchers.emplace_back(&BattleWorldPool::dispatch_loop, this,
+                             std::ref(*world));
+    worlds.push_back(std::move(world));
+  }
+  log_info("Battle world pool started with {} worlds", worlds.size());
+}
+
+void BattleWorldPool::stop() {
+  std::deque<PendingBattle> failed;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+    failed = std::move(pending);
+    pending.clear();
+  }
+  pending_cv.notify_all();
+  for (PendingBattle &battle : failed) {
+    battle.promise.set_value(stopping_result());
+  }
+
+  // Dispatchers finish their in-flight battle before exiting
+  for (std::thread &dispatcher : dispatchers) {
+    if (dispatcher.joinable()) {
+      dispatcher.join();
+    }
+  }
+  dispatchers.clear();
+
+  std::vector<std::unique_ptr<BattleWorld>> retired;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    retired = std::move(worlds);
+    worlds.clear();
+  }
+  // Shutting worlds down waits on their processes, so do it unlocked
+  retired.clear();
+  zygote.shutdown();
+}
+
+BattleWorldResult BattleWorldPool::stopping_result() {
+  BattleWorldResult result;
+  result.error = "Battle world pool is stopping";
+  return result;
+}
+
+void BattleWorldPool::dispatch_loop(BattleWorld &world) {
+  while (true) {
+    PendingBattle battle;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      pending_cv.wait(lock, [this] { return stopping || !pending.empty(); });
+      if (stopping) {
+        return;
+      }
+      battle = std::move(pending.front());
+      pending.pop_front();
+    }
+    battle.promise.set_value(world.run(battle.job));
+  }
+}
+
+std::future<BattleWorldResult> BattleWorldPool::submit(BattleWorldJob job) {
+  std::promise<BattleWorldResult> promise;
+  std::future<BattleWorldResult> future = promise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopping) {
+      promise.set_value(stopping_result());
+      return future;
+    }
+    if (!worlds.empty()) {
+      pending.push_back({std::move(job), std::move(promise)});
+      pending_cv.notify_one();
+      return future;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(inline_mtx);
+  promise.set_value(BattleWorld::simulate(job));
+  return future;
+}
+} // namespace server
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace server {
+struct BattleWorldJob {
+  nlohmann::json player_team;
+  nlohmann::json opponent_team;
+  std::string opponent_id;
+  uint64_t seed = 0;
+  int max_iterations = 0;
+  int timeout_seconds = 0;
+  bool debug_mode = false;
+  bool instant = true;
+  // Render events as JSON instead of the binary event log
+  bool json_events = false;
+  // Off when only the outcomes are read, e.g. the balance CLI
+  bool collect_events = true;
+  std::string temp_files_path;
+
+  nlohmann::json to_json() const;
+  static BattleWorldJob from_json(const nlohmann::json &j);
+};
+
+struct BattleWorldResult {
+  enum struct Status { Complete, Timeout, Error } status = Status::Error;
+  int iterations = 0;
+  float simulation_time = 0.0f;
+  // Wall time spent in simulator updates and how many updates ran
+  double systems_seconds = 0.0;
+  int systems_ticks = 0;
+  // SystemProfiler totals for this battle when profiling is on
+  nlohmann::json system_profile;
+  nlohmann::json response;
+  std::string error;
+
+  nlohmann::json to_json() const;
+  static BattleWorldResult from_json(const nlohmann::json &j);
+};
+
+// Forks battle worlds on the pool's behalf. The zygote itself is forked once
+// when the pool starts, before the server has any threads besides the
+// logger (which re-arms itself with pthread_atfork). Every world, including
+// replacements for ones that died mid-battle, is forked from the zygote, so
+// no fork ever happens in a process where httplib, catalog, maintenance or
+// durable-writer threads might be holding a lock.
+struct BattleWorldZygote {
+  int pid = -1;
+  int socket_fd = -1;
+
+  BattleWorldZygote() = default;
+  BattleWorldZygote(const BattleWorldZygote &) = delete;
+  BattleWorldZygote &operator=(const BattleWorldZygote &) = delete;
+  ~BattleWorldZygote() { shutdown(); }
+
+  bool start();
+  void shutdown();
+  bool is_alive() const { return pid > 0; }
+  // Forks a world and hands back its pid and the parent's pipe ends
+  bool spawn(int &world_pid, int &request_fd, int &response_fd);
+
+private:
+  std::mutex mtx;
+
+  [[noreturn]] static void serve(int fd);
+};
+
+// A BattleWorld is an isolated simulation context with its own entity
+// storage, singletons and RNG. afterhours::EntityHelper is process-global, so
+// each world is a forked worker process and battles running in different
+// worlds never share ECS state.
+struct BattleWorld {
+  int pid = -1;
+  int request_fd = -1;
+  int response_fd = -1;
+  // Worlds spawned through a zygote are its children, not ours, and are
+  // reaped there; without one the world is forked directly
+  BattleWorldZygote *zygote = nullptr;
+
+  BattleWorld() = default;
+  BattleWorld(const BattleWorld &) = delete;
+  BattleWorld &operator=(const BattleWorld &) = delete;
+  ~BattleWorld() { shutdown(); }
+
+  static BattleWorldResult simulate(const BattleWorldJob &job);
+
+  bool start();
+  void shutdown();
+  bool is_alive() const { return pid > 0; }
+  BattleWorldResult run(const BattleWorldJob &job);
+
+  static void worker_loop(int in_fd, int out_fd);
+
+private:
+  bool forked_directly = false;
+};
+
+// Each world has a dispatcher thread, started with the pool, that feeds it
+// queued battles one at a time. Requests submit battles and wait on the
+// returned futures instead of spinning up threads of their own.
+struct BattleWorldPool {
+  BattleWorldPool() = default;
+  BattleWorldPool(const BattleWorldPool &) = delete;
+  BattleWorldPool &operator=(const BattleWorldPool &) = delete;
+  ~BattleWorldPool() { stop(); }
+
+  // With no worlds, battles run in-process one at a time
+  void start(size_t count);
+  // Fails new and queued battles, waits for in-flight ones, then shuts the
+  // worlds down
+  void stop();
+
+  // Queues a battle for the next free world. Without worlds it runs on the
+  // calling thread and the future is ready on return.
+  std::future<BattleWorldResult> submit(BattleWorldJob job);
+  BattleWorldResult run(const BattleWorldJob &job) { return submit(job).get(); }
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return worlds.size();
+  }
+  // Battles waiting for a free world
+  size_t queued() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return pending.size();
+  }
+
+private:
+  struct PendingBattle {
+    BattleWorldJob job;
+    std::promise<BattleWorldResult> promise;
+  };
+
+  BattleWorldZygote zygote;
+  std::vector<std::unique_ptr<BattleWorld>> worlds;
+  std::vector<std::thread> dispatchers;
+  std::deque<PendingBattle> pending;
+  mutable std::mutex mtx;
+  std::condition_variable pending_cv;
+  bool stopping = false;
+  std::mutex inline_mtx;
+
+  void dispatch_loop(BattleWorld &world);
+  static BattleWorldResult stopping_result();
+};
+} // namespace server
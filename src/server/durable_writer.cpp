@@ -0,0 +1,205 @@
+#include "durable_writer.h"
+#include "../log.h"
+#include "file_storage.h"
+#include "metrics.h"
+#include <algorithm>
+#include <filesystem>
+#include <set>
+
+namespace server {
+nlohmann::json DurableWriteStats::to_json() const {
+  return nlohmann::json{
+      {"writes", writes},
+      {"failures", failures},
+      {"batches", batches},
+      {"bytes", bytes},
+      {"pending", pending},
+      {"avgLatencyMs", writes > 0 ? total_latency_ms / writes : 0.0},
+      {"maxLatencyMs", max_latency_ms}};
+}
+
+DurableWriter::DurableWriter() : thread([this] { commit_loop(); }) {}
+
+std::future<bool> DurableWriter::write(const std::string &path,
+                                       std::string contents) {
+  return enqueue(PendingWrite{path, std::move(contents), false,
+                              std::promise<bool>(),
+                              std::chrono::steady_clock::now(),
+                              {}});
+}
+
+std::future<bool>
+DurableWriter::append(const std::string &path, std::string contents,
+                      std::function<void(bool)> on_committed) {
+  return enqueue(PendingWrite{path, std::move(contents), true,
+                              std::promise<bool>(),
+                              std::chrono::steady_clock::now(),
+                              std::move(on_committed)});
+}
+
+std::future<bool> DurableWriter::enqueue(PendingWrite pending) {
+  std::future<bool> result = pending.done.get_future();
+
+  std::unique_lock<std::mutex> lock(mtx);
+  if (stopping) {
+    lock.unlock();
+    std::vector<PendingWrite> batch;
+    batch.push_back(std::move(pending));
+    commit(batch);
+    return result;
+  }
+  queue.push_back(std::move(pending));
+  totals.pending = queue.size();
+  lock.unlock();
+  queue_cv.notify_one();
+  return result;
+}
+
+std::future<bool> DurableWriter::write_json(const std::string &path,
+                                            const nlohmann::json &data) {
+  return write(path, data.dump());
+}
+
+void DurableWriter::flush() {
+  std::unique_lock<std::mutex> lock(mtx);
+  idle_cv.wait(lock, [this] { return queue.empty() && !committing; });
+}
+
+void DurableWriter::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopping) {
+      return;
+    }
+    stopping = true;
+  }
+  queue_cv.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+DurableWriteStats DurableWriter::stats() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return totals;
+}
+
+void DurableWriter::commit_loop() {
+  while (true) {
+    std::vector<PendingWrite> batch;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      // Everything that arrived while the last batch was syncing commits
+      // together
+      batch.swap(queue);
+      totals.pending = 0;
+      committing = true;
+    }
+
+    commit(batch);
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      committing = false;
+    }
+    idle_cv.notify_all();
+  }
+}
+
+void DurableWriter::commit(std::vector<PendingWrite> &batch) {
+  std::vector<std::string> temp_paths(batch.size());
+  std::vector<bool> ok(batch.size(), false);
+  std::set<std::string> directories;
+  std::set<std::string> appended;
+  uint64_t bytes = 0;
+
+  // Replacement contents are written and fsynced up front
+  for (size_t i = 0; i < batch.size(); ++i) {
+    std::filesystem::path path(batch[i].path);
+    if (path.has_parent_path()) {
+      FileStorage::ensure_directory_exists(path.parent_path().string());
+      directories.insert(path.parent_path().string());
+    }
+    if (batch[i].append) {
+      continue;
+    }
+    temp_paths[i] = FileStorage::make_temp_path(batch[i].path);
+    ok[i] = FileStorage::write_file(temp_paths[i], batch[i].contents, true);
+    if (!ok[i]) {
+      log_warn("Durable write failed for {}", batch[i].path);
+      std::error_code ec;
+      std::filesystem::remove(temp_paths[i], ec);
+    }
+  }
+
+  // Renames and appends then run in queue order, so the newest write to a
+  // path wins and an append after a replacement lands in the new file
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (batch[i].append) {
+      ok[i] = FileStorage::append_file(batch[i].path, batch[i].contents,
+                                       false);
+      if (ok[i]) {
+        appended.insert(batch[i].path);
+      } else {
+        log_warn("Durable append failed for {}", batch[i].path);
+      }
+    } else if (ok[i]) {
+      ok[i] = FileStorage::replace_file(temp_paths[i], batch[i].path);
+    }
+    if (ok[i]) {
+      bytes += batch[i].contents.size();
+    }
+  }
+
+  // One fsync per appended file covers every append to it in the batch
+  for (const std::string &path : appended) {
+    if (!FileStorage::sync_file(path)) {
+      log_warn("Durable append could not be synced for {}", path);
+      for (size_t i = 0; i < batch.size(); ++i) {
+        if (batch[i].append && batch[i].path == path) {
+          ok[i] = false;
+        }
+      }
+    }
+  }
+
+  for (const std::string &directory : directories) {
+    FileStorage::sync_directory(directory);
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  Metrics &metrics = Metrics::get();
+  for (size_t i = 0; i < batch.size(); ++i) {
+    metrics.file_write_seconds.observe(
+        std::chrono::duration<double>(now - batch[i].queued_at).count());
+    if (!ok[i]) {
+      metrics.file_write_failures.add();
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    totals.batches++;
+    totals.bytes += bytes;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      double latency_ms = std::chrono::duration<double, std::milli>(
+                              now - batch[i].queued_at)
+                              .count();
+      totals.writes++;
+      totals.failures += ok[i] ? 0 : 1;
+      totals.total_latency_ms += latency_ms;
+      totals.max_latency_ms = std::max(totals.max_latency_ms, latency_ms);
+    }
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (batch[i].on_committed) {
+      batch[i].on_committed(ok[i]);
+    }
+    batch[i].done.set_value(ok[i]);
+  }
+}
+} // namespace server
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace server {
+struct DurableWriteStats {
+  uint64_t writes = 0;
+  uint64_t failures = 0;
+  // One batch shares a single round of fsyncs, so writes / batches is the
+  // average group commit size
+  uint64_t batches = 0;
+  uint64_t bytes = 0;
+  uint64_t pending = 0;
+  double total_latency_ms = 0.0;
+  double max_latency_ms = 0.0;
+
+  nlohmann::json to_json() const;
+};
+
+// Group-committing writer for files that must survive a crash. Request
+// threads only serialize and enqueue; a background thread writes each batch
+// to temp files, fsyncs them, renames them into place and fsyncs each
+// directory once, then resolves every write in the batch. Appends skip the
+// temp file and are fsynced once per file per batch.
+struct DurableWriter {
+  DurableWriter();
+  DurableWriter(const DurableWriter &) = delete;
+  DurableWriter &operator=(const DurableWriter &) = delete;
+  ~DurableWriter() { stop(); }
+
+  // The future is true once the file is durable at path. After stop()
+  // writes happen synchronously on the caller.
+  std::future<bool> write(const std::string &path, std::string contents);
+  // Appends to path instead of replacing it. Appends to the same file in
+  // one batch share a single fsync. on_committed, if set, runs on the
+  // commit thread with the outcome, in queue order, before the future
+  // resolves.
+  std::future<bool>
+  append(const std::string &path, std::string contents,
+         std::function<void(bool)> on_committed = {});
+  // Compact JSON; the files are read back by code, not people
+  std::future<bool> write_json(const std::string &path,
+                               const nlohmann::json &data);
+  // Blocks until everything queued so far is on disk
+  void flush();
+  void stop();
+
+  DurableWriteStats stats() const;
+
+private:
+  struct PendingWrite {
+    std::string path;
+    std::string contents;
+    bool append = false;
+    std::promise<bool> done;
+    std::chrono::steady_clock::time_point queued_at;
+    std::function<void(bool)> on_committed;
+  };
+
+  mutable std::mutex mtx;
+  std::condition_variable queue_cv;
+  std::condition_variable idle_cv;
+  std::vector<PendingWrite> queue;
+  bool committing = false;
+  bool stopping = false;
+  DurableWriteStats totals;
+  std::thread thread;
+
+  std::future<bool> enqueue(PendingWrite pending);
+  void commit_loop();
+  void commit(std::vector<PendingWrite> &batch);
+};
+} // namespace server
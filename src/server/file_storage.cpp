@@ -1,9 +1,16 @@
 #include "file_storage.h"
 #include "../log.h"
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <thread>
 
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace server {
 std::vector<std::string>
 FileStorage::list_files_in_directory(const std::string &directory_path,
@@ -87,26 +94,16 @@ std::string FileStorage::load_string_from_file(const std::string &file_path) {
 }
 
 bool FileStorage::save_json_to_file(const std::string &file_path,
-                                    const nlohmann::json &data) {
-  std::filesystem::path path(file_path);
-  if (path.has_parent_path()) {
-    ensure_directory_exists(path.parent_path().string());
-  }
-
-  std::ofstream file(file_path);
-  if (!file.is_open()) {
-    log_error("Failed to open file for writing: {}", file_path);
-    return false;
-  }
-
+                                    const nlohmann::json &data, int indent,
+                                    bool sync) {
+  std::string contents;
   try {
-    file << data.dump(2);
-    file.close();
-    return true;
+    contents = data.dump(indent);
   } catch (const std::exception &e) {
     log_error("Failed to write JSON to file {}: {}", file_path, e.what());
     return false;
   }
+  return save_string_to_file(file_path, contents, sync);
 }
 
 bool FileStorage::save_json_to_file_with_retry(const std::string &file_path,
@@ -130,26 +127,164 @@ bool FileStorage::save_json_to_file_with_retry(const std::string &file_path,
 }
 
 bool FileStorage::save_string_to_file(const std::string &file_path,
-                                      const std::string &data) {
+                                      const std::string &data, bool sync) {
   std::filesystem::path path(file_path);
   if (path.has_parent_path()) {
     ensure_directory_exists(path.parent_path().string());
   }
 
-  std::ofstream file(file_path);
-  if (!file.is_open()) {
+  std::string temp_path = make_temp_path(file_path);
+  if (!write_file(temp_path, data, sync)) {
     log_error("Failed to open file for writing: {}", file_path);
+    std::error_code ec;
+    std::filesystem::remove(temp_path, ec);
     return false;
   }
+  if (!replace_file(temp_path, file_path)) {
+    return false;
+  }
+  if (sync && path.has_parent_path()) {
+    sync_directory(path.parent_path().string());
+  }
+  return true;
+}
 
-  try {
-    file << data;
-    file.close();
-    return true;
-  } catch (const std::exception &e) {
-    log_error("Failed to write string to file {}: {}", file_path, e.what());
+std::string FileStorage::make_temp_path(const std::string &file_path) {
+  static std::atomic<uint64_t> counter{0};
+#ifndef _WIN32
+  long pid = static_cast<long>(getpid());
+#else
+  long pid = 0;
+#endif
+  return file_path + "." + std::to_string(pid) + "." +
+         std::to_string(counter.fetch_add(1)) + ".tmp";
+}
+
+size_t FileStorage::remove_stale_temp_files(const std::string &directory_path) {
+#ifndef _WIN32
+  std::string own_pid = std::to_string(static_cast<long>(getpid()));
+#else
+  std::string own_pid = "0";
+#endif
+  size_t removed = 0;
+  std::error_code ec;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(directory_path, ec)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".tmp") {
+      continue;
+    }
+    // <path>.<pid>.<counter>.tmp, see make_temp_path
+    std::string name = entry.path().stem().string();
+    size_t counter_dot = name.rfind('.');
+    size_t pid_dot = counter_dot == std::string::npos || counter_dot == 0
+                         ? std::string::npos
+                         : name.rfind('.', counter_dot - 1);
+    if (pid_dot != std::string::npos &&
+        name.compare(pid_dot + 1, counter_dot - pid_dot - 1, own_pid) == 0) {
+      continue;
+    }
+    std::error_code remove_ec;
+    if (std::filesystem::remove(entry.path(), remove_ec)) {
+      removed++;
+    }
+  }
+  if (removed > 0) {
+    log_info("Removed {} stale temp files from {}", removed, directory_path);
+  }
+  return removed;
+}
+
+#ifndef _WIN32
+static bool write_fd(int fd, const std::string &data, bool sync) {
+  const char *cursor = data.data();
+  size_t remaining = data.size();
+  while (remaining > 0) {
+    ssize_t written = ::write(fd, cursor, remaining);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      ::close(fd);
+      return false;
+    }
+    cursor += written;
+    remaining -= static_cast<size_t>(written);
+  }
+  bool ok = !sync || ::fsync(fd) == 0;
+  return ::close(fd) == 0 && ok;
+}
+#endif
+
+bool FileStorage::write_file(const std::string &file_path,
+                             const std::string &data, bool sync) {
+#ifndef _WIN32
+  int fd = ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  return fd >= 0 && write_fd(fd, data, sync);
+#else
+  (void)sync;
+  std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    return false;
+  }
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+  file.close();
+  return !file.fail();
+#endif
+}
+
+bool FileStorage::append_file(const std::string &file_path,
+                              const std::string &data, bool sync) {
+#ifndef _WIN32
+  int fd = ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  return fd >= 0 && write_fd(fd, data, sync);
+#else
+  (void)sync;
+  std::ofstream file(file_path, std::ios::binary | std::ios::app);
+  if (!file.is_open()) {
     return false;
   }
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+  file.close();
+  return !file.fail();
+#endif
+}
+
+bool FileStorage::replace_file(const std::string &from,
+                               const std::string &to) {
+  std::error_code ec;
+  std::filesystem::rename(from, to, ec);
+  if (ec) {
+    log_error("Failed to move {} into place at {}: {}", from, to,
+              ec.message());
+    std::filesystem::remove(from, ec);
+    return false;
+  }
+  return true;
+}
+
+bool FileStorage::sync_file(const std::string &file_path) {
+#ifndef _WIN32
+  int fd = ::open(file_path.c_str(), O_WRONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = ::fsync(fd) == 0;
+  return ::close(fd) == 0 && ok;
+#else
+  return file_exists(file_path);
+#endif
+}
+
+void FileStorage::sync_directory(const std::string &directory_path) {
+#ifndef _WIN32
+  int fd = ::open(directory_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  ::fsync(fd);
+  ::close(fd);
+#else
+  (void)directory_path;
+#endif
 }
 
 bool FileStorage::file_exists(const std::string &file_path) {
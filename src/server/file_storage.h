@@ -15,13 +15,29 @@ struct FileStorage {
   load_json_from_file_with_retry(const std::string &file_path,
                                  int max_retries = 3);
   static std::string load_string_from_file(const std::string &file_path);
+  // Writes go to a temp file that is renamed over file_path, so a crash
+  // never leaves a truncated file. indent -1 writes compact JSON; sync
+  // fsyncs the file before the rename.
   static bool save_json_to_file(const std::string &file_path,
-                                const nlohmann::json &data);
+                                const nlohmann::json &data, int indent = 2,
+                                bool sync = false);
   static bool save_json_to_file_with_retry(const std::string &file_path,
                                            const nlohmann::json &data,
                                            int max_retries = 3);
   static bool save_string_to_file(const std::string &file_path,
-                                  const std::string &data);
+                                  const std::string &data, bool sync = false);
+  static std::string make_temp_path(const std::string &file_path);
+  // Removes temp files a crashed process left in directory_path. Temps from
+  // this process may still be in flight and are kept. Returns the count.
+  static size_t remove_stale_temp_files(const std::string &directory_path);
+  static bool write_file(const std::string &file_path, const std::string &data,
+                         bool sync);
+  static bool append_file(const std::string &file_path, const std::string &data,
+                          bool sync);
+  static bool replace_file(const std::string &from, const std::string &to);
+  static bool sync_file(const std::string &file_path);
+  // Makes completed renames in a directory durable
+  static void sync_directory(const std::string &directory_path);
   static bool file_exists(const std::string &file_path);
   static bool directory_exists(const std::string &directory_path);
   static void ensure_directory_exists(const std::string &directory_path);
@@ -0,0 +1,361 @@
+#include "game_state_store.h"
+#include "../log.h"
+#include "../utils/game_state_checksum.h"
+#include "file_storage.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace server {
+namespace {
+int64_t now_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Top-level member a JSON pointer points into, nullopt for the whole document
+std::optional<std::string> top_level_key(const std::string &pointer) {
+  if (pointer.empty() || pointer[0] != '/') {
+    return std::nullopt;
+  }
+  size_t end = pointer.find('/', 1);
+  std::string token = pointer.substr(
+      1, end == std::string::npos ? std::string::npos : end - 1);
+  std::string key;
+  for (size_t i = 0; i < token.size(); ++i) {
+    if (token[i] == '~' && i + 1 < token.size()) {
+      key += token[i + 1] == '1' ? '/' : '~';
+      ++i;
+    } else {
+      key += token[i];
+    }
+  }
+  return key;
+}
+} // namespace
+
+std::string GameStateStore::file_stem(const std::string &user_id) {
+  std::string stem = "game_state_";
+  for (unsigned char c : user_id) {
+    if (std::isalnum(c) || c == '-' || c == '_') {
+      stem += static_cast<char>(c);
+    } else {
+      char escaped[4];
+      std::snprintf(escaped, sizeof(escaped), "%%%02x", c);
+      stem += escaped;
+    }
+  }
+  return stem;
+}
+
+std::filesystem::path
+GameStateStore::snapshot_path(const std::string &user_id) const {
+  return directory / (file_stem(user_id) + ".snapshot.json");
+}
+
+std::filesystem::path
+GameStateStore::delta_log_path(const std::string &user_id) const {
+  return directory / (file_stem(user_id) + ".deltas.log");
+}
+
+void GameStateStore::open(const std::filesystem::path &dir,
+                          size_t snapshot_interval) {
+  std::lock_guard<std::mutex> lock(mtx);
+  directory = dir;
+  snapshot_every = std::max<size_t>(snapshot_interval, 1);
+  slots.clear();
+
+  FileStorage::ensure_directory_exists(directory.string());
+  FileStorage::remove_stale_temp_files(directory.string());
+
+  const std::string suffix = ".snapshot.json";
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    std::string name = entry.path().filename().string();
+    if (entry.is_regular_file() && name.size() > suffix.size() &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) ==
+            0) {
+      try {
+        load_user(entry.path());
+      } catch (const std::exception &e) {
+        log_warn("Failed to load game state {}: {}", name, e.what());
+      }
+    }
+  }
+
+  log_info("Game state store opened with {} users", slots.size());
+}
+
+void GameStateStore::load_user(const std::filesystem::path &path) {
+  nlohmann::json snapshot = FileStorage::load_json_from_file(path.string());
+  if (!snapshot.is_object() || !snapshot.contains("userId") ||
+      !snapshot.contains("state") || !snapshot["state"].is_object()) {
+    log_warn("Skipping unreadable game state snapshot {}", path.string());
+    return;
+  }
+
+  std::string user_id = snapshot["userId"].get<std::string>();
+  Slot slot;
+  slot.entry.state = std::move(snapshot["state"]);
+  slot.entry.version = snapshot.value("version", static_cast<uint64_t>(0));
+  slot.entry.saved_at_ms = snapshot.value("savedAt", static_cast<int64_t>(0));
+  rehash_all(slot);
+
+  std::ifstream file(delta_log_path(user_id), std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+
+  // Deltas at or below the snapshot version were folded in before a crash
+  // could truncate the log. Replay stops at the first torn, out of order or
+  // inconsistent line.
+  bool clean = true;
+  size_t offset = 0;
+  while (offset < contents.size()) {
+    size_t end = contents.find('\n', offset);
+    if (end == std::string::npos) {
+      clean = false;
+      break;
+    }
+    nlohmann::json line = nlohmann::json::parse(
+        contents.begin() + static_cast<long>(offset),
+        contents.begin() + static_cast<long>(end), nullptr, false);
+    offset = end + 1;
+
+    uint64_t version =
+        line.is_object() ? line.value("version", static_cast<uint64_t>(0)) : 0;
+    if (version != 0 && version <= slot.entry.version) {
+      continue;
+    }
+    std::string error;
+    if (version != slot.entry.version + 1 || !line.contains("patch") ||
+        !apply_patch(slot, line["patch"], error) ||
+        slot.entry.checksum != line.value("checksum", std::string(""))) {
+      clean = false;
+      break;
+    }
+    slot.entry.version = version;
+    slot.entry.saved_at_ms = line.value("savedAt", slot.entry.saved_at_ms);
+    slot.deltas_since_snapshot++;
+  }
+
+  auto [it, inserted] = slots.insert_or_assign(user_id, std::move(slot));
+  // Later appends would land behind the bad line and never replay, so fold
+  // what was recovered into a fresh snapshot
+  if (!clean) {
+    log_warn("Game state log for {} is damaged, recovered version {}",
+             user_id, it->second.entry.version);
+    write_snapshot(user_id, it->second);
+  }
+}
+
+void GameStateStore::rehash_all(Slot &slot) {
+  slot.member_hashes.clear();
+  slot.hash = 0;
+  for (auto it = slot.entry.state.begin(); it != slot.entry.state.end();
+       ++it) {
+    if (it.key() == "checksum") {
+      continue;
+    }
+    uint64_t hash = GameStateChecksum::member_hash(it.key(), it.value());
+    slot.member_hashes[it.key()] = hash;
+    slot.hash += hash;
+  }
+  slot.entry.checksum = GameStateChecksum::to_hex(slot.hash);
+}
+
+bool GameStateStore::apply_patch(Slot &slot, const nlohmann::json &patch,
+                                 std::string &error) {
+  if (!patch.is_array()) {
+    error = "Patch must be an array of operations";
+    return false;
+  }
+
+  // Members the patch may modify, with their old values so a failed patch
+  // can be rolled back without copying the whole state
+  bool whole = false;
+  std::unordered_map<std::string, std::optional<nlohmann::json>> touched;
+  for (const auto &op : patch) {
+    if (!op.is_object() || !op.contains("op") || !op["op"].is_string() ||
+        !op.contains("path") || !op["path"].is_string()) {
+      error = "Patch operations need op and path";
+      return false;
+    }
+    std::string name = op["op"].get<std::string>();
+    if (name == "test") {
+      continue;
+    }
+    std::vector<std::string> pointers{op["path"].get<std::string>()};
+    if (name == "move" && op.contains("from") && op["from"].is_string()) {
+      pointers.push_back(op["from"].get<std::string>());
+    }
+    for (const std::string &pointer : pointers) {
+      std::optional<std::string> key = top_level_key(pointer);
+      if (!key) {
+        whole = true;
+      } else if (!touched.contains(*key)) {
+        auto member = slot.entry.state.find(*key);
+        touched[*key] = member == slot.entry.state.end()
+                            ? std::nullopt
+                            : std::optional<nlohmann::json>(*member);
+      }
+    }
+  }
+
+  nlohmann::json backup;
+  if (whole) {
+    backup = slot.entry.state;
+  }
+
+  try {
+    slot.entry.state.patch_inplace(patch);
+    if (!slot.entry.state.is_object()) {
+      error = "Patch must leave the game state an object";
+    }
+  } catch (const nlohmann::json::exception &e) {
+    error = e.what();
+  }
+
+  if (!error.empty()) {
+    if (whole) {
+      slot.entry.state = std::move(backup);
+    } else {
+      for (auto &[key, value] : touched) {
+        if (value) {
+          slot.entry.state[key] = std::move(*value);
+        } else {
+          slot.entry.state.erase(key);
+        }
+      }
+    }
+    return false;
+  }
+
+  if (whole) {
+    rehash_all(slot);
+    return true;
+  }
+
+  for (const auto &[key, value] : touched) {
+    if (key == "checksum") {
+      continue;
+    }
+    auto old_hash = slot.member_hashes.find(key);
+    if (old_hash != slot.member_hashes.end()) {
+      slot.hash -= old_hash->second;
+      slot.member_hashes.erase(old_hash);
+    }
+    auto member = slot.entry.state.find(key);
+    if (member != slot.entry.state.end()) {
+      uint64_t hash = GameStateChecksum::member_hash(key, *member);
+      slot.member_hashes[key] = hash;
+      slot.hash += hash;
+    }
+  }
+  slot.entry.checksum = GameStateChecksum::to_hex(slot.hash);
+  return true;
+}
+
+void GameStateStore::write_snapshot(const std::string &user_id, Slot &slot) {
+  slot.deltas_since_snapshot = 0;
+  if (directory.empty()) {
+    return;
+  }
+  nlohmann::json snapshot{{"userId", user_id},
+                          {"version", slot.entry.version},
+                          {"checksum", slot.entry.checksum},
+                          {"savedAt", slot.entry.saved_at_ms},
+                          {"state", slot.entry.state}};
+  // The writer applies these in order, so deltas queued afterwards land in
+  // the emptied log
+  writer.write_json(snapshot_path(user_id).string(), snapshot);
+  writer.write(delta_log_path(user_id).string(), "");
+}
+
+GameStateStore::SaveResult
+GameStateStore::save_full(const std::string &user_id, nlohmann::json state) {
+  SaveResult result;
+  if (!state.is_object()) {
+    result.status = Status::InvalidPatch;
+    result.error = "Game state must be an object";
+    return result;
+  }
+  state.erase("checksum");
+
+  std::lock_guard<std::mutex> lock(mtx);
+  Slot &slot = slots[user_id];
+  slot.entry.state = std::move(state);
+  slot.entry.version++;
+  slot.entry.saved_at_ms = now_ms();
+  rehash_all(slot);
+  write_snapshot(user_id, slot);
+
+  result.status = Status::Saved;
+  result.checksum = slot.entry.checksum;
+  result.version = slot.entry.version;
+  return result;
+}
+
+GameStateStore::SaveResult
+GameStateStore::apply_delta(const std::string &user_id,
+                            const std::string &base_checksum,
+                            const nlohmann::json &patch) {
+  SaveResult result;
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = slots.find(user_id);
+  if (it == slots.end()) {
+    result.status = Status::NotFound;
+    return result;
+  }
+
+  Slot &slot = it->second;
+  result.checksum = slot.entry.checksum;
+  result.version = slot.entry.version;
+  if (slot.entry.checksum != base_checksum) {
+    result.status = Status::BaseMismatch;
+    return result;
+  }
+  if (!apply_patch(slot, patch, result.error)) {
+    result.status = Status::InvalidPatch;
+    return result;
+  }
+
+  slot.entry.version++;
+  slot.entry.saved_at_ms = now_ms();
+  result.status = Status::Saved;
+  result.checksum = slot.entry.checksum;
+  result.version = slot.entry.version;
+
+  if (directory.empty()) {
+    return result;
+  }
+  if (++slot.deltas_since_snapshot >= snapshot_every) {
+    write_snapshot(user_id, slot);
+    return result;
+  }
+  nlohmann::json line{{"version", slot.entry.version},
+                      {"checksum", slot.entry.checksum},
+                      {"savedAt", slot.entry.saved_at_ms},
+                      {"patch", patch}};
+  writer.append(delta_log_path(user_id).string(), line.dump() + "\n");
+  return result;
+}
+
+std::optional<GameStateStore::Entry>
+GameStateStore::get(const std::string &user_id) const {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = slots.find(user_id);
+  if (it == slots.end()) {
+    return std::nullopt;
+  }
+  return it->second.entry;
+}
+
+size_t GameStateStore::size() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return slots.size();
+}
+} // namespace server
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "durable_writer.h"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace server {
+// Saved game states keyed by user id, held in memory and persisted as a
+// snapshot per user (<stem>.snapshot.json) plus a log of the JSON Patch
+// deltas applied since (<stem>.deltas.log). A delta is only accepted against
+// the checksum the server currently holds, and only the top-level members it
+// touches are rehashed, so a save costs about as much as the change.
+struct GameStateStore {
+  enum struct Status { Saved, BaseMismatch, NotFound, InvalidPatch };
+
+  struct Entry {
+    nlohmann::json state;
+    std::string checksum;
+    uint64_t version = 0;
+    int64_t saved_at_ms = 0;
+  };
+
+  struct SaveResult {
+    Status status = Status::NotFound;
+    // The stored checksum and version after the call, also on rejection
+    std::string checksum;
+    uint64_t version = 0;
+    std::string error;
+  };
+
+  explicit GameStateStore(DurableWriter &writer) : writer(writer) {}
+  GameStateStore(const GameStateStore &) = delete;
+  GameStateStore &operator=(const GameStateStore &) = delete;
+
+  // Loads every snapshot in directory and replays its delta log. A new
+  // snapshot is written after every snapshot_every deltas.
+  void open(const std::filesystem::path &directory, size_t snapshot_every);
+
+  SaveResult save_full(const std::string &user_id, nlohmann::json state);
+  // patch is an RFC 6902 JSON Patch against the state whose checksum is
+  // base_checksum
+  SaveResult apply_delta(const std::string &user_id,
+                         const std::string &base_checksum,
+                         const nlohmann::json &patch);
+
+  std::optional<Entry> get(const std::string &user_id) const;
+  size_t size() const;
+
+  // Filesystem-safe file name prefix for a user id
+  static std::string file_stem(const std::string &user_id);
+
+private:
+  struct Slot {
+    Entry entry;
+    std::unordered_map<std::string, uint64_t> member_hashes;
+    uint64_t hash = 0;
+    size_t deltas_since_snapshot = 0;
+  };
+
+  DurableWriter &writer;
+  std::filesystem::path directory;
+  size_t snapshot_every = 20;
+
+  mutable std::mutex mtx;
+  std::unordered_map<std::string, Slot> slots;
+
+  static void rehash_all(Slot &slot);
+  static bool apply_patch(Slot &slot, const nlohmann::json &patch,
+                          std::string &error);
+  void load_user(const std::filesystem::path &snapshot_path);
+  void write_snapshot(const std::string &user_id, Slot &slot);
+  std::filesystem::path snapshot_path(const std::string &user_id) const;
+  std::filesystem::path delta_log_path(const std::string &user_id) const;
+};
+} // namespace server
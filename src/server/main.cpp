@@ -3,6 +3,7 @@
 #include "../render_backend.h"
 #include "../rl.h"
 #include "../shop.h"
+#include "../utils/system_profiler.h"
 #include "battle_api.h"
 #include "file_storage.h"
 #include "server_config.h"
@@ -10,6 +11,7 @@
 #include "test_framework.h"
 #include <afterhours/ah.h>
 #include <argh.h>
+#include <cstdlib>
 #include <filesystem>
 #include <nlohmann/json.hpp>
 
@@ -72,6 +74,20 @@ int main(int argc, char *argv[]) {
     log_info("No config file specified, using defaults");
   }
 
+  if (!log_configure_categories(config.log_levels)) {
+    log_warn("Invalid log_levels: {}", config.log_levels);
+  }
+  // The environment overrides the config file
+  if (const char *env = std::getenv("AFTER_HOURS_LOG_CATEGORIES")) {
+    log_configure_categories(env);
+  }
+
+  // Battle worlds fork after this, so they inherit the setting
+  if (config.profile_systems) {
+    SystemProfiler::get().set_enabled(true);
+    log_info("System profiling enabled, see /profile");
+  }
+
   std::filesystem::path opponents_path = config.get_opponents_path();
   std::filesystem::create_directories(opponents_path);
   server::TeamManager::track_opponent_file_count(opponents_path);
@@ -0,0 +1,187 @@
+#include "metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace server {
+namespace {
+const std::vector<double> kLatencyBuckets = {
+    0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1,
+    0.25,  0.5,    1.0,   2.5,  5.0,   10.0, 30.0};
+const std::vector<double> kByteBuckets = {256,    1024,    4096,   16384,
+                                          65536,  262144,  1048576,
+                                          4194304};
+const std::vector<double> kTickBuckets = {60,    300,   600,    1200,  3000,
+                                          6000,  12000, 30000,  60000,
+                                          120000};
+const std::vector<double> kTickSecondsBuckets = {
+    0.000001, 0.000005, 0.00001, 0.00005, 0.0001,
+    0.0005,   0.001,    0.005,   0.01,    0.05};
+
+template <size_t... I>
+std::array<MetricHistogram, sizeof...(I)>
+make_histograms(const std::vector<double> &bounds, std::index_sequence<I...>) {
+  return {{((void)I, MetricHistogram(bounds))...}};
+}
+
+std::string format_value(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+  return buffer;
+}
+
+void render_header(std::string &out, const std::string &name,
+                   const char *type, const char *help) {
+  out += "# HELP " + name + " " + help + "\n";
+  out += "# TYPE " + name + " " + type + "\n";
+}
+
+void render_counter(std::string &out, const std::string &name,
+                    const char *help, const MetricCounter &counter) {
+  render_header(out, name, "counter", help);
+  out += name + " " + std::to_string(counter.get()) + "\n";
+}
+
+void render_histogram(std::string &out, const std::string &name,
+                      const char *help, const MetricHistogram &histogram) {
+  render_header(out, name, "histogram", help);
+  histogram.render(out, name);
+}
+} // namespace
+
+MetricHistogram::MetricHistogram(std::vector<double> upper_bounds)
+    : bounds(std::move(upper_bounds)), buckets(bounds.size() + 1) {}
+
+void MetricHistogram::observe(double value) {
+  size_t index = static_cast<size_t>(
+      std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin());
+  buckets[index].fetch_add(1, std::memory_order_relaxed);
+  total.fetch_add(1, std::memory_order_relaxed);
+  total_sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+void MetricHistogram::render(std::string &out, const std::string &name,
+                             const std::string &labels) const {
+  std::string prefix = labels.empty() ? "" : labels + ",";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    cumulative += buckets[i].load(std::memory_order_relaxed);
+    std::string le = i < bounds.size() ? format_value(bounds[i]) : "+Inf";
+    out += name + "_bucket{" + prefix + "le=\"" + le + "\"} " +
+           std::to_string(cumulative) + "\n";
+  }
+  std::string suffix = labels.empty() ? "" : "{" + labels + "}";
+  out += name + "_sum" + suffix + " " + format_value(sum()) + "\n";
+  // Buckets and the count are read separately, so report the bucket total
+  // to keep the series consistent with each other
+  out += name + "_count" + suffix + " " + std::to_string(cumulative) + "\n";
+}
+
+Metrics::Metrics()
+    : request_seconds(make_histograms(kLatencyBuckets,
+                                      std::make_index_sequence<kRouteCount>())),
+      response_bytes(make_histograms(kByteBuckets,
+                                     std::make_index_sequence<kRouteCount>())),
+      battle_ticks(kTickBuckets), systems_seconds_per_tick(kTickSecondsBuckets),
+      file_write_seconds(kLatencyBuckets) {}
+
+Metrics &Metrics::get() {
+  static Metrics instance;
+  return instance;
+}
+
+const char *Metrics::route_path(Route route) {
+  switch (route) {
+  case Route::Battle:
+    return "/battle";
+  case Route::BattleBatch:
+    return "/battle/batch";
+  case Route::SaveGameState:
+    return "/save-game-state";
+  case Route::GameState:
+    return "/game-state";
+  case Route::Results:
+    return "/results";
+  case Route::Health:
+    return "/health";
+  case Route::Metrics:
+    return "/metrics";
+  case Route::Profile:
+    return "/profile";
+  case Route::Count:
+    break;
+  }
+  return "unknown";
+}
+
+void Metrics::observe_request(Route route, int status, double seconds,
+                              size_t bytes) {
+  size_t index = static_cast<size_t>(route);
+  size_t status_class = static_cast<size_t>(
+      std::clamp(status / 100, 1, static_cast<int>(kStatusClasses)) - 1);
+  requests[index][status_class].add();
+  request_seconds[index].observe(seconds);
+  response_bytes[index].observe(static_cast<double>(bytes));
+}
+
+std::string
+Metrics::render(const std::vector<MetricGaugeSample> &gauges) const {
+  std::string out;
+  out.reserve(16384);
+
+  render_header(out, "battle_server_requests_total", "counter",
+                "HTTP requests by route and status class.");
+  for (size_t route = 0; route < kRouteCount; ++route) {
+    for (size_t status = 0; status < kStatusClasses; ++status) {
+      uint64_t value = requests[route][status].get();
+      if (value == 0) {
+        continue;
+      }
+      out += "battle_server_requests_total{route=\"";
+      out += route_path(static_cast<Route>(route));
+      out += "\",code=\"" + std::to_string(status + 1) + "xx\"} " +
+             std::to_string(value) + "\n";
+    }
+  }
+
+  render_header(out, "battle_server_request_seconds", "histogram",
+                "HTTP request latency by route.");
+  for (size_t route = 0; route < kRouteCount; ++route) {
+    request_seconds[route].render(
+        out, "battle_server_request_seconds",
+        std::string("route=\"") + route_path(static_cast<Route>(route)) +
+            "\"");
+  }
+
+  render_header(out, "battle_server_response_bytes", "histogram",
+                "Serialized response body size by route.");
+  for (size_t route = 0; route < kRouteCount; ++route) {
+    response_bytes[route].render(
+        out, "battle_server_response_bytes",
+        std::string("route=\"") + route_path(static_cast<Route>(route)) +
+            "\"");
+  }
+
+  render_histogram(out, "battle_server_battle_ticks",
+                   "Simulation ticks per completed battle.", battle_ticks);
+  render_histogram(out, "battle_server_systems_seconds_per_tick",
+                   "Mean time spent running systems per simulated tick.",
+                   systems_seconds_per_tick);
+  render_counter(out, "battle_server_battle_timeouts_total",
+                 "Battles that hit the iteration or time limit.",
+                 battle_timeouts);
+  render_counter(out, "battle_server_battle_errors_total",
+                 "Battles that failed with an error.", battle_errors);
+  render_histogram(out, "battle_server_file_write_seconds",
+                   "Time from queueing a durable write to its commit.",
+                   file_write_seconds);
+  render_counter(out, "battle_server_file_write_failures_total",
+                 "Durable writes that failed.", file_write_failures);
+
+  for (const MetricGaugeSample &gauge : gauges) {
+    render_header(out, gauge.name, "gauge", gauge.help.c_str());
+    out += gauge.name + " " + format_value(gauge.value) + "\n";
+  }
+  return out;
+}
+} // namespace server
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace server {
+struct MetricCounter {
+  std::atomic<uint64_t> value{0};
+
+  void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+  uint64_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+// Fixed buckets chosen up front, so observe() is a search over a handful of
+// bounds and three relaxed atomic adds
+struct MetricHistogram {
+  explicit MetricHistogram(std::vector<double> upper_bounds);
+
+  void observe(double value);
+  uint64_t count() const { return total.load(std::memory_order_relaxed); }
+  double sum() const { return total_sum.load(std::memory_order_relaxed); }
+
+  // Appends the _bucket, _sum and _count lines; labels are inserted as-is
+  void render(std::string &out, const std::string &name,
+              const std::string &labels = "") const;
+
+private:
+  std::vector<double> bounds;
+  // One slot per bound plus +Inf, not cumulative
+  std::vector<std::atomic<uint64_t>> buckets;
+  std::atomic<uint64_t> total{0};
+  std::atomic<double> total_sum{0.0};
+};
+
+// Values read from their owners when /metrics is scraped
+struct MetricGaugeSample {
+  std::string name;
+  std::string help;
+  double value = 0.0;
+};
+
+// Process-wide battle server metrics in the Prometheus text format. Hot
+// paths only touch atomics; nothing is locked or allocated per observation.
+struct Metrics {
+  enum struct Route {
+    Battle,
+    BattleBatch,
+    SaveGameState,
+    GameState,
+    Results,
+    Health,
+    Metrics,
+    Profile,
+    Count
+  };
+  static constexpr size_t kRouteCount = static_cast<size_t>(Route::Count);
+  // 1xx through 5xx
+  static constexpr size_t kStatusClasses = 5;
+
+  static Metrics &get();
+  static const char *route_path(Route route);
+
+  void observe_request(Route route, int status, double seconds,
+                       size_t response_bytes);
+
+  std::array<std::array<MetricCounter, kStatusClasses>, kRouteCount>
+      requests;
+  std::array<MetricHistogram, kRouteCount> request_seconds;
+  std::array<MetricHistogram, kRouteCount> response_bytes;
+
+  MetricHistogram battle_ticks;
+  MetricHistogram systems_seconds_per_tick;
+  MetricCounter battle_timeouts;
+  MetricCounter battle_errors;
+  MetricHistogram file_write_seconds;
+  MetricCounter file_write_failures;
+
+  std::string render(const std::vector<MetricGaugeSample> &gauges) const;
+
+private:
+  Metrics();
+};
+} // namespace server
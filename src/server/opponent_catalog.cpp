@@ -0,0 +1,152 @@
+#include "opponent_catalog.h"
+#include "../log.h"
+#include "file_storage.h"
+#include "team_manager.h"
+#include <algorithm>
+
+namespace server {
+bool OpponentCatalog::refresh(const std::filesystem::path &opponents_path,
+                              int max_team_size) {
+  std::lock_guard<std::mutex> lock(refresh_mtx);
+
+  std::unordered_map<TeamFilePath, std::shared_ptr<const OpponentEntry>>
+      next;
+  std::unordered_map<TeamFilePath, std::filesystem::file_time_type>
+      next_rejected;
+  bool changed = false;
+
+  for (const TeamFilePath &path :
+       FileStorage::list_files_in_directory(opponents_path.string(), ".json")) {
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+      continue;
+    }
+
+    auto existing = by_path.find(path);
+    if (existing != by_path.end() && existing->second->modified == modified) {
+      next.emplace(path, existing->second);
+      continue;
+    }
+    auto known_bad = rejected.find(path);
+    if (known_bad != rejected.end() && known_bad->second == modified) {
+      next_rejected.emplace(path, modified);
+      continue;
+    }
+
+    changed = true;
+    if (!TeamManager::is_path_safe(path, opponents_path)) {
+      log_warn("Skipping opponent file outside opponents directory: {}", path);
+      next_rejected.emplace(path, modified);
+      continue;
+    }
+
+    nlohmann::json team = TeamManager::load_team_from_file(path);
+    if (team.empty() || !TeamManager::validate_team_json(team, max_team_size)) {
+      log_warn("Skipping invalid opponent file: {}", path);
+      next_rejected.emplace(path, modified);
+      continue;
+    }
+
+    auto entry = std::make_shared<OpponentEntry>();
+    entry->id = extract_team_id_from_path(path);
+    entry->path = path;
+    entry->team = std::move(team);
+    entry->modified = modified;
+    next.emplace(path, std::move(entry));
+  }
+
+  if (next.size() != by_path.size()) {
+    changed = true;
+  }
+  rejected = std::move(next_rejected);
+  if (!changed) {
+    return false;
+  }
+
+  by_path = std::move(next);
+
+  auto fresh = std::make_shared<Snapshot>();
+  fresh->teams.reserve(by_path.size());
+  for (const auto &[path, entry] : by_path) {
+    fresh->teams.push_back(entry);
+    fresh->by_id[entry->id] = entry;
+  }
+  std::sort(fresh->teams.begin(), fresh->teams.end(),
+            [](const auto &a, const auto &b) { return a->path < b->path; });
+
+  {
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mtx);
+    snapshot = std::move(fresh);
+  }
+
+  log_info("Opponent catalog loaded {} teams from {}", by_path.size(),
+           opponents_path.string());
+  return true;
+}
+
+void OpponentCatalog::start_watching(
+    const std::filesystem::path &opponents_path, std::chrono::seconds interval,
+    int max_team_size) {
+  stop_watching();
+
+  {
+    std::lock_guard<std::mutex> lock(watcher_mtx);
+    watching = true;
+  }
+
+  watcher = std::thread([this, opponents_path, interval, max_team_size]() {
+    std::unique_lock<std::mutex> lock(watcher_mtx);
+    while (!watcher_cv.wait_for(lock, interval, [this] { return !watching; })) {
+      lock.unlock();
+      try {
+        refresh(opponents_path, max_team_size);
+      } catch (const std::exception &e) {
+        log_warn("Opponent catalog rescan failed: {}", e.what());
+      }
+      lock.lock();
+    }
+  });
+}
+
+void OpponentCatalog::stop_watching() {
+  {
+    std::lock_guard<std::mutex> lock(watcher_mtx);
+    watching = false;
+  }
+  watcher_cv.notify_all();
+  if (watcher.joinable()) {
+    watcher.join();
+  }
+}
+
+std::shared_ptr<const OpponentCatalog::Snapshot>
+OpponentCatalog::current() const {
+  std::lock_guard<std::mutex> lock(snapshot_mtx);
+  return snapshot;
+}
+
+std::shared_ptr<const OpponentEntry>
+OpponentCatalog::pick_random() const {
+  std::shared_ptr<const Snapshot> snap = current();
+  if (snap->teams.empty()) {
+    return nullptr;
+  }
+  std::uniform_int_distribution<size_t> dis(0, snap->teams.size() - 1);
+  std::lock_guard<std::mutex> lock(pick_mtx);
+  return snap->teams[dis(pick_rng)];
+}
+
+std::shared_ptr<const OpponentEntry>
+OpponentCatalog::find(const TeamId &id) const {
+  std::shared_ptr<const Snapshot> snap = current();
+  auto it = snap->by_id.find(id);
+  return it == snap->by_id.end() ? nullptr : it->second;
+}
+
+std::vector<std::shared_ptr<const OpponentEntry>> OpponentCatalog::all() const {
+  return current()->teams;
+}
+
+size_t OpponentCatalog::size() const { return current()->teams.size(); }
+} // namespace server
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "team_types.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+struct OpponentEntry {
+  TeamId id;
+  TeamFilePath path;
+  nlohmann::json team;
+  std::filesystem::file_time_type modified;
+};
+
+// Pre-validated, pre-parsed opponent teams. The opponents directory is read
+// at startup and rescanned on a background thread; only files whose
+// modification time changed are re-parsed. Picking an opponent touches no
+// files.
+struct OpponentCatalog {
+  struct Snapshot {
+    std::vector<std::shared_ptr<const OpponentEntry>> teams;
+    std::unordered_map<TeamId, std::shared_ptr<const OpponentEntry>> by_id;
+  };
+
+  OpponentCatalog() = default;
+  OpponentCatalog(const OpponentCatalog &) = delete;
+  OpponentCatalog &operator=(const OpponentCatalog &) = delete;
+  ~OpponentCatalog() { stop_watching(); }
+
+  // Returns true if the set of opponents changed
+  bool refresh(const std::filesystem::path &opponents_path,
+               int max_team_size = 7);
+  void start_watching(const std::filesystem::path &opponents_path,
+                      std::chrono::seconds interval, int max_team_size = 7);
+  void stop_watching();
+
+  // Draws from the catalog's own engine, never SeededRng, so picking an
+  // opponent can't disturb a battle simulating on another thread
+  std::shared_ptr<const OpponentEntry> pick_random() const;
+  std::shared_ptr<const OpponentEntry> find(const TeamId &id) const;
+  std::vector<std::shared_ptr<const OpponentEntry>> all() const;
+  size_t size() const;
+
+private:
+  mutable std::mutex snapshot_mtx;
+  std::shared_ptr<const Snapshot> snapshot = std::make_shared<Snapshot>();
+
+  mutable std::mutex pick_mtx;
+  mutable std::mt19937_64 pick_rng{std::random_device{}()};
+
+  // Only touched by refresh(), which is serialized by refresh_mtx
+  std::mutex refresh_mtx;
+  std::unordered_map<TeamFilePath, std::shared_ptr<const OpponentEntry>>
+      by_path;
+  std::unordered_map<TeamFilePath, std::filesystem::file_time_type> rejected;
+
+  std::thread watcher;
+  std::mutex watcher_mtx;
+  std::condition_variable watcher_cv;
+  bool watching = false;
+
+  std::shared_ptr<const Snapshot> current() const;
+};
+} // namespace server
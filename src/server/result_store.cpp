@@ -0,0 +1,405 @@
+#include "result_store.h"
+#include "../log.h"
+#include "file_storage.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace server {
+std::string ResultStore::segment_name(uint64_t segment) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "results-%06llu.log",
+                static_cast<unsigned long long>(segment));
+  return name;
+}
+
+void ResultStore::open(const std::filesystem::path &dir,
+                       ResultRetention retention) {
+  // Appends queued against the previous directory finish first
+  writer.flush();
+  std::lock_guard<std::mutex> lock(mtx);
+  directory = dir;
+  policy = retention;
+  records.clear();
+  first_sequence = 0;
+  by_battle.clear();
+  by_player_team.clear();
+  active_segment = 1;
+  active_bytes = 0;
+  last_saved_at_ms = 0;
+  pending_by_segment.clear();
+
+  FileStorage::ensure_directory_exists(directory.string());
+  FileStorage::remove_stale_temp_files(directory.string());
+
+  std::vector<uint64_t> segments;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    unsigned long long number = 0;
+    std::string name = entry.path().filename().string();
+    if (entry.is_regular_file() &&
+        std::sscanf(name.c_str(), "results-%llu.log", &number) == 1 &&
+        name == segment_name(number)) {
+      segments.push_back(number);
+    }
+  }
+  std::sort(segments.begin(), segments.end());
+
+  bool torn_tail = false;
+  for (uint64_t segment : segments) {
+    std::ifstream file(directory / segment_name(segment), std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+    size_t offset = 0;
+    while (offset < contents.size()) {
+      size_t end = contents.find('\n', offset);
+      if (end == std::string::npos) {
+        torn_tail = true;
+        break;
+      }
+      nlohmann::json line = nlohmann::json::parse(
+          contents.begin() + static_cast<long>(offset),
+          contents.begin() + static_cast<long>(end), nullptr, false);
+      if (line.is_object()) {
+        index(Record{line.value("battleId", std::string("")),
+                     line.value("playerTeamId", std::string("")),
+                     line.value("savedAt", static_cast<int64_t>(0)), segment,
+                     offset, end + 1 - offset});
+        last_saved_at_ms =
+            std::max(last_saved_at_ms, records.back().saved_at_ms);
+      }
+      offset = end + 1;
+    }
+
+    active_segment = segment;
+    active_bytes = contents.size();
+  }
+
+  // A crash mid-append leaves a partial last line; start a fresh segment
+  // rather than appending after it
+  if (torn_tail) {
+    log_warn("Result segment {} ends in a partial record",
+             segment_name(active_segment));
+    active_segment++;
+    active_bytes = 0;
+  }
+
+  log_info("Result store opened with {} results in {} segments",
+           records.size(), segments.size());
+}
+
+std::future<bool> ResultStore::append(const std::string &battle_id,
+                                      nlohmann::json result) {
+  std::lock_guard<std::mutex> append_lock(append_mtx);
+  Record record;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (directory.empty()) {
+      log_warn("Result store is not open, dropping result {}", battle_id);
+      std::promise<bool> dropped;
+      dropped.set_value(false);
+      return dropped.get_future();
+    }
+    // Stamped under the lock, and never behind the previous result, so
+    // records stay in savedAt order for since()
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    last_saved_at_ms = std::max(last_saved_at_ms, now);
+    record.battle_id = battle_id;
+    record.player_team_id = result.value("playerTeamId", std::string(""));
+    record.saved_at_ms = last_saved_at_ms;
+  }
+
+  result["battleId"] = battle_id;
+  result["savedAt"] = record.saved_at_ms;
+  std::string line = result.dump() + "\n";
+  record.length = line.size();
+
+  std::string path;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (active_bytes > 0 &&
+        active_bytes + line.size() > policy.segment_bytes) {
+      active_segment++;
+      active_bytes = 0;
+    }
+    record.segment = active_segment;
+    record.offset = active_bytes;
+    active_bytes += line.size();
+    pending_by_segment[active_segment]++;
+    path = (directory / segment_name(active_segment)).string();
+  }
+
+  // Queued under append_mtx so the writer appends in offset order
+  return writer.append(path, std::move(line),
+                       [this, record](bool ok) { committed(record, ok); });
+}
+
+void ResultStore::committed(const Record &record, bool ok) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto pending = pending_by_segment.find(record.segment);
+  if (pending != pending_by_segment.end() && --pending->second == 0) {
+    pending_by_segment.erase(pending);
+  }
+  if (ok) {
+    index(record);
+    return;
+  }
+
+  // A failed append may have left a partial line behind, so nothing more
+  // goes after it; appends already queued there are found by resync()
+  log_warn("Result {} was not saved", record.battle_id);
+  if (record.segment == active_segment) {
+    active_segment++;
+    active_bytes = 0;
+  }
+}
+
+void ResultStore::flush_uncommitted() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (pending_by_segment.empty()) {
+      return;
+    }
+  }
+  writer.flush();
+}
+
+void ResultStore::index(Record record) {
+  uint64_t sequence = first_sequence + records.size();
+  if (!record.battle_id.empty()) {
+    by_battle[record.battle_id] = sequence;
+  }
+  if (!record.player_team_id.empty()) {
+    by_player_team[record.player_team_id].push_back(sequence);
+  }
+  records.push_back(std::move(record));
+}
+
+const ResultStore::Record *ResultStore::record_at(uint64_t sequence) const {
+  if (sequence < first_sequence ||
+      sequence >= first_sequence + records.size()) {
+    return nullptr;
+  }
+  return &records[sequence - first_sequence];
+}
+
+static bool is_record(const nlohmann::json &result,
+                      const ResultStore::Record &record) {
+  return result.is_object() &&
+         result.value("battleId", std::string("")) == record.battle_id &&
+         result.value("savedAt", static_cast<int64_t>(0)) ==
+             record.saved_at_ms;
+}
+
+std::optional<nlohmann::json> ResultStore::read(const Record &record) const {
+  std::ifstream file(directory / segment_name(record.segment),
+                     std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  std::string line(record.length, '\0');
+  file.seekg(static_cast<std::streamoff>(record.offset));
+  if (file.read(line.data(), static_cast<std::streamsize>(line.size()))) {
+    nlohmann::json result = nlohmann::json::parse(line, nullptr, false);
+    if (is_record(result, record)) {
+      return result;
+    }
+  }
+  return resync(record);
+}
+
+// An earlier failed append in the segment shifts everything queued after
+// it, so look for the record on line boundaries instead
+std::optional<nlohmann::json>
+ResultStore::resync(const Record &record) const {
+  std::ifstream file(directory / segment_name(record.segment),
+                     std::ios::binary);
+  std::string line;
+  while (std::getline(file, line)) {
+    nlohmann::json result = nlohmann::json::parse(line, nullptr, false);
+    if (is_record(result, record)) {
+      return result;
+    }
+  }
+  return std::nullopt;
+}
+
+std::vector<nlohmann::json>
+ResultStore::read_all(const std::vector<Record> &found) {
+  std::vector<nlohmann::json> results;
+  for (const Record &record : found) {
+    if (auto result = read(record)) {
+      results.push_back(std::move(*result));
+    }
+  }
+  return results;
+}
+
+std::optional<nlohmann::json> ResultStore::find(const std::string &battle_id) {
+  flush_uncommitted();
+  std::vector<Record> found;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = by_battle.find(battle_id);
+    if (it != by_battle.end()) {
+      if (const Record *record = record_at(it->second)) {
+        found.push_back(*record);
+      }
+    }
+  }
+  std::vector<nlohmann::json> results = read_all(found);
+  if (results.empty()) {
+    return std::nullopt;
+  }
+  return results.front();
+}
+
+std::vector<nlohmann::json>
+ResultStore::for_player_team(const TeamId &team_id, size_t limit) {
+  flush_uncommitted();
+  std::vector<Record> found;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = by_player_team.find(team_id);
+    if (it != by_player_team.end()) {
+      for (auto seq = it->second.rbegin();
+           seq != it->second.rend() && found.size() < limit; ++seq) {
+        if (const Record *record = record_at(*seq)) {
+          found.push_back(*record);
+        }
+      }
+    }
+  }
+  return read_all(found);
+}
+
+std::vector<nlohmann::json> ResultStore::since(int64_t saved_at_ms,
+                                               size_t limit) {
+  flush_uncommitted();
+  std::vector<Record> found;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = std::lower_bound(records.begin(), records.end(), saved_at_ms,
+                               [](const Record &record, int64_t value) {
+                                 return record.saved_at_ms < value;
+                               });
+    for (; it != records.end() && found.size() < limit; ++it) {
+      found.push_back(*it);
+    }
+  }
+  return read_all(found);
+}
+
+size_t ResultStore::size() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return records.size();
+}
+
+size_t ResultStore::apply_retention() {
+  std::vector<uint64_t> dropped_segments;
+  size_t dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    int64_t max_age_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(policy.max_age)
+            .count();
+
+    while (!records.empty() && records.front().segment != active_segment) {
+      uint64_t segment = records.front().segment;
+      // Its queued appends would land in a deleted file
+      if (pending_by_segment.count(segment) > 0) {
+        break;
+      }
+      size_t count = 0;
+      while (count < records.size() && records[count].segment == segment) {
+        count++;
+      }
+      bool over_count = records.size() - count >= policy.max_results;
+      bool too_old = max_age_ms > 0 &&
+                     now - records[count - 1].saved_at_ms > max_age_ms;
+      if (!over_count && !too_old) {
+        break;
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+        const Record &record = records.front();
+        auto battle = by_battle.find(record.battle_id);
+        if (battle != by_battle.end() && battle->second == first_sequence) {
+          by_battle.erase(battle);
+        }
+        auto team = by_player_team.find(record.player_team_id);
+        if (team != by_player_team.end()) {
+          std::vector<uint64_t> &seqs = team->second;
+          seqs.erase(seqs.begin(),
+                     std::lower_bound(seqs.begin(), seqs.end(),
+                                      first_sequence + 1));
+          if (seqs.empty()) {
+            by_player_team.erase(team);
+          }
+        }
+        records.pop_front();
+        first_sequence++;
+      }
+      dropped += count;
+      dropped_segments.push_back(segment);
+    }
+  }
+
+  if (dropped_segments.empty()) {
+    return 0;
+  }
+
+  for (uint64_t segment : dropped_segments) {
+    std::error_code ec;
+    std::filesystem::remove(directory / segment_name(segment), ec);
+  }
+  log_info("Result retention dropped {} results in {} segments", dropped,
+           dropped_segments.size());
+  return dropped;
+}
+
+void ResultStore::start_maintenance(std::chrono::seconds interval,
+                                    std::function<void()> housekeeping) {
+  stop_maintenance();
+
+  {
+    std::lock_guard<std::mutex> lock(maintenance_mtx);
+    maintaining = true;
+  }
+
+  maintenance = std::thread([this, interval, housekeeping]() {
+    std::unique_lock<std::mutex> lock(maintenance_mtx);
+    while (!maintenance_cv.wait_for(lock, interval,
+                                    [this] { return !maintaining; })) {
+      lock.unlock();
+      try {
+        apply_retention();
+        if (housekeeping) {
+          housekeeping();
+        }
+      } catch (const std::exception &e) {
+        log_warn("Result store maintenance failed: {}", e.what());
+      }
+      lock.lock();
+    }
+  });
+}
+
+void ResultStore::stop_maintenance() {
+  {
+    std::lock_guard<std::mutex> lock(maintenance_mtx);
+    maintaining = false;
+  }
+  maintenance_cv.notify_all();
+  if (maintenance.joinable()) {
+    maintenance.join();
+  }
+}
+} // namespace server
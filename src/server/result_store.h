@@ -0,0 +1,114 @@
+#pragma once
+
+#include "durable_writer.h"
+#include "team_types.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+struct ResultRetention {
+  // Oldest segments are dropped once this many newer results remain
+  size_t max_results = 10000;
+  // Segments whose newest result is older than this are dropped, 0 keeps all
+  std::chrono::seconds max_age{0};
+  uint64_t segment_bytes = 4 * 1024 * 1024;
+};
+
+// Battle results as an append-only log of JSON lines split into segment
+// files (results-000001.log, ...), with an in-memory index by battle id,
+// player team id and save time. Appends never list or stat the directory;
+// retention drops whole segments on a background thread. A result is only
+// indexed once the writer has committed it; a failed append rolls on to a
+// fresh segment, and reads that don't find their record at the expected
+// offset rescan the segment line by line.
+struct ResultStore {
+  struct Record {
+    std::string battle_id;
+    TeamId player_team_id;
+    int64_t saved_at_ms = 0;
+    uint64_t segment = 0;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+  };
+
+  explicit ResultStore(DurableWriter &writer) : writer(writer) {}
+  ResultStore(const ResultStore &) = delete;
+  ResultStore &operator=(const ResultStore &) = delete;
+  ~ResultStore() {
+    stop_maintenance();
+    // Commit callbacks refer to this store
+    writer.flush();
+  }
+
+  // Rebuilds the index from the segments already in directory
+  void open(const std::filesystem::path &directory, ResultRetention policy);
+  // Stamps the result with battleId and savedAt and queues it for writing.
+  // The future is true once the result is on disk and indexed.
+  std::future<bool> append(const std::string &battle_id,
+                           nlohmann::json result);
+
+  std::optional<nlohmann::json> find(const std::string &battle_id);
+  // Newest first
+  std::vector<nlohmann::json> for_player_team(const TeamId &team_id,
+                                              size_t limit);
+  std::vector<nlohmann::json> since(int64_t saved_at_ms, size_t limit);
+  size_t size() const;
+
+  // Returns the number of results dropped
+  size_t apply_retention();
+  // Runs apply_retention, then housekeeping if set, every interval
+  void start_maintenance(std::chrono::seconds interval,
+                         std::function<void()> housekeeping = {});
+  void stop_maintenance();
+
+  static std::string segment_name(uint64_t segment);
+
+private:
+  DurableWriter &writer;
+  std::filesystem::path directory;
+  ResultRetention policy;
+
+  // Held across placing and queueing an append so the writer sees appends
+  // in offset order. Never taken by commit callbacks, which lock mtx.
+  std::mutex append_mtx;
+  mutable std::mutex mtx;
+  // Commit order; sequence numbers start at first_sequence
+  std::deque<Record> records;
+  uint64_t first_sequence = 0;
+  std::unordered_map<std::string, uint64_t> by_battle;
+  std::unordered_map<TeamId, std::vector<uint64_t>> by_player_team;
+  uint64_t active_segment = 1;
+  // Includes appends still queued, so the next one knows its offset
+  uint64_t active_bytes = 0;
+  int64_t last_saved_at_ms = 0;
+  // Appends queued but not yet committed, by segment; retention never
+  // drops a segment listed here
+  std::unordered_map<uint64_t, size_t> pending_by_segment;
+
+  std::thread maintenance;
+  std::mutex maintenance_mtx;
+  std::condition_variable maintenance_cv;
+  bool maintaining = false;
+
+  void index(Record record);
+  void committed(const Record &record, bool ok);
+  // Lets lookups see results that are still queued
+  void flush_uncommitted();
+  const Record *record_at(uint64_t sequence) const;
+  std::optional<nlohmann::json> read(const Record &record) const;
+  std::optional<nlohmann::json> resync(const Record &record) const;
+  std::vector<nlohmann::json> read_all(const std::vector<Record> &found);
+};
+} // namespace server
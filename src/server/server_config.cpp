@@ -1,7 +1,9 @@
 #include "server_config.h"
 #include "../log.h"
 #include "file_storage.h"
+#include <algorithm>
 #include <nlohmann/json.hpp>
+#include <thread>
 
 namespace server {
 ServerConfig ServerConfig::load_from_json(const std::string &config_path) {
@@ -85,6 +87,63 @@ ServerConfig ServerConfig::load_from_json(const std::string &config_path) {
     config.file_operation_retries = json_config["file_operation_retries"];
   }
 
+  if (json_config.contains("battle_workers") &&
+      json_config["battle_workers"].is_number()) {
+    config.battle_workers = json_config["battle_workers"];
+  }
+
+  if (json_config.contains("instant_battles") &&
+      json_config["instant_battles"].is_boolean()) {
+    config.instant_battles = json_config["instant_battles"];
+  }
+
+  if (json_config.contains("opponent_rescan_seconds") &&
+      json_config["opponent_rescan_seconds"].is_number()) {
+    config.opponent_rescan_seconds = json_config["opponent_rescan_seconds"];
+  }
+
+  if (json_config.contains("max_batch_battles") &&
+      json_config["max_batch_battles"].is_number()) {
+    config.max_batch_battles = json_config["max_batch_battles"];
+  }
+
+  if (json_config.contains("result_segment_kb") &&
+      json_config["result_segment_kb"].is_number()) {
+    config.result_segment_kb = json_config["result_segment_kb"];
+  }
+
+  if (json_config.contains("result_retention_count") &&
+      json_config["result_retention_count"].is_number()) {
+    config.result_retention_count = json_config["result_retention_count"];
+  }
+
+  if (json_config.contains("result_retention_hours") &&
+      json_config["result_retention_hours"].is_number()) {
+    config.result_retention_hours = json_config["result_retention_hours"];
+  }
+
+  if (json_config.contains("maintenance_interval_seconds") &&
+      json_config["maintenance_interval_seconds"].is_number()) {
+    config.maintenance_interval_seconds =
+        json_config["maintenance_interval_seconds"];
+  }
+
+  if (json_config.contains("profile_systems") &&
+      json_config["profile_systems"].is_boolean()) {
+    config.profile_systems = json_config["profile_systems"];
+  }
+
+  if (json_config.contains("game_state_snapshot_every") &&
+      json_config["game_state_snapshot_every"].is_number()) {
+    config.game_state_snapshot_every =
+        json_config["game_state_snapshot_every"];
+  }
+
+  if (json_config.contains("log_levels") &&
+      json_config["log_levels"].is_string()) {
+    config.log_levels = json_config["log_levels"];
+  }
+
   return config;
 }
 
@@ -101,6 +160,10 @@ std::filesystem::path ServerConfig::get_results_path() const {
   return std::filesystem::path(base_path) / "output" / "battles" / "results";
 }
 
+std::filesystem::path ServerConfig::get_game_states_path() const {
+  return std::filesystem::path(base_path) / "output" / "saves" / "server";
+}
+
 std::filesystem::path ServerConfig::get_opponents_path() const {
   return std::filesystem::path(base_path) / "resources" / "battles" /
          "opponents";
@@ -110,4 +173,22 @@ std::filesystem::path ServerConfig::get_debug_path() const {
   return std::filesystem::path(base_path) / "output" / "battles" / "debug";
 }
 
+ResultRetention ServerConfig::get_result_retention() const {
+  ResultRetention retention;
+  retention.max_results =
+      static_cast<size_t>(std::max(0, result_retention_count));
+  retention.max_age = std::chrono::hours(std::max(0, result_retention_hours));
+  retention.segment_bytes =
+      static_cast<uint64_t>(std::max(1, result_segment_kb)) * 1024;
+  return retention;
+}
+
+size_t ServerConfig::get_battle_worker_count() const {
+  if (battle_workers >= 0) {
+    return static_cast<size_t>(battle_workers);
+  }
+  unsigned int cores = std::thread::hardware_concurrency();
+  return cores > 0 ? cores : 1;
+}
+
 } // namespace server
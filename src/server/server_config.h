@@ -1,5 +1,6 @@
 #pragma once
 
+#include "result_store.h"
 #include <filesystem>
 #include <string>
 
@@ -17,13 +18,34 @@ struct ServerConfig {
   bool enable_cors = true;
   std::string cors_origin = "*";
   int file_operation_retries = 3;
+  // -1 uses one battle world per core, 0 simulates in-process
+  int battle_workers = -1;
+  bool instant_battles = true;
+  // How often the opponent catalog rescans its directory, 0 disables
+  int opponent_rescan_seconds = 5;
+  int max_batch_battles = 1000;
+  // Result log retention; see ResultRetention
+  int result_segment_kb = 4096;
+  int result_retention_count = 10000;
+  int result_retention_hours = 0;
+  // How often retention and temp file cleanup run
+  int maintenance_interval_seconds = 30;
+  // Deltas between full snapshots of a saved game state
+  int game_state_snapshot_every = 20;
+  // Time every ECS system per tick and serve the totals from /profile
+  bool profile_systems = false;
+  // Per-category log levels, see log_configure_categories
+  std::string log_levels = "BATTLE_SIM=WARN,BATTLE_PROCESSOR=WARN,ANIM=WARN";
 
   static ServerConfig load_from_json(const std::string &config_path);
   static ServerConfig defaults();
 
   std::filesystem::path get_temp_files_path() const;
   std::filesystem::path get_results_path() const;
+  std::filesystem::path get_game_states_path() const;
   std::filesystem::path get_opponents_path() const;
   std::filesystem::path get_debug_path() const;
+  size_t get_battle_worker_count() const;
+  ResultRetention get_result_retention() const;
 };
 } // namespace server
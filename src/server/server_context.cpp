@@ -6,6 +6,7 @@
 #include "../render_backend.h"
 #include "../seeded_rng.h"
 #include "../shop.h"
+#include "../systems/ProfiledSystem.h"
 #include "../systems/battle_system_registry.h"
 #include "async/systems/CollectBattleResultsSystem.h"
 #include "async/systems/DebugServerEventLoggerSystem.h"
@@ -31,6 +32,10 @@ ServerContext ServerContext::initialize() {
 
   ctx.register_server_systems();
 
+  if (SystemProfiler::get().enabled()) {
+    instrument_systems(ctx.systems);
+  }
+
   return ctx;
 }
 
@@ -61,6 +66,18 @@ void ServerContext::register_server_systems() {
   log_info("SERVER_ECS: registered 4 server systems");
 }
 
+void ServerContext::reset_for_next_battle() {
+  // Battle systems reset their per-battle flags when they see the screen
+  // leave Battle, so run one empty tick off the battle screen, as the client
+  // does between battles
+  GameStateManager::get().set_next_screen(GameStateManager::Screen::Main);
+  GameStateManager::get().update_screen();
+  systems.run(0.0f);
+
+  GameStateManager::get().set_next_screen(GameStateManager::Screen::Battle);
+  GameStateManager::get().update_screen();
+}
+
 bool ServerContext::is_battle_complete() const {
   afterhours::RefEntity cq_entity =
       afterhours::EntityHelper::get_singleton<CombatQueue>();
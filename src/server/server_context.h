@@ -15,6 +15,8 @@ struct ServerContext {
   void initialize_singletons();
   void register_battle_systems();
   void register_server_systems();
+  // Returns warm systems to their pre-battle state without re-registering
+  void reset_for_next_battle();
   bool is_battle_complete() const;
 };
 } // namespace server
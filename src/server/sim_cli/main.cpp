@@ -0,0 +1,186 @@
+#include "../../log.h"
+#include "../../preload.h"
+#include "../../render_backend.h"
+#include "../../rl.h"
+#include "../../shop.h"
+#include "../balance_report.h"
+#include "../battle_world.h"
+#include "../file_storage.h"
+#include "../opponent_catalog.h"
+#include "../server_config.h"
+#include <afterhours/ah.h>
+#include <argh.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+bool render_backend::is_headless_mode = true;
+int render_backend::step_delay_ms = 0;
+float render_backend::timing_speed_scale = 1.0f;
+bool running = true;
+
+int main(int argc, char *argv[]) {
+  argh::parser cmdl(argc, argv);
+
+  if (cmdl[{"--help", "-h"}]) {
+    std::cout << "Battle Sim CLI - offline round-robin balance simulation\n\n";
+    std::cout << "Usage: battle_sim_cli [OPTIONS]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h, --help              Show this help message\n";
+    std::cout << "  --teams <dir>           Team JSON corpus (default: "
+                 "opponents path)\n";
+    std::cout << "  --seeds <n>             Seeds per pairing (default: 10)\n";
+    std::cout << "  --base-seed <n>         First seed (default: 1)\n";
+    std::cout << "  -j, --workers <n>       Battle worlds (default: all "
+                 "cores)\n";
+    std::cout << "  --format <csv|json>     Report format (default: csv)\n";
+    std::cout << "  -o, --out <dir>         Report directory (default: "
+                 "output/balance)\n";
+    std::cout << "\n";
+    std::cout << "Examples:\n";
+    std::cout << "  battle_sim_cli --teams resources/teams --seeds 100\n";
+    std::cout << "  battle_sim_cli --format json -j 8\n";
+    return 0;
+  }
+
+  server::ServerConfig config = server::ServerConfig::defaults();
+
+  std::string teams_path = config.get_opponents_path().string();
+  cmdl("--teams") >> teams_path;
+  int seed_count = 10;
+  cmdl("--seeds") >> seed_count;
+  uint64_t base_seed = 1;
+  cmdl("--base-seed") >> base_seed;
+  size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+  cmdl({"-j", "--workers"}) >> worker_count;
+  std::string format = "csv";
+  cmdl("--format") >> format;
+  std::string out_path = "output/balance";
+  cmdl({"-o", "--out"}) >> out_path;
+
+  if (seed_count < 1 || (format != "csv" && format != "json")) {
+    std::cerr << "Invalid --seeds or --format, see --help\n";
+    return 1;
+  }
+
+  server::OpponentCatalog catalog;
+  catalog.refresh(teams_path, config.max_team_size);
+  std::vector<std::shared_ptr<const server::OpponentEntry>> teams =
+      catalog.all();
+  if (teams.size() < 2) {
+    std::cerr << "Need at least two valid teams in " << teams_path << "\n";
+    return 1;
+  }
+
+  std::vector<server::TeamId> team_ids;
+  std::vector<std::vector<std::string>> team_dishes;
+  for (const auto &team : teams) {
+    team_ids.push_back(team->id);
+    team_dishes.push_back(
+        server::BalanceReport::team_dish_types(team->team));
+  }
+
+  // Same process setup as battle_server; battle worlds fork from here
+  Preload::get().init("battle_sim_cli", true).make_singleton();
+  auto &manager_entity = afterhours::EntityHelper::createEntity();
+  make_combat_manager(manager_entity);
+  make_battle_processor_manager(manager_entity);
+
+  server::BattleWorldPool pool;
+  pool.start(worker_count);
+
+  // Every ordered pairing (both sides of each matchup) for every seed
+  size_t team_count = teams.size();
+  size_t pair_count = team_count * (team_count - 1);
+  size_t battle_count = pair_count * static_cast<size_t>(seed_count);
+  log_info("Simulating {} battles ({} teams, {} seeds) on {} worlds",
+           battle_count, team_count, seed_count, pool.size());
+
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+  std::vector<server::BalanceReport> reports(
+      std::max<size_t>(1, pool.size()), server::BalanceReport(team_ids));
+
+  auto drain = [&](server::BalanceReport &report) {
+    for (size_t i = next++; i < battle_count; i = next++) {
+      size_t pair = i / static_cast<size_t>(seed_count);
+      size_t player = pair / (team_count - 1);
+      size_t opponent = pair % (team_count - 1);
+      if (opponent >= player) {
+        opponent++;
+      }
+
+      server::BattleWorldJob job;
+      job.player_team = teams[player]->team;
+      job.opponent_team = teams[opponent]->team;
+      job.opponent_id = teams[opponent]->id;
+      job.seed = base_seed + i % static_cast<size_t>(seed_count);
+      job.max_iterations = std::min(config.timeout_seconds * 60,
+                                    config.max_simulation_iterations);
+      job.timeout_seconds = config.timeout_seconds;
+      job.temp_files_path = config.get_temp_files_path().string();
+      // The report only reads outcomes
+      job.collect_events = false;
+
+      server::BattleWorldResult result = pool.run(job);
+      if (result.status == server::BattleWorldResult::Status::Complete) {
+        report.record(player, opponent, team_dishes[player],
+                      team_dishes[opponent], result.response["outcomes"]);
+      } else if (result.status == server::BattleWorldResult::Status::Timeout) {
+        report.timeouts++;
+      } else {
+        report.errors++;
+      }
+
+      size_t finished = ++done;
+      if (finished % 1000 == 0) {
+        log_info("{}/{} battles", finished, battle_count);
+      }
+    }
+  };
+
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < reports.size(); ++i) {
+    workers.emplace_back(drain, std::ref(reports[i]));
+  }
+  drain(reports[0]);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  pool.stop();
+
+  server::BalanceReport &report = reports[0];
+  for (size_t i = 1; i < reports.size(); ++i) {
+    report.merge(reports[i]);
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+  log_info("Simulated {} battles in {}ms ({} timeouts, {} errors)",
+           report.total_games(), elapsed.count(), report.timeouts,
+           report.errors);
+
+  std::filesystem::path out_dir = out_path;
+  server::FileStorage::ensure_directory_exists(out_dir.string());
+  bool saved = false;
+  if (format == "json") {
+    saved = server::FileStorage::save_json_to_file(
+        (out_dir / "balance_report.json").string(), report.to_json());
+  } else {
+    saved = server::FileStorage::save_string_to_file(
+                (out_dir / "win_rates.csv").string(), report.matrix_csv()) &&
+            server::FileStorage::save_string_to_file(
+                (out_dir / "dish_contribution.csv").string(),
+                report.dishes_csv());
+  }
+
+  if (!saved) {
+    std::cerr << "Failed to write report to " << out_dir << "\n";
+    return 1;
+  }
+  std::cout << "Report written to " << out_dir << "\n";
+  return 0;
+}
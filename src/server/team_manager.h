@@ -18,8 +18,6 @@ struct TeamManager {
                                  int max_team_size = 7);
   static void
   track_opponent_file_count(const std::filesystem::path &opponents_path);
-
-private:
   static bool is_path_safe(const std::string &file_path,
                            const std::filesystem::path &allowed_dir);
 };
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../battle_world.h"
+#include "../file_storage.h"
+#include <cstdint>
+
+// The battle_team_1 vs battle_team_2 job the battle world tests run
+inline server::BattleWorldJob make_world_job(uint64_t seed) {
+  server::BattleWorldJob job;
+  job.player_team = server::FileStorage::load_json_from_file(
+      "src/server/tests/test_data/battle_team_1.json");
+  job.opponent_team = server::FileStorage::load_json_from_file(
+      "src/server/tests/test_data/battle_team_2.json");
+  job.opponent_id = "battle_team_2";
+  job.seed = seed;
+  job.max_iterations = 100000;
+  job.timeout_seconds = 30;
+  job.temp_files_path = "output/battles";
+  return job;
+}
@@ -0,0 +1,49 @@
+#include "../balance_report.h"
+#include "../test_framework.h"
+
+static nlohmann::json course(const std::string &winner) {
+  return nlohmann::json::array({{{"slotIndex", 0}, {"winner", winner}}});
+}
+
+SERVER_TEST(balance_report_tracks_matrix_and_dishes) {
+  std::vector<std::string> potato = {"Potato"};
+  std::vector<std::string> salmon = {"Salmon", "Potato"};
+
+  server::BalanceReport first({"alpha", "beta"});
+  first.record(0, 1, potato, salmon, course("Player"));
+  first.record(1, 0, salmon, potato, course("Tie"));
+
+  server::BalanceReport second({"alpha", "beta"});
+  second.record(0, 1, potato, salmon, course("Opponent"));
+  second.timeouts++;
+
+  first.merge(second);
+  ASSERT_EQ(3, first.total_games());
+  ASSERT_EQ(2, first.games[0][1]);
+  ASSERT_EQ(1, first.wins[0][1]);
+  ASSERT_EQ(1, first.ties[1][0]);
+  ASSERT_EQ(1, first.timeouts);
+
+  ASSERT_EQ(3, first.dishes["Salmon"].games);
+  ASSERT_EQ(1, first.dishes["Salmon"].wins);
+  ASSERT_EQ(6, first.dishes["Potato"].games);
+  ASSERT_EQ(2, first.dishes["Potato"].wins);
+
+  nlohmann::json report = first.to_json();
+  ASSERT_EQ(0.5, report["matrix"][0][1]["winRate"].get<double>());
+  ASSERT_STREQ(first.matrix_csv(),
+               std::string("team,alpha,beta\nalpha,,0.5000\nbeta,0.0000,\n"));
+}
+
+SERVER_TEST(balance_report_reads_team_dish_types) {
+  nlohmann::json team = {
+      {"team", nlohmann::json::array({{{"slot", 0}, {"dishType", "Potato"}},
+                                      {{"slot", 1}, {"dishType", "Bagel"}}})}};
+  std::vector<std::string> dishes =
+      server::BalanceReport::team_dish_types(team);
+  ASSERT_EQ(static_cast<size_t>(2), dishes.size());
+  ASSERT_STREQ(dishes[1], std::string("Bagel"));
+  ASSERT_TRUE(
+      server::BalanceReport::team_dish_types(nlohmann::json::object())
+          .empty());
+}
@@ -0,0 +1,76 @@
+#include "../../utils/battle_event_log.h"
+#include "../battle_serializer.h"
+#include "../battle_simulator.h"
+#include "../file_storage.h"
+#include "../test_framework.h"
+#include <nlohmann/json.hpp>
+
+SERVER_TEST(battle_event_log_round_trips_events) {
+  using server::async::DebugBattleEvent;
+  std::vector<DebugBattleEvent> events = {
+      {TriggerHook::OnStartBattle, 0, 0, DishBattleState::TeamSide::Player,
+       0.0f, 0, 0, 0.0f},
+      {TriggerHook::OnBiteTaken, 17, 3, DishBattleState::TeamSide::Opponent,
+       1.25f, 2, -4, 0.5f},
+      {TriggerHook::OnDishFinished, 17, 3, DishBattleState::TeamSide::Opponent,
+       1.25f, 2, 0, 0.0f},
+      {TriggerHook::OnCourseComplete, 9, 1, DishBattleState::TeamSide::Player,
+       0.75f, 6, 1000000, -3.0f}};
+
+  BattleEventLog log;
+  for (const auto &ev : events) {
+    log.append(ev);
+  }
+  ASSERT_EQ(events.size(), log.size());
+
+  auto bytes =
+      BattleEventLog::from_base64(BattleEventLog::to_base64(log.bytes()));
+  ASSERT_TRUE(bytes.has_value());
+  ASSERT_TRUE(*bytes == log.bytes());
+
+  auto decoded = BattleEventLog::decode(*bytes);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_EQ(BattleEventLog::to_json(events).dump(),
+            BattleEventLog::to_json(*decoded).dump());
+
+  std::vector<uint8_t> truncated(log.bytes().begin(), log.bytes().end() - 1);
+  ASSERT_FALSE(BattleEventLog::decode(truncated).has_value());
+  ASSERT_FALSE(BattleEventLog::from_base64("abc").has_value());
+}
+
+SERVER_TEST(battle_event_log_matches_json_events) {
+  nlohmann::json player_team = server::FileStorage::load_json_from_file(
+      "src/server/tests/test_data/battle_team_1.json");
+  nlohmann::json opponent_team = server::FileStorage::load_json_from_file(
+      "src/server/tests/test_data/battle_team_2.json");
+
+  server::BattleSimulator simulator;
+  simulator.start_battle(player_team, opponent_team, 12345, "output/battles");
+  for (int i = 0; i < 100000 && !simulator.is_complete(); ++i) {
+    simulator.update(1.0f / 60.0f);
+  }
+  ASSERT_TRUE(simulator.is_complete());
+
+  nlohmann::json events =
+      server::BattleSerializer::collect_battle_events(simulator);
+  std::vector<uint8_t> encoded =
+      server::BattleSerializer::collect_event_log(simulator);
+
+  auto decoded = BattleEventLog::decode(encoded);
+  ASSERT_TRUE(decoded.has_value());
+  ASSERT_EQ(events.dump(), BattleEventLog::to_json(*decoded).dump());
+  ASSERT_TRUE(encoded.size() * 4 < events.dump().size());
+
+  // Raw bytes for CBOR and MessagePack, base64 once it has to be JSON
+  nlohmann::json result = server::BattleSerializer::serialize_battle_result(
+      12345, "opponent", nlohmann::json::array(), nullptr, false, encoded);
+  ASSERT_TRUE(result["eventLog"].is_binary());
+  server::BattleSerializer::event_log_to_base64(result);
+  ASSERT_TRUE(result["eventLog"].is_string());
+  auto bytes =
+      BattleEventLog::from_base64(result["eventLog"].get<std::string>());
+  ASSERT_TRUE(bytes.has_value());
+  ASSERT_TRUE(*bytes == encoded);
+
+  server::BattleSimulator::cleanup_test_entities();
+}
@@ -0,0 +1,90 @@
+#include "../../utils/battle_fingerprint.h"
+#include "../../utils/battle_snapshot.h"
+#include "../battle_simulator.h"
+#include "../file_storage.h"
+#include "../test_framework.h"
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+static nlohmann::json load_snapshot_team(const std::string &filename) {
+  std::string path = "src/server/tests/test_data/" + filename;
+  return server::FileStorage::load_json_from_file(path);
+}
+
+SERVER_TEST(battle_snapshot_restore_replays_identically) {
+  server::BattleSimulator simulator;
+  std::filesystem::path temp_path = "output/battles";
+  simulator.start_battle(load_snapshot_team("battle_team_1.json"),
+                         load_snapshot_team("battle_team_2.json"), 4242,
+                         temp_path);
+
+  const float fixed_dt = 1.0f / 60.0f;
+  for (int i = 0; i < 120 && !simulator.is_complete(); ++i) {
+    simulator.update(fixed_dt);
+  }
+  ASSERT_FALSE(simulator.is_complete());
+
+  BattleSnapshot snapshot = BattleSnapshotter::capture("test", 2000, 120);
+  ASSERT_FALSE(snapshot.dishes.empty());
+
+  std::vector<uint64_t> first;
+  for (int i = 0; i < 600 && !simulator.is_complete(); ++i) {
+    simulator.update(fixed_dt);
+    first.push_back(BattleFingerprint::compute());
+  }
+
+  ASSERT_TRUE(BattleSnapshotter::restore(snapshot));
+  ASSERT_EQ(snapshot.fingerprint, BattleFingerprint::compute());
+
+  std::vector<uint64_t> second;
+  for (size_t i = 0; i < first.size(); ++i) {
+    simulator.update(fixed_dt);
+    second.push_back(BattleFingerprint::compute());
+  }
+  ASSERT_TRUE(first == second);
+}
+
+SERVER_TEST(battle_snapshot_restore_drops_dishes_created_later) {
+  server::BattleSimulator simulator;
+  std::filesystem::path temp_path = "output/battles";
+  simulator.start_battle(load_snapshot_team("battle_team_1.json"),
+                         load_snapshot_team("battle_team_2.json"), 4343,
+                         temp_path);
+
+  const float fixed_dt = 1.0f / 60.0f;
+  for (int i = 0; i < 120 && !simulator.is_complete(); ++i) {
+    simulator.update(fixed_dt);
+  }
+  ASSERT_FALSE(simulator.is_complete());
+  BattleSnapshot snapshot = BattleSnapshotter::capture("test", 2000, 120);
+
+  // Like a summon landing after the capture point
+  afterhours::Entity &summoned = afterhours::EntityHelper::createEntity();
+  summoned.addComponent<IsDish>(DishType::Potato);
+  summoned.addComponent<DishBattleState>().phase =
+      DishBattleState::Phase::InCombat;
+  afterhours::EntityHelper::merge_entity_arrays();
+  ASSERT_TRUE(snapshot.fingerprint != BattleFingerprint::compute());
+
+  ASSERT_TRUE(BattleSnapshotter::restore(snapshot));
+  ASSERT_TRUE(summoned.cleanup);
+  ASSERT_EQ(snapshot.fingerprint, BattleFingerprint::compute());
+  server::BattleSimulator::cleanup_test_entities();
+}
+
+SERVER_TEST(replay_snapshots_find_by_time_and_course) {
+  ReplaySnapshots snapshots;
+  for (int i = 0; i < 4; ++i) {
+    BattleSnapshot snapshot;
+    snapshot.clock_ms = i * 1000;
+    snapshot.course = i / 2;
+    snapshots.snapshots.push_back(std::move(snapshot));
+  }
+
+  ASSERT_TRUE(snapshots.at_or_before(-1) == nullptr);
+  ASSERT_EQ(static_cast<int64_t>(1000), snapshots.at_or_before(1999)->clock_ms);
+  ASSERT_EQ(static_cast<int64_t>(3000), snapshots.at_or_before(9000)->clock_ms);
+  ASSERT_EQ(static_cast<int64_t>(2000), snapshots.for_course(1)->clock_ms);
+  ASSERT_TRUE(snapshots.for_course(2) == nullptr);
+}
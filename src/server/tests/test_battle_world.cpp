@@ -0,0 +1,109 @@
+#include "../battle_serializer.h"
+#include "../battle_world.h"
+#include "../file_storage.h"
+#include "../test_framework.h"
+#include "battle_world_fixture.h"
+#include <future>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+SERVER_TEST(battle_world_pool_matches_inline_simulation) {
+  server::BattleWorldJob job = make_world_job(12345);
+
+  server::BattleWorldResult inline_result = server::BattleWorld::simulate(job);
+  ASSERT_TRUE(inline_result.status ==
+              server::BattleWorldResult::Status::Complete);
+
+  server::BattleWorldPool pool;
+  pool.start(2);
+  ASSERT_EQ(static_cast<size_t>(2), pool.size());
+
+  std::future<server::BattleWorldResult> first = pool.submit(job);
+  std::future<server::BattleWorldResult> second = pool.submit(job);
+
+  server::BattleWorldResult first_result = first.get();
+  server::BattleWorldResult second_result = second.get();
+  pool.stop();
+
+  ASSERT_TRUE(first_result.status ==
+              server::BattleWorldResult::Status::Complete);
+  ASSERT_TRUE(second_result.status ==
+              server::BattleWorldResult::Status::Complete);
+  ASSERT_EQ(inline_result.response["outcomes"].dump(),
+            first_result.response["outcomes"].dump());
+  ASSERT_EQ(first_result.response.dump(), second_result.response.dump());
+
+  // A stopped pool fails new battles instead of running them
+  ASSERT_TRUE(pool.submit(job).get().status ==
+              server::BattleWorldResult::Status::Error);
+}
+
+SERVER_TEST(instant_mode_matches_timed_mode) {
+  const std::string data = "src/server/tests/test_data/";
+  struct Matchup {
+    std::string player;
+    std::string opponent;
+    uint64_t seed;
+  };
+  const std::vector<Matchup> matchups = {
+      {"battle_team_1.json", "battle_team_2.json", 424242},
+      {"battle_team_1.json", "battle_team_2.json", 7},
+      {"battle_team_2.json", "battle_team_1.json", 98765},
+      {"valid_full_team.json", "battle_team_2.json", 31337},
+      {"valid_with_level.json", "valid_full_team.json", 2024},
+  };
+
+  for (const Matchup &matchup : matchups) {
+    server::BattleWorldJob timed_job = make_world_job(matchup.seed);
+    timed_job.player_team =
+        server::FileStorage::load_json_from_file(data + matchup.player);
+    timed_job.opponent_team =
+        server::FileStorage::load_json_from_file(data + matchup.opponent);
+    timed_job.instant = false;
+    server::BattleWorldJob instant_job = timed_job;
+    instant_job.instant = true;
+
+    // Fresh worlds fork from the same parent state, so entity ids line up
+    server::BattleWorld timed_world;
+    ASSERT_TRUE(timed_world.start());
+    server::BattleWorldResult timed = timed_world.run(timed_job);
+    timed_world.shutdown();
+
+    server::BattleWorld instant_world;
+    ASSERT_TRUE(instant_world.start());
+    server::BattleWorldResult instant = instant_world.run(instant_job);
+    instant_world.shutdown();
+
+    ASSERT_TRUE(timed.status == server::BattleWorldResult::Status::Complete);
+    ASSERT_TRUE(instant.status ==
+                server::BattleWorldResult::Status::Complete);
+    ASSERT_EQ(timed.iterations, instant.iterations);
+    ASSERT_EQ(timed.simulation_time, instant.simulation_time);
+    ASSERT_EQ(timed.response["outcomes"].dump(),
+              instant.response["outcomes"].dump());
+    ASSERT_EQ(timed.response["eventLog"].dump(),
+              instant.response["eventLog"].dump());
+    ASSERT_STREQ(timed.response["checksum"].get<std::string>(),
+                 instant.response["checksum"].get<std::string>());
+  }
+}
+
+SERVER_TEST(summarize_outcomes_counts_course_winners) {
+  nlohmann::json outcomes = nlohmann::json::array(
+      {{{"slotIndex", 0}, {"winner", "Player"}},
+       {{"slotIndex", 1}, {"winner", "Opponent"}},
+       {{"slotIndex", 2}, {"winner", "Player"}},
+       {{"slotIndex", 3}, {"winner", "Tie"}}});
+
+  nlohmann::json summary =
+      server::BattleSerializer::summarize_outcomes(outcomes);
+  ASSERT_EQ(2, summary["playerWins"].get<int>());
+  ASSERT_EQ(1, summary["opponentWins"].get<int>());
+  ASSERT_EQ(1, summary["ties"].get<int>());
+  ASSERT_STREQ(summary["winner"].get<std::string>(), std::string("Player"));
+
+  nlohmann::json empty =
+      server::BattleSerializer::summarize_outcomes(nlohmann::json::array());
+  ASSERT_STREQ(empty["winner"].get<std::string>(), std::string("Tie"));
+}
@@ -1,3 +1,4 @@
+#include "../../utils/battle_fingerprint.h"
 #include "../battle_serializer.h"
 #include "../battle_simulator.h"
 #include "../file_storage.h"
@@ -106,3 +107,146 @@ SERVER_TEST(determinism_different_seed_same_results_simplified) {
   ASSERT_EQ(outcomes1.dump(), outcomes2.dump());
   ASSERT_EQ(checksum1, checksum2);
 }
+
+SERVER_TEST(in_memory_teams_match_debug_team_files) {
+  nlohmann::json player_team = load_test_json("battle_team_1.json");
+  nlohmann::json opponent_team = load_test_json("battle_team_2.json");
+  std::filesystem::path temp_path = "output/battles";
+  const float fixed_dt = 1.0f / 60.0f;
+  int max_iterations = 100000;
+  uint64_t seed = 33333;
+
+  server::BattleSimulator simulator1;
+  simulator1.start_battle(player_team, opponent_team, seed, temp_path);
+  ASSERT_TRUE(simulator1.player_temp_file.empty());
+  ASSERT_FALSE(std::filesystem::exists(temp_path / "temp_player_33333.json"));
+
+  int iterations1 = 0;
+  while (!simulator1.is_complete() && iterations1 < max_iterations) {
+    simulator1.update(fixed_dt);
+    iterations1++;
+  }
+  ASSERT_TRUE(simulator1.is_complete());
+  nlohmann::json outcomes1 =
+      server::BattleSerializer::collect_battle_outcomes();
+  nlohmann::json events1 =
+      server::BattleSerializer::collect_battle_events(simulator1);
+  std::string checksum1 =
+      server::BattleSerializer::compute_checksum(nlohmann::json{});
+
+  server::BattleSimulator simulator2;
+  simulator2.start_battle(player_team, opponent_team, seed, temp_path, true);
+  ASSERT_TRUE(std::filesystem::exists(simulator2.player_temp_file));
+
+  int iterations2 = 0;
+  while (!simulator2.is_complete() && iterations2 < max_iterations) {
+    simulator2.update(fixed_dt);
+    iterations2++;
+  }
+  ASSERT_TRUE(simulator2.is_complete());
+  nlohmann::json outcomes2 =
+      server::BattleSerializer::collect_battle_outcomes();
+  nlohmann::json events2 =
+      server::BattleSerializer::collect_battle_events(simulator2);
+  std::string checksum2 =
+      server::BattleSerializer::compute_checksum(nlohmann::json{});
+  simulator2.cleanup_temp_files();
+
+  ASSERT_EQ(iterations1, iterations2);
+  ASSERT_EQ(outcomes1.dump(), outcomes2.dump());
+  ASSERT_EQ(events1.dump(), events2.dump());
+  ASSERT_STREQ(checksum1, checksum2);
+}
+
+SERVER_TEST(pooled_simulator_reuse_matches_fresh_results) {
+  nlohmann::json player_team = load_test_json("battle_team_1.json");
+  nlohmann::json opponent_team = load_test_json("battle_team_2.json");
+  std::filesystem::path temp_path = "output/battles";
+  const float fixed_dt = 1.0f / 60.0f;
+  int max_iterations = 100000;
+
+  server::BattleSimulatorPool &pool = server::BattleSimulatorPool::get();
+  std::unique_ptr<server::BattleSimulator> first = pool.acquire();
+  first->start_battle(player_team, opponent_team, 55555, temp_path);
+  int iterations1 = 0;
+  while (!first->is_complete() && iterations1 < max_iterations) {
+    first->update(fixed_dt);
+    iterations1++;
+  }
+  ASSERT_TRUE(first->is_complete());
+  nlohmann::json outcomes1 =
+      server::BattleSerializer::collect_battle_outcomes();
+  size_t events1 = first->get_accumulated_events().size();
+  server::BattleSimulator::cleanup_test_entities();
+
+  server::BattleSimulator *warm_address = first.get();
+  pool.release(std::move(first), true);
+
+  std::unique_ptr<server::BattleSimulator> second = pool.acquire();
+  ASSERT_TRUE(second.get() == warm_address);
+  second->start_battle(player_team, opponent_team, 55555, temp_path);
+  int iterations2 = 0;
+  while (!second->is_complete() && iterations2 < max_iterations) {
+    second->update(fixed_dt);
+    iterations2++;
+  }
+  ASSERT_TRUE(second->is_complete());
+  nlohmann::json outcomes2 =
+      server::BattleSerializer::collect_battle_outcomes();
+  size_t events2 = second->get_accumulated_events().size();
+  server::BattleSimulator::cleanup_test_entities();
+  pool.release(std::move(second), true);
+
+  ASSERT_EQ(iterations1, iterations2);
+  ASSERT_EQ(events1, events2);
+  ASSERT_EQ(outcomes1.dump(), outcomes2.dump());
+}
+
+SERVER_TEST(fingerprint_checkpoints_fold_into_checksum) {
+  nlohmann::json player_team = load_test_json("battle_team_1.json");
+  nlohmann::json opponent_team = load_test_json("battle_team_2.json");
+  std::filesystem::path temp_path = "output/battles";
+  const float fixed_dt = 1.0f / 60.0f;
+
+  server::BattleSimulator simulator;
+  simulator.start_battle(player_team, opponent_team, 777, temp_path);
+  int iterations = 0;
+  while (!simulator.is_complete() && iterations < 100000) {
+    simulator.update(fixed_dt);
+    iterations++;
+  }
+  ASSERT_TRUE(simulator.is_complete());
+
+  std::string checksum =
+      server::BattleSerializer::compute_checksum(nlohmann::json{});
+  nlohmann::json checkpoints =
+      server::BattleSerializer::collect_fingerprint_checkpoints();
+  ASSERT_TRUE(checkpoints.size() >= 2);
+  ASSERT_STREQ(checkpoints.front()["label"].get<std::string>(),
+               std::string("start"));
+  ASSERT_STREQ(checkpoints.back()["label"].get<std::string>(),
+               std::string("end"));
+
+  uint64_t rolling = 0;
+  for (const auto &cp : checkpoints) {
+    rolling = BattleFingerprint::combine_hash(
+        rolling, std::stoull(cp["hash"].get<std::string>(), nullptr, 16));
+  }
+  ASSERT_STREQ(BattleFingerprint::to_hex(rolling), checksum);
+
+  // Asking again doesn't add checkpoints or change the checksum
+  ASSERT_STREQ(server::BattleSerializer::compute_checksum(nlohmann::json{}),
+               checksum);
+  ASSERT_EQ(checkpoints.size(),
+            server::BattleSerializer::collect_fingerprint_checkpoints().size());
+}
+
+SERVER_TEST(fingerprint_first_divergence_finds_first_mismatch) {
+  std::vector<std::string> server_side = {"a", "b", "c", "d"};
+  ASSERT_EQ(-1, BattleFingerprint::first_divergence(server_side, server_side));
+  ASSERT_EQ(2, BattleFingerprint::first_divergence({"a", "b", "x", "y"},
+                                                   server_side));
+  ASSERT_EQ(3,
+            BattleFingerprint::first_divergence({"a", "b", "c"}, server_side));
+  ASSERT_EQ(0, BattleFingerprint::first_divergence({}, server_side));
+}
@@ -0,0 +1,31 @@
+#include "../../dish_types.h"
+#include "../../drink_types.h"
+#include "../test_framework.h"
+#include <magic_enum/magic_enum.hpp>
+
+SERVER_TEST(dish_catalog_returns_stable_entries) {
+  for (DishType type : magic_enum::enum_values<DishType>()) {
+    for (int level = 1; level <= kMaxDishLevel; ++level) {
+      const DishInfo &first = get_dish_info(type, level);
+      const DishInfo &second = get_dish_info(type, level);
+      ASSERT_TRUE(&first == &second);
+      ASSERT_FALSE(first.name.empty());
+    }
+  }
+}
+
+SERVER_TEST(dish_catalog_out_of_range_levels_use_top_level) {
+  const DishInfo &top = get_dish_info(DishType::Salmon, kMaxDishLevel);
+  ASSERT_TRUE(&get_dish_info(DishType::Salmon, kMaxDishLevel + 1) == &top);
+  ASSERT_TRUE(&get_dish_info(DishType::Salmon, 0) == &top);
+  ASSERT_EQ(get_dish_info(DishType::Salmon, 2).effects.size(),
+            static_cast<size_t>(2));
+}
+
+SERVER_TEST(drink_catalog_returns_stable_entries) {
+  for (DrinkType type : magic_enum::enum_values<DrinkType>()) {
+    const DrinkInfo &info = get_drink_info(type);
+    ASSERT_TRUE(&info == &get_drink_info(type));
+    ASSERT_FALSE(info.name.empty());
+  }
+}
@@ -0,0 +1,114 @@
+#include "../durable_writer.h"
+#include "../file_storage.h"
+#include "../game_state_store.h"
+#include "../test_framework.h"
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <vector>
+
+static size_t count_temp_files(const std::filesystem::path &dir) {
+  size_t count = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+    if (entry.path().extension() == ".tmp") {
+      count++;
+    }
+  }
+  return count;
+}
+
+SERVER_TEST(save_json_to_file_replaces_atomically_and_compactly) {
+  std::filesystem::path dir = "output/test_durable_writer/atomic";
+  std::filesystem::remove_all(dir);
+  std::string path = (dir / "state.json").string();
+
+  ASSERT_TRUE(server::FileStorage::save_json_to_file(
+      path, nlohmann::json{{"round", 1}}));
+  ASSERT_TRUE(server::FileStorage::save_json_to_file(
+      path, nlohmann::json{{"round", 2}}, -1, true));
+
+  ASSERT_STREQ(server::FileStorage::load_string_from_file(path),
+               std::string("{\"round\":2}"));
+  ASSERT_EQ(static_cast<size_t>(0), count_temp_files(dir));
+}
+
+SERVER_TEST(durable_writer_group_commits_concurrent_writes) {
+  std::filesystem::path dir = "output/test_durable_writer/group";
+  std::filesystem::remove_all(dir);
+
+  server::DurableWriter writer;
+  const int threads = 4;
+  const int per_thread = 25;
+  std::vector<std::future<bool>> results[threads];
+  std::vector<std::thread> producers;
+  for (int t = 0; t < threads; ++t) {
+    producers.emplace_back([&writer, &results, &dir, t] {
+      for (int i = 0; i < per_thread; ++i) {
+        std::string name =
+            "result_" + std::to_string(t) + "_" + std::to_string(i) + ".json";
+        results[t].push_back(writer.write_json(
+            (dir / name).string(), nlohmann::json{{"t", t}, {"i", i}}));
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  for (auto &per_producer : results) {
+    for (auto &result : per_producer) {
+      ASSERT_TRUE(result.get());
+    }
+  }
+
+  nlohmann::json loaded = server::FileStorage::load_json_from_file(
+      (dir / "result_3_24.json").string());
+  ASSERT_EQ(3, loaded["t"].get<int>());
+  ASSERT_EQ(24, loaded["i"].get<int>());
+  ASSERT_EQ(static_cast<size_t>(threads * per_thread),
+            server::FileStorage::count_files_in_directory(dir.string()));
+  ASSERT_EQ(static_cast<size_t>(0), count_temp_files(dir));
+
+  server::DurableWriteStats stats = writer.stats();
+  ASSERT_EQ(static_cast<uint64_t>(threads * per_thread), stats.writes);
+  ASSERT_EQ(static_cast<uint64_t>(0), stats.failures);
+  ASSERT_TRUE(stats.batches >= 1 && stats.batches <= stats.writes);
+  ASSERT_TRUE(stats.max_latency_ms >= 0.0);
+}
+
+SERVER_TEST(durable_writer_keeps_the_newest_write_to_a_path) {
+  std::filesystem::path dir = "output/test_durable_writer/order";
+  std::filesystem::remove_all(dir);
+  std::string path = (dir / "latest.json").string();
+
+  server::DurableWriter writer;
+  for (int i = 0; i < 10; ++i) {
+    writer.write_json(path, nlohmann::json{{"version", i}});
+  }
+  writer.flush();
+  ASSERT_EQ(9, server::FileStorage::load_json_from_file(path)["version"]
+                   .get<int>());
+
+  // Writes after stop() still land, synchronously
+  writer.stop();
+  ASSERT_TRUE(writer.write_json(path, nlohmann::json{{"version", 10}}).get());
+  ASSERT_EQ(10, server::FileStorage::load_json_from_file(path)["version"]
+                    .get<int>());
+}
+
+SERVER_TEST(stores_sweep_temp_files_left_by_a_crash) {
+  std::filesystem::path dir = "output/test_durable_writer/stale";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  std::string state = (dir / "user.snapshot.json").string();
+  // A dead process's temp, and one this process could still be writing
+  std::ofstream(state + ".999999999.0.tmp") << "{";
+  std::string own = server::FileStorage::make_temp_path(state);
+  std::ofstream(own) << "{";
+
+  server::DurableWriter writer;
+  server::GameStateStore store(writer);
+  store.open(dir, 10);
+  ASSERT_EQ(static_cast<size_t>(1), count_temp_files(dir));
+  ASSERT_TRUE(std::filesystem::exists(own));
+}
@@ -0,0 +1,41 @@
+#include "../../query.h"
+#include "../test_framework.h"
+
+SERVER_TEST(entity_id_index_matches_where_id) {
+  afterhours::Entity &first = afterhours::EntityHelper::createEntity();
+  afterhours::Entity &second = afterhours::EntityHelper::createEntity();
+  afterhours::EntityID first_id = first.id;
+  afterhours::EntityID second_id = second.id;
+  afterhours::EntityHelper::merge_entity_arrays();
+
+  auto indexed = EQ::find_by_id(second_id);
+  auto scanned =
+      EQ({.ignore_temp_warning = true}).whereID(second_id).gen_first();
+  ASSERT_TRUE(indexed.has_value());
+  ASSERT_TRUE(scanned.has_value());
+  ASSERT_TRUE(&indexed.asE() == &scanned.asE());
+
+  // Entities created after the index was built are picked up on lookup
+  afterhours::Entity &third = afterhours::EntityHelper::createEntity();
+  afterhours::EntityID third_id = third.id;
+  afterhours::EntityHelper::merge_entity_arrays();
+  ASSERT_TRUE(EQ::find_by_id(third_id).has_value());
+
+  first.cleanup = true;
+  afterhours::EntityHelper::cleanup();
+  ASSERT_FALSE(EQ::find_by_id(first_id).has_value());
+  ASSERT_TRUE(EQ::find_by_id(third_id).has_value());
+
+  // Misses on ids the index has already seen don't rescan the entity list
+  EQ::EntityIdIndex &index = EQ::EntityIdIndex::get();
+  ASSERT_EQ(static_cast<size_t>(0), index.entries.count(first_id));
+  ASSERT_FALSE(EQ::find_by_id(third_id + 1000).has_value());
+  size_t scans = index.scans;
+  ASSERT_FALSE(EQ::find_by_id(first_id).has_value());
+  ASSERT_FALSE(EQ::find_by_id(third_id + 1000).has_value());
+  ASSERT_EQ(scans, index.scans);
+
+  EQ::find_by_id(second_id).asE().cleanup = true;
+  EQ::find_by_id(third_id).asE().cleanup = true;
+  afterhours::EntityHelper::cleanup();
+}
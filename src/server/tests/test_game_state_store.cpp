@@ -0,0 +1,131 @@
+#include "../../utils/game_state_checksum.h"
+#include "../durable_writer.h"
+#include "../file_storage.h"
+#include "../game_state_store.h"
+#include "../test_framework.h"
+#include <filesystem>
+#include <fstream>
+
+static nlohmann::json sample_game_state() {
+  return nlohmann::json{
+      {"userId", "player/1"},
+      {"gold", 10},
+      {"round", 3},
+      {"health", {{"current", 5}, {"max", 5}}},
+      {"inventory", nlohmann::json::array({{{"slot", 0}, {"type", "Pho"}}})}};
+}
+
+SERVER_TEST(game_state_delta_matches_full_checksum) {
+  std::filesystem::path dir = "output/test_game_state_store/delta";
+  std::filesystem::remove_all(dir);
+
+  server::DurableWriter writer;
+  server::GameStateStore store(writer);
+  store.open(dir, 20);
+
+  nlohmann::json base = sample_game_state();
+  auto saved = store.save_full("player/1", base);
+  ASSERT_TRUE(saved.status == server::GameStateStore::Status::Saved);
+  ASSERT_STREQ(saved.checksum, compute_game_state_checksum(base));
+
+  nlohmann::json next = base;
+  next["gold"] = 7;
+  next["inventory"].push_back({{"slot", 1}, {"type", "Ramen"}});
+  next.erase("round");
+  auto delta = store.apply_delta("player/1", saved.checksum,
+                                 nlohmann::json::diff(base, next));
+  ASSERT_TRUE(delta.status == server::GameStateStore::Status::Saved);
+  ASSERT_EQ(static_cast<uint64_t>(2), delta.version);
+  ASSERT_STREQ(delta.checksum, compute_game_state_checksum(next));
+  ASSERT_EQ(next.dump(), store.get("player/1")->state.dump());
+
+  // The member order of a state doesn't change its checksum
+  nlohmann::json reordered = nlohmann::json::object();
+  reordered["inventory"] = next["inventory"];
+  reordered["userId"] = next["userId"];
+  reordered["health"] = next["health"];
+  reordered["gold"] = next["gold"];
+  ASSERT_STREQ(compute_game_state_checksum(reordered), delta.checksum);
+}
+
+SERVER_TEST(game_state_delta_rejects_stale_base_and_bad_patch) {
+  std::filesystem::path dir = "output/test_game_state_store/conflict";
+  std::filesystem::remove_all(dir);
+
+  server::DurableWriter writer;
+  server::GameStateStore store(writer);
+  store.open(dir, 20);
+
+  nlohmann::json patch = nlohmann::json::array(
+      {{{"op", "replace"}, {"path", "/gold"}, {"value", 1}}});
+  auto missing = store.apply_delta("player/1", "0", patch);
+  ASSERT_TRUE(missing.status == server::GameStateStore::Status::NotFound);
+
+  auto saved = store.save_full("player/1", sample_game_state());
+  auto stale = store.apply_delta("player/1", "0000000000000000", patch);
+  ASSERT_TRUE(stale.status == server::GameStateStore::Status::BaseMismatch);
+  ASSERT_STREQ(stale.checksum, saved.checksum);
+
+  // The first op applies before the second fails; both are rolled back
+  nlohmann::json bad = nlohmann::json::array(
+      {{{"op", "replace"}, {"path", "/gold"}, {"value", 99}},
+       {{"op", "remove"}, {"path", "/missing/field"}}});
+  auto invalid = store.apply_delta("player/1", saved.checksum, bad);
+  ASSERT_TRUE(invalid.status == server::GameStateStore::Status::InvalidPatch);
+  ASSERT_EQ(10, store.get("player/1")->state["gold"].get<int>());
+  ASSERT_STREQ(store.get("player/1")->checksum, saved.checksum);
+  ASSERT_EQ(static_cast<uint64_t>(1), store.get("player/1")->version);
+}
+
+SERVER_TEST(game_state_store_replays_snapshot_and_deltas) {
+  std::filesystem::path dir = "output/test_game_state_store/replay";
+  std::filesystem::remove_all(dir);
+
+  server::DurableWriter writer;
+  server::GameStateStore store(writer);
+  store.open(dir, 3);
+
+  nlohmann::json state = sample_game_state();
+  std::string checksum = store.save_full("player/1", state).checksum;
+  for (int gold = 11; gold < 16; ++gold) {
+    nlohmann::json next = state;
+    next["gold"] = gold;
+    checksum = store
+                   .apply_delta("player/1", checksum,
+                                nlohmann::json::diff(state, next))
+                   .checksum;
+    state = next;
+  }
+  writer.flush();
+
+  // Five deltas with a snapshot every three leave two in the log
+  std::ifstream log_file(dir / (server::GameStateStore::file_stem("player/1") +
+                                ".deltas.log"));
+  int lines = 0;
+  for (std::string line; std::getline(log_file, line);) {
+    lines++;
+  }
+  ASSERT_EQ(2, lines);
+
+  server::GameStateStore reopened(writer);
+  reopened.open(dir, 3);
+  auto entry = reopened.get("player/1");
+  ASSERT_TRUE(entry.has_value());
+  ASSERT_EQ(static_cast<uint64_t>(6), entry->version);
+  ASSERT_EQ(15, entry->state["gold"].get<int>());
+  ASSERT_STREQ(entry->checksum, checksum);
+}
+
+SERVER_TEST(durable_writer_appends_after_replace_in_order) {
+  std::string path = "output/test_game_state_store/ordered.log";
+  std::filesystem::remove(path);
+
+  server::DurableWriter writer;
+  writer.append(path, "old\n");
+  // Emptying the file must not swallow the append queued after it
+  writer.write(path, "");
+  std::future<bool> appended = writer.append(path, "new\n");
+  ASSERT_TRUE(appended.get());
+  ASSERT_STREQ(server::FileStorage::load_string_from_file(path),
+               std::string("new"));
+}
@@ -0,0 +1,67 @@
+#include "../../http_worker.h"
+#include "../test_framework.h"
+#include <chrono>
+#include <httplib.h>
+#include <thread>
+
+static std::optional<HttpResponse> wait_for(HttpWorker &worker,
+                                            HttpTicket ticket,
+                                            std::chrono::milliseconds limit) {
+  auto deadline = std::chrono::steady_clock::now() + limit;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (auto res = worker.poll(ticket)) {
+      return res;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return std::nullopt;
+}
+
+SERVER_TEST(http_worker_delivers_responses_without_blocking) {
+  httplib::Server server;
+  server.Get("/fast", [](const httplib::Request &, httplib::Response &res) {
+    res.set_content("ok", "text/plain");
+  });
+  server.Get("/slow", [](const httplib::Request &, httplib::Response &res) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    res.set_content("late", "text/plain");
+  });
+  int port = server.bind_to_any_port("127.0.0.1");
+  std::thread listener([&server] { server.listen_after_bind(); });
+  server.wait_until_ready();
+
+  HttpWorker worker;
+  HttpRequest slow;
+  slow.host = "127.0.0.1";
+  slow.port = port;
+  slow.path = "/slow";
+
+  auto submit_start = std::chrono::steady_clock::now();
+  HttpTicket slow_ticket = worker.submit(slow);
+  ASSERT_TRUE(std::chrono::steady_clock::now() - submit_start <
+              std::chrono::milliseconds(100));
+  ASSERT_FALSE(worker.poll(slow_ticket).has_value());
+
+  HttpRequest fast = slow;
+  fast.path = "/fast";
+  auto fast_res =
+      wait_for(worker, worker.submit(fast), std::chrono::seconds(5));
+  ASSERT_TRUE(fast_res.has_value());
+  ASSERT_TRUE(fast_res->connected);
+  ASSERT_EQ(200, fast_res->status);
+  ASSERT_STREQ(std::string("ok"), fast_res->body);
+
+  worker.cancel(slow_ticket);
+  ASSERT_FALSE(worker.is_pending(slow_ticket));
+  ASSERT_FALSE(
+      wait_for(worker, slow_ticket, std::chrono::milliseconds(500))
+          .has_value());
+
+  server.stop();
+  listener.join();
+
+  auto refused = wait_for(worker, worker.submit(fast), std::chrono::seconds(5));
+  ASSERT_TRUE(refused.has_value());
+  ASSERT_FALSE(refused->connected);
+  worker.stop();
+}
@@ -0,0 +1,110 @@
+#include "../../log.h"
+#include "../test_framework.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+static void reset_category(LogCategory category) {
+  log_set_level(category, LogLevel::LOG_ALOG_);
+  log_set_sampling(category, 1);
+  log_set_rate_limit(category, 0);
+  log_category_state(category).suppressed.store(0);
+}
+
+SERVER_TEST(log_categories_parse_levels_and_options) {
+  ASSERT_TRUE(log_configure_categories("COMBAT=WARN,EFFECT=INFO:sample=4"));
+  ASSERT_FALSE(log_category_enabled(LogCategory::COMBAT, LogLevel::LOG_INFO));
+  ASSERT_TRUE(log_category_enabled(LogCategory::COMBAT, LogLevel::LOG_WARN));
+  ASSERT_TRUE(log_category_enabled(LogCategory::EFFECT, LogLevel::LOG_INFO));
+  ASSERT_FALSE(log_category_enabled(LogCategory::EFFECT, LogLevel::LOG_TRACE));
+  ASSERT_EQ(4u, log_category_state(LogCategory::EFFECT).sample_every.load());
+
+  ASSERT_TRUE(log_configure_categories("COMBAT=LOG_INFO:rate=3"));
+  ASSERT_TRUE(log_category_enabled(LogCategory::COMBAT, LogLevel::LOG_INFO));
+  ASSERT_EQ(3u, log_category_state(LogCategory::COMBAT).max_per_second.load());
+
+  ASSERT_FALSE(log_configure_categories("NOT_A_CATEGORY=INFO"));
+  ASSERT_FALSE(log_configure_categories("COMBAT=LOUD"));
+  ASSERT_FALSE(log_configure_categories("COMBAT=INFO:every=2"));
+
+  reset_category(LogCategory::COMBAT);
+  reset_category(LogCategory::EFFECT);
+}
+
+SERVER_TEST(log_sampling_keeps_one_in_n_and_counts_the_rest) {
+  log_set_sampling(LogCategory::EFFECT, 5);
+  int admitted = 0;
+  for (int i = 0; i < 20; ++i) {
+    if (log_category_admit(LogCategory::EFFECT, LogLevel::LOG_INFO)) {
+      ++admitted;
+    }
+  }
+  ASSERT_EQ(4, admitted);
+  ASSERT_EQ(static_cast<uint64_t>(16),
+            log_category_state(LogCategory::EFFECT).suppressed.load());
+
+  // Warnings bypass sampling
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(log_category_admit(LogCategory::EFFECT, LogLevel::LOG_WARN));
+  }
+  reset_category(LogCategory::EFFECT);
+}
+
+SERVER_TEST(log_rate_limit_caps_messages_per_second) {
+  log_set_rate_limit(LogCategory::COMBAT, 10);
+  int admitted = 0;
+  for (int i = 0; i < 100; ++i) {
+    if (log_category_admit(LogCategory::COMBAT, LogLevel::LOG_INFO)) {
+      ++admitted;
+    }
+  }
+  // The loop may straddle a second boundary and open a second window
+  ASSERT_TRUE(admitted >= 10 && admitted <= 20);
+  ASSERT_TRUE(log_category_admit(LogCategory::COMBAT, LogLevel::LOG_WARN));
+  reset_category(LogCategory::COMBAT);
+}
+
+SERVER_TEST(log_ring_buffer_delivers_every_item_across_threads) {
+  LogRingBuffer<std::string, 64> ring;
+  std::string out;
+  ASSERT_FALSE(ring.try_pop(out));
+
+  for (int i = 0; i < 64; ++i) {
+    ASSERT_TRUE(ring.try_push(std::to_string(i)));
+  }
+  ASSERT_FALSE(ring.try_push("overflow"));
+  for (int i = 0; i < 64; ++i) {
+    ASSERT_TRUE(ring.try_pop(out));
+    ASSERT_STREQ(out, std::to_string(i));
+  }
+
+  const int per_producer = 2000;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < 4; ++p) {
+    producers.emplace_back([&ring, p] {
+      for (int i = 0; i < per_producer; ++i) {
+        std::string line = std::to_string(p * per_producer + i);
+        while (!ring.try_push(std::move(line))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<bool> seen(4 * per_producer, false);
+  int received = 0;
+  while (received < 4 * per_producer) {
+    if (ring.try_pop(out)) {
+      seen[static_cast<size_t>(std::stoi(out))] = true;
+      ++received;
+    }
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+
+  for (bool got : seen) {
+    ASSERT_TRUE(got);
+  }
+  ASSERT_FALSE(ring.try_pop(out));
+}
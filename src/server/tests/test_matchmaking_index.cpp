@@ -0,0 +1,91 @@
+#include "../async/components/team_pool.h"
+#include "../async/matchmaking_index.h"
+#include "../test_framework.h"
+#include <cstdlib>
+
+static afterhours::EntityID add_pool_team(const std::string &team_id,
+                                          const std::string &user_id,
+                                          int round, int tier) {
+  auto &entity = afterhours::EntityHelper::createEntity();
+  entity.addComponent<server::async::TeamPoolEntry>(
+      team_id, user_id, round, tier, nlohmann::json::object(), 0);
+  server::async::MatchmakingIndex::get().add(entity.id, user_id, round, tier);
+  return entity.id;
+}
+
+static void cleanup_pool_teams() {
+  for (auto &ref : afterhours::EntityQuery({.force_merge = true})
+                       .whereHasComponent<server::async::TeamPoolEntry>()
+                       .gen()) {
+    ref.get().cleanup = true;
+  }
+  afterhours::EntityHelper::cleanup();
+  server::async::MatchmakingIndex::get().clear();
+}
+
+SERVER_TEST(matchmaking_index_respects_match_window) {
+  server::async::MatchmakingIndex &index =
+      server::async::MatchmakingIndex::get();
+  index.clear();
+
+  for (int round = 1; round <= 10; ++round) {
+    for (int tier = 1; tier <= 5; ++tier) {
+      add_pool_team("team_" + std::to_string(round) + "_" +
+                        std::to_string(tier),
+                    "other_user", round, tier);
+      add_pool_team("own_" + std::to_string(round) + "_" +
+                        std::to_string(tier),
+                    "me", round, tier);
+    }
+  }
+  ASSERT_EQ(static_cast<size_t>(100), index.size());
+
+  SeededRng rng;
+  rng.set_seed(42);
+  for (int i = 0; i < 200; ++i) {
+    auto opponent = index.find_opponent("me", 5, 3, rng);
+    ASSERT_TRUE(opponent.has_value());
+    const auto &entry =
+        opponent.asE().get<server::async::TeamPoolEntry>();
+    ASSERT_STREQ("other_user", entry.userId);
+    ASSERT_TRUE(std::abs(entry.round - 5) <= 2);
+    ASSERT_TRUE(std::abs(entry.shopTier - 3) <= 1);
+  }
+
+  ASSERT_FALSE(index.find_opponent("me", 40, 3, rng).has_value());
+
+  cleanup_pool_teams();
+}
+
+SERVER_TEST(matchmaking_index_finds_user_entries_and_drops_stale_ids) {
+  server::async::MatchmakingIndex &index =
+      server::async::MatchmakingIndex::get();
+  index.clear();
+
+  afterhours::EntityID first = add_pool_team("a", "alice", 1, 1);
+  add_pool_team("b", "alice", 2, 1);
+  add_pool_team("c", "bob", 1, 1);
+
+  auto oldest = index.find_for_user("alice");
+  ASSERT_TRUE(oldest.has_value());
+  ASSERT_EQ(first, oldest.asE().id);
+
+  std::string team_b = "b";
+  auto by_team = index.find_for_user("alice", &team_b);
+  ASSERT_TRUE(by_team.has_value());
+  ASSERT_STREQ("b", by_team.asE().get<server::async::TeamPoolEntry>().teamId);
+
+  oldest.asE().cleanup = true;
+  afterhours::EntityHelper::cleanup();
+
+  SeededRng rng;
+  for (int i = 0; i < 20; ++i) {
+    auto opponent = index.find_opponent("bob", 1, 1, rng);
+    ASSERT_TRUE(opponent.has_value());
+    ASSERT_STREQ("b",
+                 opponent.asE().get<server::async::TeamPoolEntry>().teamId);
+  }
+  ASSERT_EQ(static_cast<size_t>(2), index.size());
+
+  cleanup_pool_teams();
+}
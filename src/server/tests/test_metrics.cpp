@@ -0,0 +1,45 @@
+#include "../metrics.h"
+#include "../test_framework.h"
+#include <string>
+
+SERVER_TEST(metric_histogram_renders_cumulative_buckets) {
+  server::MetricHistogram histogram({1.0, 5.0});
+  histogram.observe(0.5);
+  histogram.observe(1.0);
+  histogram.observe(3.0);
+  histogram.observe(9.0);
+  ASSERT_EQ(static_cast<uint64_t>(4), histogram.count());
+  ASSERT_TRUE(histogram.sum() == 13.5);
+
+  std::string out;
+  histogram.render(out, "test_seconds", "route=\"/x\"");
+  ASSERT_TRUE(out.find("test_seconds_bucket{route=\"/x\",le=\"1\"} 2\n") !=
+              std::string::npos);
+  ASSERT_TRUE(out.find("test_seconds_bucket{route=\"/x\",le=\"5\"} 3\n") !=
+              std::string::npos);
+  ASSERT_TRUE(out.find("test_seconds_bucket{route=\"/x\",le=\"+Inf\"} 4\n") !=
+              std::string::npos);
+  ASSERT_TRUE(out.find("test_seconds_sum{route=\"/x\"} 13.5\n") !=
+              std::string::npos);
+  ASSERT_TRUE(out.find("test_seconds_count{route=\"/x\"} 4\n") !=
+              std::string::npos);
+}
+
+SERVER_TEST(metrics_render_requests_and_gauges) {
+  server::Metrics &metrics = server::Metrics::get();
+  uint64_t before =
+      metrics
+          .requests[static_cast<size_t>(server::Metrics::Route::Battle)][3]
+          .get();
+  metrics.observe_request(server::Metrics::Route::Battle, 408, 0.02, 64);
+
+  std::string out = metrics.render({{"test_gauge", "A test gauge.", 3.0}});
+  std::string expected = "battle_server_requests_total{route=\"/battle\","
+                         "code=\"4xx\"} " +
+                         std::to_string(before + 1) + "\n";
+  ASSERT_TRUE(out.find(expected) != std::string::npos);
+  ASSERT_TRUE(out.find("# TYPE battle_server_request_seconds histogram\n") !=
+              std::string::npos);
+  ASSERT_TRUE(out.find("# TYPE test_gauge gauge\ntest_gauge 3\n") !=
+              std::string::npos);
+}
@@ -0,0 +1,74 @@
+#include "../file_storage.h"
+#include "../opponent_catalog.h"
+#include "../test_framework.h"
+#include <filesystem>
+
+static nlohmann::json catalog_team(const std::string &dish) {
+  return nlohmann::json{
+      {"team", nlohmann::json::array({{{"slot", 0}, {"dishType", dish}}})}};
+}
+
+SERVER_TEST(opponent_catalog_refreshes_incrementally) {
+  std::filesystem::path dir = "output/test_opponent_catalog";
+  std::filesystem::remove_all(dir);
+  server::FileStorage::ensure_directory_exists(dir.string());
+
+  server::FileStorage::save_json_to_file((dir / "alpha.json").string(),
+                                         catalog_team("Potato"));
+  server::FileStorage::save_json_to_file((dir / "beta.json").string(),
+                                         catalog_team("Salmon"));
+  server::FileStorage::save_json_to_file((dir / "broken.json").string(),
+                                         nlohmann::json{{"team", 5}});
+
+  server::OpponentCatalog catalog;
+  ASSERT_TRUE(catalog.refresh(dir));
+  ASSERT_EQ(static_cast<size_t>(2), catalog.size());
+  ASSERT_FALSE(catalog.refresh(dir));
+
+  auto picked = catalog.pick_random();
+  ASSERT_TRUE(picked != nullptr);
+  ASSERT_TRUE(picked->id == "alpha" || picked->id == "beta");
+
+  std::filesystem::path beta = dir / "beta.json";
+  server::FileStorage::save_json_to_file(beta.string(),
+                                         catalog_team("Bagel"));
+  std::filesystem::last_write_time(
+      beta, std::filesystem::last_write_time(beta) + std::chrono::seconds(5));
+  ASSERT_TRUE(catalog.refresh(dir));
+  for (int i = 0; i < 20; ++i) {
+    auto entry = catalog.pick_random();
+    if (entry->id == "beta") {
+      ASSERT_STREQ("Bagel",
+                   entry->team["team"][0]["dishType"].get<std::string>());
+    }
+  }
+
+  std::filesystem::remove(dir / "alpha.json");
+  ASSERT_TRUE(catalog.refresh(dir));
+  ASSERT_EQ(static_cast<size_t>(1), catalog.size());
+
+  std::filesystem::remove_all(dir);
+}
+
+SERVER_TEST(opponent_catalog_finds_entries_by_id) {
+  std::filesystem::path dir = "output/test_opponent_catalog_lookup";
+  std::filesystem::remove_all(dir);
+  server::FileStorage::ensure_directory_exists(dir.string());
+
+  server::FileStorage::save_json_to_file((dir / "alpha.json").string(),
+                                         catalog_team("Potato"));
+  server::FileStorage::save_json_to_file((dir / "beta.json").string(),
+                                         catalog_team("Salmon"));
+
+  server::OpponentCatalog catalog;
+  ASSERT_TRUE(catalog.refresh(dir));
+  ASSERT_EQ(static_cast<size_t>(2), catalog.all().size());
+
+  auto beta = catalog.find("beta");
+  ASSERT_TRUE(beta != nullptr);
+  ASSERT_STREQ(beta->team["team"][0]["dishType"].get<std::string>(),
+               std::string("Salmon"));
+  ASSERT_TRUE(catalog.find("gamma") == nullptr);
+
+  std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,173 @@
+#include "../durable_writer.h"
+#include "../result_store.h"
+#include "../test_framework.h"
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <thread>
+
+static nlohmann::json stored_result(const std::string &player_team,
+                                    int seed) {
+  return nlohmann::json{{"seed", seed},
+                        {"playerTeamId", player_team},
+                        {"outcomes", nlohmann::json::array()}};
+}
+
+SERVER_TEST(result_store_indexes_by_battle_team_and_time) {
+  std::filesystem::path dir = "output/test_result_store/index";
+  std::filesystem::remove_all(dir);
+
+  server::DurableWriter writer;
+  server::ResultStore store(writer);
+  store.open(dir, server::ResultRetention{});
+
+  store.append("1", stored_result("alpha", 1));
+  store.append("2", stored_result("beta", 2));
+  ASSERT_TRUE(store.append("3", stored_result("alpha", 3)).get());
+  ASSERT_EQ(static_cast<size_t>(3), store.size());
+
+  auto found = store.find("2");
+  ASSERT_TRUE(found.has_value());
+  ASSERT_EQ(2, (*found)["seed"].get<int>());
+  ASSERT_STREQ((*found)["battleId"].get<std::string>(), std::string("2"));
+  ASSERT_FALSE(store.find("missing").has_value());
+
+  std::vector<nlohmann::json> alpha = store.for_player_team("alpha", 10);
+  ASSERT_EQ(static_cast<size_t>(2), alpha.size());
+  ASSERT_EQ(3, alpha[0]["seed"].get<int>());
+  ASSERT_EQ(static_cast<size_t>(1), store.for_player_team("alpha", 1).size());
+
+  ASSERT_EQ(static_cast<size_t>(3), store.since(0, 10).size());
+
+  // A fresh store rebuilds the same index from the segments
+  server::ResultStore reopened(writer);
+  reopened.open(dir, server::ResultRetention{});
+  ASSERT_EQ(static_cast<size_t>(3), reopened.size());
+  ASSERT_EQ(3, (*reopened.find("3"))["seed"].get<int>());
+}
+
+SERVER_TEST(result_store_rotates_segments_and_drops_old_ones) {
+  std::filesystem::path dir = "output/test_result_store/retention";
+  std::filesystem::remove_all(dir);
+
+  server::ResultRetention retention;
+  retention.segment_bytes = 256;
+  retention.max_results = 4;
+
+  server::DurableWriter writer;
+  server::ResultStore store(writer);
+  store.open(dir, retention);
+  for (int i = 0; i < 20; ++i) {
+    store.append(std::to_string(i), stored_result("alpha", i));
+  }
+  writer.flush();
+
+  size_t segments = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+    (void)entry;
+    segments++;
+  }
+  ASSERT_TRUE(segments > 1);
+
+  size_t dropped = store.apply_retention();
+  ASSERT_TRUE(dropped > 0);
+  ASSERT_EQ(static_cast<size_t>(20), dropped + store.size());
+  ASSERT_TRUE(store.size() >= 4);
+  ASSERT_FALSE(store.find("0").has_value());
+  ASSERT_TRUE(store.find("19").has_value());
+  ASSERT_EQ(store.size(), store.for_player_team("alpha", 100).size());
+}
+
+SERVER_TEST(result_store_skips_a_torn_final_record) {
+  std::filesystem::path dir = "output/test_result_store/torn";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  {
+    std::ofstream segment(dir / server::ResultStore::segment_name(1));
+    segment << "{\"battleId\":\"1\",\"savedAt\":1}\n{\"battleId\":\"2\",\"sa";
+  }
+
+  server::DurableWriter writer;
+  server::ResultStore store(writer);
+  store.open(dir, server::ResultRetention{});
+  ASSERT_EQ(static_cast<size_t>(1), store.size());
+
+  store.append("3", stored_result("alpha", 3));
+  ASSERT_TRUE(store.find("3").has_value());
+  ASSERT_TRUE(std::filesystem::exists(
+      dir / server::ResultStore::segment_name(2)));
+}
+
+SERVER_TEST(result_store_rolls_past_a_failed_append) {
+  std::filesystem::path dir = "output/test_result_store/failed";
+  std::filesystem::remove_all(dir);
+  // A directory where the first segment should be makes its append fail
+  std::filesystem::create_directories(
+      dir / server::ResultStore::segment_name(1));
+
+  server::DurableWriter writer;
+  server::ResultStore store(writer);
+  store.open(dir, server::ResultRetention{});
+
+  ASSERT_FALSE(store.append("1", stored_result("alpha", 1)).get());
+  ASSERT_EQ(static_cast<size_t>(0), store.size());
+  ASSERT_TRUE(store.append("2", stored_result("alpha", 2)).get());
+  ASSERT_EQ(static_cast<size_t>(1), store.size());
+  ASSERT_FALSE(store.find("1").has_value());
+
+  std::filesystem::path segment = dir / server::ResultStore::segment_name(2);
+  ASSERT_TRUE(std::filesystem::exists(segment));
+
+  // Shifted offsets are found again on line boundaries
+  std::string contents;
+  {
+    std::ifstream file(segment, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream file(segment, std::ios::binary | std::ios::trunc);
+    file << "{\"partial\":" << "\n" << contents;
+  }
+  auto found = store.find("2");
+  ASSERT_TRUE(found.has_value());
+  ASSERT_EQ(2, (*found)["seed"].get<int>());
+}
+
+SERVER_TEST(result_store_keeps_segments_with_queued_appends) {
+  std::filesystem::path dir = "output/test_result_store/queued";
+  std::filesystem::remove_all(dir);
+
+  // Two results per segment
+  server::ResultRetention retention;
+  retention.segment_bytes = 256;
+  retention.max_age = std::chrono::seconds(1);
+
+  server::DurableWriter writer;
+  server::ResultStore store(writer);
+  store.open(dir, retention);
+  for (int i = 0; i < 5; ++i) {
+    store.append(std::to_string(i), stored_result("alpha", i));
+  }
+  writer.flush();
+
+  // Holds the commit thread so the next appends stay queued
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  writer.append((dir / "blocker.log").string(), "\n",
+                [released](bool) { released.wait(); });
+  std::future<bool> fifth = store.append("5", stored_result("alpha", 5));
+  std::future<bool> sixth = store.append("6", stored_result("alpha", 6));
+
+  // Everything committed is now too old, but "4" shares its segment with
+  // the queued "5", so that segment stays
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  store.apply_retention();
+  release.set_value();
+  ASSERT_TRUE(fifth.get());
+  ASSERT_TRUE(sixth.get());
+  ASSERT_TRUE(store.find("4").has_value());
+  ASSERT_TRUE(store.find("5").has_value());
+  ASSERT_FALSE(store.find("0").has_value());
+}
@@ -0,0 +1,126 @@
+#include "../../utils/system_profiler.h"
+#include "../test_framework.h"
+#include <string>
+#include <thread>
+
+SERVER_TEST(system_profiler_totals_frame_phases) {
+  SystemProfiler &profiler = SystemProfiler::get();
+  profiler.reset();
+  profiler.set_enabled(true);
+  uint32_t slot = profiler.register_system("test::TimedSystem");
+  ASSERT_EQ(slot, profiler.register_system("test::TimedSystem"));
+
+  profiler.begin_frame();
+  profiler.record_should_run(slot, 100, 110, true);
+  profiler.record_once(slot, 110, 130);
+  profiler.record_entity(slot);
+  profiler.record_entity(slot);
+  profiler.record_after(slot, 200, 205);
+  profiler.end_frame();
+
+  nlohmann::json summary = profiler.drain_summary();
+  profiler.set_enabled(false);
+  bool found = false;
+  for (const auto &item : summary) {
+    if (item["name"] != "test::TimedSystem") {
+      continue;
+    }
+    found = true;
+    ASSERT_EQ(uint64_t{1}, item["runs"].get<uint64_t>());
+    ASSERT_EQ(uint64_t{10}, item["shouldRunNs"].get<uint64_t>());
+    ASSERT_EQ(uint64_t{20}, item["onceNs"].get<uint64_t>());
+    ASSERT_EQ(uint64_t{70}, item["forEachNs"].get<uint64_t>());
+    ASSERT_EQ(uint64_t{5}, item["afterNs"].get<uint64_t>());
+    ASSERT_EQ(uint64_t{105}, item["totalNs"].get<uint64_t>());
+    ASSERT_EQ(uint64_t{2}, item["entities"].get<uint64_t>());
+  }
+  ASSERT_TRUE(found);
+
+  // Draining clears the local totals
+  for (const auto &stats : profiler.stats()) {
+    if (stats.name == "test::TimedSystem") {
+      ASSERT_EQ(uint64_t{0}, stats.total_ns());
+    }
+  }
+}
+
+SERVER_TEST(system_profiler_merges_worker_summaries) {
+  SystemProfiler &profiler = SystemProfiler::get();
+  profiler.reset();
+  nlohmann::json worker = nlohmann::json::array(
+      {{{"name", "test::WorkerSystem"}, {"runs", 3}, {"onceNs", 40}}});
+  profiler.merge(worker);
+  profiler.merge(worker);
+
+  bool found = false;
+  for (const auto &stats : profiler.stats()) {
+    if (stats.name == "test::WorkerSystem") {
+      found = true;
+      ASSERT_EQ(uint64_t{6}, stats.runs);
+      ASSERT_EQ(uint64_t{80}, stats.total_ns());
+    }
+  }
+  ASSERT_TRUE(found);
+  profiler.reset();
+}
+
+SERVER_TEST(system_profiler_exports_chrome_trace) {
+  SystemProfiler &profiler = SystemProfiler::get();
+  profiler.reset();
+  profiler.set_enabled(true);
+  uint32_t slot = profiler.register_system("test::TracedSystem");
+  profiler.begin_frame();
+  profiler.record_should_run(slot, 1000, 2000, true);
+  profiler.end_frame();
+  profiler.set_enabled(false);
+
+  nlohmann::json trace = profiler.chrome_trace();
+  ASSERT_TRUE(trace["traceEvents"].is_array());
+  bool frame = false;
+  bool system = false;
+  for (const auto &event : trace["traceEvents"]) {
+    if (event["ph"] != "X") {
+      continue;
+    }
+    frame = frame || event["name"] == "frame";
+    if (event["name"] == "test::TracedSystem") {
+      system = true;
+      ASSERT_TRUE(event["ts"].get<double>() == 1.0);
+      ASSERT_TRUE(event["dur"].get<double>() == 1.0);
+    }
+  }
+  ASSERT_TRUE(frame);
+  ASSERT_TRUE(system);
+  profiler.reset();
+}
+
+SERVER_TEST(system_profiler_records_while_systems_register) {
+  SystemProfiler &profiler = SystemProfiler::get();
+  profiler.reset();
+  profiler.set_enabled(true);
+  uint32_t slot = profiler.register_system("test::BusySystem");
+
+  // Another simulator's systems registering mid-frame leave this slot alone
+  std::thread registrar([&profiler] {
+    for (int i = 0; i < 100; ++i) {
+      profiler.register_system("test::LateSystem" + std::to_string(i));
+    }
+  });
+  for (int frame = 0; frame < 200; ++frame) {
+    profiler.begin_frame();
+    profiler.record_should_run(slot, 0, 1, true);
+    profiler.record_entity(slot);
+    profiler.end_frame();
+  }
+  registrar.join();
+
+  uint64_t entities = 0;
+  for (const auto &stats : profiler.stats()) {
+    if (stats.name == "test::BusySystem") {
+      entities = stats.entities;
+    }
+  }
+  profiler.set_enabled(false);
+  ASSERT_EQ(uint64_t{200}, entities);
+  profiler.reset();
+}
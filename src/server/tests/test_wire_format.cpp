@@ -0,0 +1,116 @@
+#include "../../utils/wire_format.h"
+#include "../battle_world.h"
+#include "../test_framework.h"
+#include "battle_world_fixture.h"
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+SERVER_TEST(wire_format_negotiates_encodings) {
+  using wire_format::Encoding;
+  ASSERT_TRUE(wire_format::from_media_type("application/json; charset=utf-8") ==
+              Encoding::Json);
+  ASSERT_TRUE(wire_format::from_media_type("application/cbor") ==
+              Encoding::Cbor);
+  ASSERT_TRUE(wire_format::from_media_type("application/x-msgpack") ==
+              Encoding::MsgPack);
+  ASSERT_FALSE(wire_format::from_media_type("text/plain").has_value());
+
+  ASSERT_TRUE(wire_format::from_accept("", Encoding::Cbor) == Encoding::Cbor);
+  ASSERT_TRUE(wire_format::from_accept("*/*", Encoding::Json) ==
+              Encoding::Json);
+  ASSERT_TRUE(wire_format::from_accept("text/html, application/msgpack;q=0.9",
+                                       Encoding::Json) == Encoding::MsgPack);
+}
+
+SERVER_TEST(wire_format_round_trips_battle_response) {
+  server::BattleWorldJob job = make_world_job(777);
+  job.json_events = true;
+
+  server::BattleWorldResult result = server::BattleWorld::simulate(job);
+  ASSERT_TRUE(result.status == server::BattleWorldResult::Status::Complete);
+
+  std::string json_body =
+      wire_format::encode(result.response, wire_format::Encoding::Json);
+  for (auto encoding :
+       {wire_format::Encoding::Cbor, wire_format::Encoding::MsgPack}) {
+    std::string body = wire_format::encode(result.response, encoding);
+    ASSERT_TRUE(body.size() < json_body.size());
+
+    nlohmann::json decoded =
+        wire_format::decode(body, wire_format::content_type(encoding));
+    ASSERT_EQ(result.response.dump(), decoded.dump());
+  }
+
+  nlohmann::json from_json =
+      wire_format::decode(json_body, std::string("application/json"));
+  ASSERT_EQ(result.response.dump(), from_json.dump());
+
+  bool threw = false;
+  try {
+    wire_format::decode(std::string("\xff\x00", 2),
+                        wire_format::Encoding::Cbor);
+  } catch (const nlohmann::json::exception &) {
+    threw = true;
+  }
+  ASSERT_TRUE(threw);
+}
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+SERVER_TEST(wire_format_gzips_large_binary_bodies_over_http) {
+  server::BattleWorldJob job = make_world_job(778);
+  job.json_events = true;
+  server::BattleWorldResult result = server::BattleWorld::simulate(job);
+  ASSERT_TRUE(result.status == server::BattleWorldResult::Status::Complete);
+
+  std::string small = wire_format::encode(nlohmann::json{{"seed", 1}},
+                                          wire_format::Encoding::Cbor);
+  ASSERT_FALSE(wire_format::gzip_if_large(small, wire_format::Encoding::Cbor));
+
+  // Echoes the (already inflated) request back the way set_body does
+  std::string request_encoding;
+  httplib::Server server;
+  server.Post("/echo", [&request_encoding](const httplib::Request &req,
+                                           httplib::Response &res) {
+    request_encoding = req.get_header_value("Content-Encoding");
+    std::string body = req.body;
+    if (wire_format::accepts_gzip(req.get_header_value("Accept-Encoding")) &&
+        wire_format::gzip_if_large(body, wire_format::Encoding::Cbor)) {
+      res.set_header("Content-Encoding", wire_format::kGzip);
+    }
+    res.set_content(body, wire_format::kCborType);
+  });
+  int port = server.bind_to_any_port("127.0.0.1");
+  std::thread listener([&server] { server.listen_after_bind(); });
+  server.wait_until_ready();
+
+  std::string body =
+      wire_format::encode(result.response, wire_format::Encoding::Cbor);
+  size_t plain_size = body.size();
+  ASSERT_TRUE(wire_format::gzip_if_large(body, wire_format::Encoding::Cbor));
+  ASSERT_TRUE(body.size() < plain_size);
+
+  // Keep the response compressed so the test sees what went over the wire
+  httplib::Client client("127.0.0.1", port);
+  client.set_decompress(false);
+  httplib::Headers headers = {{"Content-Encoding", wire_format::kGzip},
+                              {"Accept-Encoding", wire_format::kGzip}};
+  httplib::Result res =
+      client.Post("/echo", headers, body, wire_format::kCborType);
+  server.stop();
+  listener.join();
+
+  ASSERT_TRUE(static_cast<bool>(res));
+  ASSERT_EQ(200, res->status);
+  ASSERT_STREQ(std::string(wire_format::kGzip), request_encoding);
+  ASSERT_STREQ(std::string(wire_format::kGzip),
+               res->get_header_value("Content-Encoding"));
+  ASSERT_TRUE(res->body.size() < plain_size);
+
+  std::optional<std::string> inflated = wire_format::gunzip(res->body);
+  ASSERT_TRUE(inflated.has_value());
+  nlohmann::json decoded =
+      wire_format::decode(*inflated, wire_format::Encoding::Cbor);
+  ASSERT_EQ(result.response.dump(), decoded.dump());
+}
+#endif
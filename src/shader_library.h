@@ -65,6 +65,23 @@ struct ShaderLibrary {
     load_shader(type);
   }
 
+  // Stores a shader compiled elsewhere (AssetLoader compiles from source
+  // read on a worker thread)
+  void add(ShaderType type, raylib::Shader shader) {
+    shaders_by_type[type] = shader;
+
+    // Cache uniform locations for this shader
+    cache_uniform_locations(type, shader);
+  }
+
+  static std::string vertex_path() { return "resources/shaders/base.vs"; }
+
+  static std::string fragment_path(ShaderType type) {
+    // Use magic_enum to automatically convert enum name to filename
+    return "resources/shaders/" + std::string(magic_enum::enum_name(type)) +
+           ".fs";
+  }
+
   void unload_all() {
     shaders_by_type.clear();
     uniform_locations.clear();
@@ -72,19 +89,8 @@ struct ShaderLibrary {
 
 private:
   void load_shader(ShaderType type) {
-    // Use magic_enum to automatically convert enum name to filename
-    std::string enum_name = std::string(magic_enum::enum_name(type));
-    std::string frag_filename = enum_name + ".fs";
-
-    std::string vert_path = "resources/shaders/base.vs";
-    std::string frag_path = "resources/shaders/" + frag_filename;
-
-    raylib::Shader shader =
-        raylib::LoadShader(vert_path.c_str(), frag_path.c_str());
-    shaders_by_type[type] = shader;
-
-    // Cache uniform locations for this shader
-    cache_uniform_locations(type, shader);
+    add(type, raylib::LoadShader(vertex_path().c_str(),
+                                 fragment_path(type).c_str()));
   }
 
   void cache_uniform_locations(ShaderType type, const raylib::Shader &shader) {
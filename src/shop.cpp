@@ -227,7 +227,7 @@ Entity &make_continue_button_disabled_singleton(Entity &sophie) {
 Entity &make_shop_item(int slot, DishType type) {
   auto &e = EntityHelper::createEntity();
   auto position = calculate_slot_position(slot, SHOP_START_X, SHOP_START_Y);
-  auto dish_info = get_dish_info(type);
+  const auto &dish_info = get_dish_info(type);
 
   e.addComponent<Transform>(position, vec2{SLOT_SIZE, SLOT_SIZE});
   e.addComponent<IsDish>(type);
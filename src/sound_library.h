@@ -38,6 +38,8 @@ struct SoundLibrary {
   void load(const char *filename, const char *name) {
     impl.load(filename, name);
   }
+  // For sounds already decoded and created by AssetLoader
+  void add(const char *name, raylib::Sound sound) { impl.add(name, sound); }
 
   void play(SoundFile file) { play(sound_file_to_str(file)); }
   void play(const char *const name) { PlaySound(get(name)); }
@@ -104,25 +106,15 @@ private:
   } impl;
 };
 
-constexpr static void load_sounds() {
-  magic_enum::enum_for_each<SoundFile>([](auto val) {
-    constexpr SoundFile file = val;
-    std::string filename;
-    switch (file) {
-    case SoundFile::UI_Select:
-      filename = "gdc/doex_qantum_ui_ui_select_plastic_05_03.wav";
-      break;
-    case SoundFile::UI_Move:
-      filename = "gdc/"
-                 "inmotionaudio_cave_design_WATRDrip_SingleDrip03_"
-                 "InMotionAudio_CaveDesign.wav";
-      break;
-    default:
-      // Skip loading sounds that don't have files available
-      return;
-    }
-    SoundLibrary::get().load(
-        Files::get().fetch_resource_path("sounds", filename).c_str(),
-        sound_file_to_str(file));
-  });
+// Path under resources/sounds, or nullptr for sounds without a file yet
+constexpr static const char *sound_file_path(SoundFile sf) {
+  switch (sf) {
+  case SoundFile::UI_Select:
+    return "gdc/doex_qantum_ui_ui_select_plastic_05_03.wav";
+  case SoundFile::UI_Move:
+    return "gdc/"
+           "inmotionaudio_cave_design_WATRDrip_SingleDrip03_"
+           "InMotionAudio_CaveDesign.wav";
+  }
+  return nullptr;
 }
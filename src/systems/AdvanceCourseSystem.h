@@ -45,8 +45,8 @@ struct AdvanceCourseSystem : afterhours::System<CombatQueue> {
         log_info("COMBAT: Fired OnCourseComplete trigger for index 0");
       }
 
-      uint64_t fp = BattleFingerprint::compute();
-      log_info("AUDIT_FP checkpoint=course_{} hash={}", cq.current_index, fp);
+      BattleFingerprint::checkpoint("course_" +
+                                    std::to_string(cq.current_index));
 
       // Don't reorganize here - ResolveCombatTickSystem already did it when
       // dishes were defeated
@@ -242,6 +242,8 @@ struct BattleProcessorSystem : afterhours::System<BattleProcessor> {
           BattleProcessor::BattleInput input;
           input.playerJsonPath = request.playerJsonPath;
           input.opponentJsonPath = request.opponentJsonPath;
+          input.playerTeamJson = request.playerTeamJson;
+          input.opponentTeamJson = request.opponentTeamJson;
           input.seed = 1234567890; // TODO: Load from JSON
 
           log_info("BATTLE_PROCESSOR: About to call startBattle - "
@@ -282,6 +284,8 @@ struct BattleProcessorSystem : afterhours::System<BattleProcessor> {
           BattleProcessor::BattleInput input;
           input.playerJsonPath = request.playerJsonPath;
           input.opponentJsonPath = request.opponentJsonPath;
+          input.playerTeamJson = request.playerTeamJson;
+          input.opponentTeamJson = request.opponentTeamJson;
           input.seed = 1234567890; // TODO: Load from JSON
 
           processor.startBattle(input);
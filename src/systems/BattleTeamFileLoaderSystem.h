@@ -45,11 +45,15 @@ struct BattleTeamFileLoaderSystem : afterhours::System<BattleLoadRequest> {
       return;
     }
 
-    if (!request.playerJsonPath.empty()) {
+    if (!request.playerTeamJson.is_null()) {
+      load_team(request.playerTeamJson, true, manager_entity.get());
+    } else if (!request.playerJsonPath.empty()) {
       load_team_from_json(request.playerJsonPath, true, manager_entity.get());
     }
 
-    if (!request.opponentJsonPath.empty()) {
+    if (!request.opponentTeamJson.is_null()) {
+      load_team(request.opponentTeamJson, false, manager_entity.get());
+    } else if (!request.opponentJsonPath.empty()) {
       load_team_from_json(request.opponentJsonPath, false,
                           manager_entity.get());
     }
@@ -88,6 +92,11 @@ private:
       return;
     }
 
+    load_team(json, isPlayer, manager_entity);
+  }
+
+  void load_team(const nlohmann::json &json, bool isPlayer,
+                 afterhours::Entity &manager_entity) {
     if (!json.contains("team") || !json["team"].is_array()) {
       log_error("Invalid JSON format: missing or invalid 'team' array");
       return;
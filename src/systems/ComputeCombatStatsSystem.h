@@ -45,7 +45,7 @@ struct ComputeCombatStatsSystem : afterhours::System<IsDish, DishLevel> {
     }
 
     // Get base flavor stats
-    auto dish_info = get_dish_info(dish.type);
+    const auto &dish_info = get_dish_info(dish.type);
     FlavorStats flavor = dish_info.flavor;
 
     // Apply or convert deferred flavor modifications if present
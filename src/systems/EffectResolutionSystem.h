@@ -60,9 +60,7 @@ struct EffectResolutionSystem : afterhours::System<TriggerQueue> {
 
 private:
   void process_trigger_event(const TriggerEvent &ev) {
-    auto src_opt = EQ({.ignore_temp_warning = true})
-                       .whereID(ev.sourceEntityId)
-                       .gen_first();
+    auto src_opt = EQ::find_by_id(ev.sourceEntityId);
     if (!src_opt || !src_opt->has<IsDish>()) {
       return;
     }
@@ -109,9 +107,7 @@ private:
     // For CopyEffect, handle specially - it needs the source entity, not
     // targets
     if (effect.operation == EffectOperation::CopyEffect) {
-      auto src_opt = EQ({.ignore_temp_warning = true})
-                         .whereID(ev.sourceEntityId)
-                         .gen_first();
+      auto src_opt = EQ::find_by_id(ev.sourceEntityId);
       if (src_opt && src_opt->has<IsDish>()) {
         apply_to_target(*src_opt.value(), effect, ev);
       }
@@ -140,9 +136,7 @@ private:
     int previousEntityId = -1;
     int nextEntityId = -1;
 
-    auto src_opt = EQ({.ignore_temp_warning = true})
-                       .whereID(ev.sourceEntityId)
-                       .gen_first();
+    auto src_opt = EQ::find_by_id(ev.sourceEntityId);
     if (!src_opt || !src_opt->has<DishBattleState>()) {
       return;
     }
@@ -171,9 +165,7 @@ private:
       return true;
     }
 
-    auto src_opt = EQ({.ignore_temp_warning = true})
-                       .whereID(ev.sourceEntityId)
-                       .gen_first();
+    auto src_opt = EQ::find_by_id(ev.sourceEntityId);
     if (!src_opt || !src_opt->has<DishBattleState>()) {
       return false;
     }
@@ -273,9 +265,7 @@ private:
                                       const TriggerEvent &ev) {
     afterhours::RefEntities targets;
 
-    auto src_opt = EQ({.ignore_temp_warning = true})
-                       .whereID(ev.sourceEntityId)
-                       .gen_first();
+    auto src_opt = EQ::find_by_id(ev.sourceEntityId);
     if (!src_opt || !src_opt->has<DishBattleState>()) {
       return targets;
     }
@@ -705,7 +695,7 @@ private:
 
       // TODO id prefer to not have this and then just ignore it later on
       if (!render_backend::is_headless_mode) {
-        auto dish_info = get_dish_info(dish_to_summon);
+        const auto &dish_info = get_dish_info(dish_to_summon);
         const auto frame = afterhours::texture_manager::idx_to_sprite_frame(
             dish_info.sprite.i, dish_info.sprite.j);
         summoned_entity.addComponent<afterhours::texture_manager::HasSprite>(
@@ -98,6 +98,8 @@ public:
           existingBattleRequest.playerJsonPath = filename;
           existingBattleRequest.opponentJsonPath =
               "resources/battles/opponent_sample.json";
+          existingBattleRequest.playerTeamJson = nlohmann::json();
+          existingBattleRequest.opponentTeamJson = nlohmann::json();
           existingBattleRequest.loaded = false;
         }
       } else {
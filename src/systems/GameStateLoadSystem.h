@@ -27,6 +27,7 @@
 #include "../tooltip.h"
 #include "../utils/battle_fingerprint.h"
 #include "../utils/http_helpers.h"
+#include "../utils/wire_format.h"
 #include <afterhours/ah.h>
 #include <afterhours/src/plugins/texture_manager.h>
 #include <filesystem>
@@ -102,7 +103,15 @@ struct GameStateLoadSystem : afterhours::System<ContinueGameRequest> {
     gameState.erase("checksum");
 
     std::string computed_checksum = compute_game_state_checksum(gameState);
-    if (computed_checksum != local_checksum) {
+    std::string saved_version =
+        gameState.value("clientVersion", std::string(""));
+    if (saved_version != GAME_STATE_CLIENT_VERSION) {
+      // Same state, older checksum algorithm; adopt it under this version
+      log_info("GAME_STATE_LOAD: Save from client version {}, rehashing",
+               saved_version);
+      gameState["clientVersion"] = GAME_STATE_CLIENT_VERSION;
+      local_checksum = compute_game_state_checksum(gameState);
+    } else if (computed_checksum != local_checksum) {
       log_warn("GAME_STATE_LOAD: Local checksum mismatch, recomputing");
       local_checksum = computed_checksum;
     }
@@ -117,6 +126,7 @@ struct GameStateLoadSystem : afterhours::System<ContinueGameRequest> {
     if (!server_state.empty() && server_state.contains("gameState")) {
       log_info("GAME_STATE_LOAD: Server returned state, using server state");
       gameState = server_state["gameState"];
+      gameState["checksum"] = compute_game_state_checksum(gameState);
 
       std::ofstream out_file(save_file);
       if (out_file.is_open()) {
@@ -173,10 +183,12 @@ private:
 
       std::string path =
           "/game-state?userId=" + userId + "&checksum=" + checksum;
-      auto res = client.Get(path.c_str());
+      httplib::Headers headers = {{"Accept", wire_format::kCborType}};
+      auto res = client.Get(path.c_str(), headers);
 
       if (res && res->status == 200) {
-        return nlohmann::json::parse(res->body);
+        return wire_format::decode(res->body,
+                                   res->get_header_value("Content-Type"));
       }
     } catch (...) {
     }
@@ -265,7 +277,7 @@ private:
             dish_entity.addComponent<HasRenderOrder>(RenderOrder::ShopItems,
                                                      RenderScreen::Shop);
 
-            auto dish_info = get_dish_info(dish_type_opt.value());
+            const auto &dish_info = get_dish_info(dish_type_opt.value());
             const auto frame = afterhours::texture_manager::idx_to_sprite_frame(
                 dish_info.sprite.i, dish_info.sprite.j);
             dish_entity.addComponent<afterhours::texture_manager::HasSprite>(
@@ -322,7 +334,7 @@ private:
                                                      RenderScreen::Shop);
             add_dish_tags(dish_entity, dish_type);
 
-            auto dish_info = get_dish_info(dish_type);
+            const auto &dish_info = get_dish_info(dish_type);
             const auto frame = afterhours::texture_manager::idx_to_sprite_frame(
                 dish_info.sprite.i, dish_info.sprite.j);
             dish_entity.addComponent<afterhours::texture_manager::HasSprite>(
@@ -37,7 +37,7 @@ struct GenerateDishesGallery : afterhours::System<> {
     int tier_counts[6] = {0, 0, 0, 0, 0, 0};
     const auto &pool = get_default_dish_pool();
     for (auto dish : pool) {
-      auto info = get_dish_info(dish);
+      const auto &info = get_dish_info(dish);
       int t = std::clamp(info.tier, 1, 5);
       int index_in_tier = tier_counts[t]++;
       int row = t - 1;
@@ -103,7 +103,7 @@ private:
       e.addComponent<HasRenderOrder>(RenderOrder::ShopItems,
                                      RenderScreen::Shop);
 
-      DrinkInfo drink_info = get_drink_info(drink_type);
+      const DrinkInfo &drink_info = get_drink_info(drink_type);
       const auto frame = afterhours::texture_manager::idx_to_sprite_frame(
           drink_info.sprite.i, drink_info.sprite.j);
       e.addComponent<afterhours::texture_manager::HasSprite>(
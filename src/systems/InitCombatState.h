@@ -5,6 +5,7 @@
 #include "../components/combat_queue.h"
 #include "../components/dish_battle_state.h"
 #include "../components/pending_combat_mods.h"
+#include "../components/replay_snapshots.h"
 #include "../components/replay_state.h"
 #include "../components/trigger_event.h"
 #include "../components/trigger_queue.h"
@@ -186,8 +187,7 @@ struct InitCombatState : afterhours::System<CombatQueue> {
 
     capture_replay_snapshot();
 
-    uint64_t fp = BattleFingerprint::compute();
-    log_info("AUDIT_FP checkpoint=start hash={}", fp);
+    BattleFingerprint::checkpoint("start");
   }
 
 private:
@@ -199,6 +199,11 @@ private:
 
     ReplayState &rs = replayState.get().get<ReplayState>();
 
+    // Snapshots from an earlier battle refer to entities that are gone
+    if (replayState.get().has<ReplaySnapshots>()) {
+      replayState.get().get<ReplaySnapshots>().clear();
+    }
+
     auto battleRequest =
         afterhours::EntityHelper::get_singleton<BattleLoadRequest>();
     if (battleRequest.get().has<BattleLoadRequest>()) {
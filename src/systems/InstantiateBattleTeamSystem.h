@@ -110,7 +110,7 @@ private:
         RenderOrder::BattleTeams, RenderScreen::Battle | RenderScreen::Results);
 
     if (!render_backend::is_headless_mode) {
-      auto dish_info = get_dish_info(spec.dishType);
+      const auto &dish_info = get_dish_info(spec.dishType);
       const auto frame = afterhours::texture_manager::idx_to_sprite_frame(
           dish_info.sprite.i, dish_info.sprite.j);
       entity.addComponent<afterhours::texture_manager::HasSprite>(
@@ -173,8 +173,8 @@ private:
       auto &dish = entity.get<IsDish>();
 
       // Get dish info and calculate score based on flavor stats
-      DishInfo dishInfo = get_dish_info(dish.type);
-      FlavorStats &flavor = dishInfo.flavor;
+      const DishInfo &dishInfo = get_dish_info(dish.type);
+      const FlavorStats &flavor = dishInfo.flavor;
 
       // Calculate dish score as sum of all flavor stats
       int dishScore = flavor.satiety + flavor.sweetness + flavor.spice +
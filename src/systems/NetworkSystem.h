@@ -1,10 +1,12 @@
 #pragma once
 
 #include "../components/network_info.h"
+#include "../http_worker.h"
 #include "../log.h"
 #include <afterhours/ah.h>
 #include <cstdlib>
 #include <httplib.h>
+#include <optional>
 
 struct NetworkSystem : afterhours::System<NetworkInfo> {
   static constexpr const char *SERVER_IP = "localhost";
@@ -38,8 +40,31 @@ struct NetworkSystem : afterhours::System<NetworkInfo> {
     return 1000;
   }
 
+  HttpTicket health_ticket = kNoHttpTicket;
+
   void for_each_with(afterhours::Entity &, NetworkInfo &networkInfo,
                      float dt) override {
+    if (health_ticket != kNoHttpTicket) {
+      std::optional<HttpResponse> res = HttpWorker::get().poll(health_ticket);
+      if (!res) {
+        return;
+      }
+      health_ticket = kNoHttpTicket;
+
+      bool connected = res->connected && res->status == 200;
+      networkInfo.hasConnection = connected;
+
+      // Track if we've ever had a successful connection
+      if (connected) {
+        log_info("NETWORK: Server connection OK");
+      } else {
+        log_info("NETWORK: Health check failed - connected: {}, status: {}",
+                 res->connected, res->status);
+        log_warn("NETWORK: Server connection failed");
+      }
+      return;
+    }
+
     float check_interval = get_check_interval();
 
     networkInfo.timeSinceLastCheck -= dt;
@@ -55,18 +80,21 @@ struct NetworkSystem : afterhours::System<NetworkInfo> {
     addr.port = SERVER_PORT;
     networkInfo.serverAddress = addr;
 
-    bool connected = check_server_health(addr);
-    networkInfo.hasConnection = connected;
+    // The result is picked up on a later frame
+    health_ticket = HttpWorker::get().submit(make_health_request(addr));
+  }
 
-    // Track if we've ever had a successful connection
-    if (connected) {
-      log_info("NETWORK: Server connection OK");
-    } else {
-      log_warn("NETWORK: Server connection failed");
-    }
+  static HttpRequest make_health_request(const ServerAddress &addr) {
+    HttpRequest request;
+    request.host = addr.ip;
+    request.port = addr.port;
+    request.path = "/health";
+    request.read_timeout_ms = get_read_timeout_ms();
+    request.connect_timeout_ms = get_connect_timeout_ms();
+    return request;
   }
 
-  // Public method for initial connection check during setup
+  // Blocking check, only used once during setup before the first frame
   static bool check_server_health(const ServerAddress &addr) {
     httplib::Client client(addr.ip, addr.port);
     int read_timeout_ms = get_read_timeout_ms();
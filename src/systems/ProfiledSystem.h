@@ -0,0 +1,169 @@
+#pragma once
+
+#include "../utils/system_profiler.h"
+#include <afterhours/ah.h>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+// Forwards every SystemBase call to the wrapped system and reports its
+// timings to SystemProfiler. With the profiler off this is one branch per
+// call.
+struct ProfiledSystem : afterhours::SystemBase {
+  std::unique_ptr<afterhours::SystemBase> inner;
+  uint32_t slot;
+
+  ProfiledSystem(std::unique_ptr<afterhours::SystemBase> system,
+                 uint32_t profiler_slot)
+      : inner(std::move(system)), slot(profiler_slot) {
+#if defined(AFTER_HOURS_INCLUDE_DERIVED_CHILDREN)
+    include_derived_children = inner->include_derived_children;
+#endif
+  }
+
+  static std::string system_name(const afterhours::SystemBase &system) {
+    const char *mangled = typeid(system).name();
+#if defined(__GNUC__) || defined(__clang__)
+    int status = 0;
+    char *demangled =
+        abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+      std::string name(demangled);
+      std::free(demangled);
+      return name;
+    }
+#endif
+    return mangled;
+  }
+
+  bool should_run(const float dt) override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    if (!profiler.enabled()) {
+      return inner->should_run(dt);
+    }
+    uint64_t start = profiler.now_ns();
+    bool ran = inner->should_run(dt);
+    profiler.record_should_run(slot, start, profiler.now_ns(), ran);
+    return ran;
+  }
+
+  bool should_run(const float dt) const override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    const afterhours::SystemBase &system = *inner;
+    if (!profiler.enabled()) {
+      return system.should_run(dt);
+    }
+    uint64_t start = profiler.now_ns();
+    bool ran = system.should_run(dt);
+    profiler.record_should_run(slot, start, profiler.now_ns(), ran);
+    return ran;
+  }
+
+  void once(const float dt) override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    if (!profiler.enabled()) {
+      inner->once(dt);
+      return;
+    }
+    uint64_t start = profiler.now_ns();
+    inner->once(dt);
+    profiler.record_once(slot, start, profiler.now_ns());
+  }
+
+  void once(const float dt) const override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    const afterhours::SystemBase &system = *inner;
+    if (!profiler.enabled()) {
+      system.once(dt);
+      return;
+    }
+    uint64_t start = profiler.now_ns();
+    system.once(dt);
+    profiler.record_once(slot, start, profiler.now_ns());
+  }
+
+  void after(const float dt) override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    if (!profiler.enabled()) {
+      inner->after(dt);
+      return;
+    }
+    uint64_t start = profiler.now_ns();
+    inner->after(dt);
+    profiler.record_after(slot, start, profiler.now_ns());
+  }
+
+  void after(const float dt) const override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    const afterhours::SystemBase &system = *inner;
+    if (!profiler.enabled()) {
+      system.after(dt);
+      return;
+    }
+    uint64_t start = profiler.now_ns();
+    system.after(dt);
+    profiler.record_after(slot, start, profiler.now_ns());
+  }
+
+  void for_each(afterhours::Entity &entity, const float dt) override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    if (profiler.enabled()) {
+      profiler.record_entity(slot);
+    }
+    inner->for_each(entity, dt);
+  }
+
+  void for_each(const afterhours::Entity &entity,
+                const float dt) const override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    if (profiler.enabled()) {
+      profiler.record_entity(slot);
+    }
+    const afterhours::SystemBase &system = *inner;
+    system.for_each(entity, dt);
+  }
+
+#if defined(AFTER_HOURS_INCLUDE_DERIVED_CHILDREN)
+  void for_each_derived(afterhours::Entity &entity, const float dt) override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    if (profiler.enabled()) {
+      profiler.record_entity(slot);
+    }
+    inner->for_each_derived(entity, dt);
+  }
+
+  void for_each_derived(const afterhours::Entity &entity,
+                        const float dt) const override {
+    SystemProfiler &profiler = SystemProfiler::get();
+    if (profiler.enabled()) {
+      profiler.record_entity(slot);
+    }
+    const afterhours::SystemBase &system = *inner;
+    system.for_each_derived(entity, dt);
+  }
+#endif
+};
+
+// Wraps every system registered so far in a ProfiledSystem. Call once, after
+// all systems are registered; systems added later aren't profiled.
+inline void instrument_systems(afterhours::SystemManager &systems) {
+  auto wrap = [](std::vector<std::unique_ptr<afterhours::SystemBase>> &list) {
+    for (auto &system : list) {
+      if (dynamic_cast<ProfiledSystem *>(system.get())) {
+        continue;
+      }
+      uint32_t slot = SystemProfiler::get().register_system(
+          ProfiledSystem::system_name(*system));
+      system = std::make_unique<ProfiledSystem>(std::move(system), slot);
+    }
+  };
+  wrap(systems.fixed_update_systems_);
+  wrap(systems.update_systems_);
+  wrap(systems.render_systems_);
+}
@@ -42,7 +42,7 @@ struct RenderDrinkIcon : afterhours::System<IsDish, Transform, DrinkPairing> {
 
     // Get drink sprite frame
     DrinkType drink_type = drink_pairing.drink.value();
-    DrinkInfo drink_info = get_drink_info(drink_type);
+    const DrinkInfo &drink_info = get_drink_info(drink_type);
     const auto frame = afterhours::texture_manager::idx_to_sprite_frame(
         drink_info.sprite.i, drink_info.sprite.j);
 
@@ -1,73 +1,135 @@
 #pragma once
 
 #include "../components/dish_battle_state.h"
+#include "../components/has_shader.h"
 #include "../components/render_order.h"
 #include "../game_state_manager.h"
 #include "../render_utils.h"
 #include <afterhours/ah.h>
 #include <afterhours/src/plugins/texture_manager.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
+// Render queue for sprites without shaders. for_each_with only filters and
+// appends to a flat queue; after() sorts it by (render order, shader,
+// texture) and draws it in one pass, so consecutive draws share a texture
+// and raylib keeps them in a single batch. The sorted order is reused until
+// the set of queued entities or their HasRenderOrder changes.
 struct RenderSpritesByOrder
     : System<afterhours::texture_manager::HasSprite, HasRenderOrder> {
+  struct QueuedSprite {
+    uint64_t key = 0;
+    const afterhours::texture_manager::HasSprite *sprite = nullptr;
+  };
+
+  // Storage is kept across frames so steady-state frames don't allocate
+  mutable std::vector<QueuedSprite> queue;
+  mutable std::vector<uint32_t> sorted;
+  mutable uint64_t signature = 0;
+  mutable uint64_t sorted_signature = 0;
+  mutable size_t sorted_count = 0;
+
+  // Resolved once per frame instead of once per entity
+  mutable RenderScreen current_screen = RenderScreen::All;
+  mutable bool skip_battle_dishes = false;
+  mutable bool hide_finished_dishes = false;
+  mutable raylib::Texture2D sheet{};
+
   virtual bool should_run(float) override {
     auto &gsm = GameStateManager::get();
     return GameStateManager::should_render_world_entities(gsm.active_screen);
   }
 
+  virtual void once(float) const override {
+    auto &gsm = GameStateManager::get();
+    current_screen = static_cast<RenderScreen>(
+        GameStateManager::render_screen_for(gsm.active_screen));
+    // RenderBattleTeams is the single source of truth for battle dishes
+    skip_battle_dishes =
+        gsm.active_screen == GameStateManager::Screen::Battle ||
+        gsm.active_screen == GameStateManager::Screen::Results;
+    hide_finished_dishes =
+        gsm.active_screen == GameStateManager::Screen::Battle;
+
+    auto *spritesheet_component = EntityHelper::get_singleton_cmp<
+        afterhours::texture_manager::HasSpritesheet>();
+    sheet = spritesheet_component ? spritesheet_component->texture
+                                  : raylib::Texture2D{};
+
+    queue.clear();
+    signature = 0;
+  }
+
   virtual void
   for_each_with(const Entity &entity,
                 const afterhours::texture_manager::HasSprite &hasSprite,
                 const HasRenderOrder &render_order, float) const override {
-    // Check if this entity should render on the current screen
-    auto &gsm = GameStateManager::get();
-    RenderScreen current_screen = get_current_render_screen(gsm);
-
     if (!render_order.should_render_on_screen(current_screen)) {
       return;
     }
 
-    // If this is a battle dish entity, skip here so the specialized
-    // RenderBattleTeams system is the single source of truth for drawing.
-    if (entity.has<DishBattleState>()) {
-      if (gsm.active_screen == GameStateManager::Screen::Battle ||
-          gsm.active_screen == GameStateManager::Screen::Results) {
-        return;
-      }
-    }
-
-    // If entity uses shaders, let the shader-based renderer handle it
+    // Shader sprites are drawn by RenderSpritesWithShaders
     if (entity.has<HasShader>()) {
       return;
     }
 
-    // Additional phase filtering for battle entities
-    if (gsm.active_screen == GameStateManager::Screen::Battle &&
-        entity.has<DishBattleState>()) {
-      const auto &dbs = entity.get<DishBattleState>();
-      if (dbs.phase == DishBattleState::Phase::Finished) {
+    if (entity.has<DishBattleState>()) {
+      if (skip_battle_dishes) {
+        return;
+      }
+      if (hide_finished_dishes && entity.get<DishBattleState>().phase ==
+                                      DishBattleState::Phase::Finished) {
         return;
       }
     }
 
-    // Get spritesheet
-    auto *spritesheet_component = EntityHelper::get_singleton_cmp<
-        afterhours::texture_manager::HasSpritesheet>();
-    if (!spritesheet_component) {
+    uint64_t key = sort_key(render_order.order, 0, sheet.id);
+    queue.push_back({key, &hasSprite});
+    signature = combine(signature, static_cast<uint64_t>(entity.id));
+    signature = combine(signature, key);
+  }
+
+  virtual void after(float) const override {
+    if (queue.empty() || sheet.id == 0) {
       return;
     }
 
-    raylib::Texture2D sheet = spritesheet_component->texture;
+    if (signature != sorted_signature || queue.size() != sorted_count) {
+      sorted.resize(queue.size());
+      for (uint32_t i = 0; i < sorted.size(); ++i) {
+        sorted[i] = i;
+      }
+      // Stable, so sprites with equal keys keep their query order
+      std::stable_sort(sorted.begin(), sorted.end(),
+                       [this](uint32_t a, uint32_t b) {
+                         return queue[a].key < queue[b].key;
+                       });
+      sorted_signature = signature;
+      sorted_count = queue.size();
+    }
 
-    // Render the sprite
-    raylib::DrawTexturePro(sheet, hasSprite.frame, hasSprite.destination(),
-                           vec2{hasSprite.transform.size.x / 2.f,
-                                hasSprite.transform.size.y / 2.f},
-                           hasSprite.angle(), hasSprite.colorTint);
+    for (uint32_t index : sorted) {
+      const afterhours::texture_manager::HasSprite &hasSprite =
+          *queue[index].sprite;
+      raylib::DrawTexturePro(sheet, hasSprite.frame, hasSprite.destination(),
+                             vec2{hasSprite.transform.size.x / 2.f,
+                                  hasSprite.transform.size.y / 2.f},
+                             hasSprite.angle(), hasSprite.colorTint);
+    }
   }
 
 private:
-  RenderScreen get_current_render_screen(const GameStateManager &gsm) const {
-    return static_cast<RenderScreen>(
-        GameStateManager::render_screen_for(gsm.active_screen));
+  // Render order in the top bits, then shader, then texture id
+  static uint64_t sort_key(RenderOrder order, uint32_t shader,
+                           uint32_t texture) {
+    return (static_cast<uint64_t>(static_cast<uint16_t>(order)) << 48) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(shader)) << 32) |
+           texture;
+  }
+
+  static uint64_t combine(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
   }
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../components/dish_battle_state.h"
 #include "../components/has_shader.h"
 #include "../components/render_order.h"
 #include "../components/transform.h"
@@ -8,11 +9,15 @@
 #include "../shader_types.h"
 #include <afterhours/ah.h>
 #include <afterhours/src/plugins/color.h>
+#include <array>
+#include <vector>
 using namespace afterhours;
 
 struct RenderSpritesWithShaders
     : System<Transform, afterhours::texture_manager::HasSprite, HasShader,
              HasColor, HasRenderOrder> {
+  static constexpr size_t kShaderCount = magic_enum::enum_count<ShaderType>();
+
   virtual bool should_run(float) override {
     auto &gsm = GameStateManager::get();
     return GameStateManager::should_render_world_entities(gsm.active_screen);
@@ -22,216 +27,236 @@ struct RenderSpritesWithShaders
     const Transform *transform;
     const afterhours::texture_manager::HasSprite *hasSprite;
     const HasColor *hasColor;
-    const HasShader *hasShader;
   };
 
-  // Cache for batching entities by shader type
-  mutable std::unordered_map<ShaderType, std::vector<EntityRenderData>>
+  // Last values uploaded to a shader, so uniforms are only set on change
+  struct UniformState {
+    bool locations_cached = false;
+    int time_loc = -1;
+    int resolution_loc = -1;
+    int entity_color_loc = -1;
+    int uv_min_loc = -1;
+    int uv_max_loc = -1;
+
+    float time = -1.0f;
+    vec2 resolution = {-1, -1};
+    bool uv_bounds_set = false;
+    raylib::Color entity_color = {0, 0, 0, 0};
+    bool entity_color_set = false;
+  };
+
+  // One bucket per ShaderType, indexed by the enum. Buckets are cleared,
+  // not freed, so their capacity carries over and frames don't allocate.
+  mutable std::array<std::vector<EntityRenderData>, kShaderCount>
       shader_batches;
-  mutable bool uniforms_updated_this_frame = false;
-  mutable float last_time = 0.0f;
-  mutable vec2 last_resolution = {0, 0};
+  mutable std::array<UniformState, kShaderCount> uniform_states;
+
+  // Resolved once per frame
+  mutable RenderScreen current_screen = RenderScreen::All;
+  mutable bool skip_battle_dishes = false;
+  mutable float frame_time = 0.0f;
+  mutable vec2 frame_resolution = {0, 0};
+
+  virtual void once(float) const override {
+    auto &gsm = GameStateManager::get();
+    current_screen = static_cast<RenderScreen>(
+        GameStateManager::render_screen_for(gsm.active_screen));
+    // RenderBattleTeams is the single renderer for battle dishes
+    skip_battle_dishes =
+        gsm.active_screen == GameStateManager::Screen::Battle ||
+        gsm.active_screen == GameStateManager::Screen::Results;
+
+    frame_time = static_cast<float>(raylib::GetTime());
+    auto rezCmp = EntityHelper::get_singleton_cmp<
+        window_manager::ProvidesCurrentResolution>();
+    if (rezCmp) {
+      frame_resolution = {
+          static_cast<float>(rezCmp->current_resolution.width),
+          static_cast<float>(rezCmp->current_resolution.height)};
+    }
+
+    for (auto &batch : shader_batches) {
+      batch.clear();
+    }
+  }
 
   virtual void
   for_each_with(const Entity &entity, const Transform &transform,
                 const afterhours::texture_manager::HasSprite &hasSprite,
                 const HasShader &hasShader, const HasColor &hasColor,
                 const HasRenderOrder &render_order, float) const override {
-    // Check if this entity should render on the current screen
-    auto &gsm = GameStateManager::get();
-    RenderScreen current_screen = get_current_render_screen(gsm);
-
     if (!render_order.should_render_on_screen(current_screen)) {
       return;
     }
 
-    // If this is a battle dish entity, skip here so RenderBattleTeams
-    // is the single renderer to avoid double-draw.
-    if (entity.has<DishBattleState>()) {
-      if (gsm.active_screen == GameStateManager::Screen::Battle ||
-          gsm.active_screen == GameStateManager::Screen::Results) {
-        log_info("SHADER SPRITE RENDER: Skipping battle entity {} (handled by "
-                 "RenderBattleTeams)",
-                 entity.id);
-        return;
-      }
+    if (skip_battle_dishes && entity.has<DishBattleState>()) {
+      return;
     }
 
-    // Collect entity data for batching instead of rendering immediately
     if (hasShader.shaders.empty()) {
       return;
     }
 
-    ShaderType primary_shader = hasShader.shaders[0];
-    if (!ShaderLibrary::get().contains(primary_shader)) {
+    size_t index = static_cast<size_t>(hasShader.shaders[0]);
+    if (index >= kShaderCount) {
       return;
     }
-
-    shader_batches[primary_shader].push_back(
-        {&transform, &hasSprite, &hasColor, &hasShader});
-  }
-
-  virtual void once(float) const override {
-    // Render all batches after collecting all entities
-    render_all_batches();
-    shader_batches.clear();
-    uniforms_updated_this_frame = false;
+    shader_batches[index].push_back({&transform, &hasSprite, &hasColor});
   }
 
-private:
-  RenderScreen get_current_render_screen(const GameStateManager &gsm) const {
-    return static_cast<RenderScreen>(
-        GameStateManager::render_screen_for(gsm.active_screen));
-  }
-
-  void render_all_batches() const {
-    for (auto &[shader_type, entities] : shader_batches) {
-      if (entities.empty())
-        continue;
-
-      render_shader_batch(shader_type, entities);
-    }
-  }
-
-  void
-  render_shader_batch(ShaderType shader_type,
-                      const std::vector<EntityRenderData> &entities) const {
-    const auto &shader = ShaderLibrary::get().get(shader_type);
-
-    // Get spritesheet once per batch
+  // Drawn after every entity has been collected this frame
+  virtual void after(float) const override {
     auto *spritesheet_component = EntityHelper::get_singleton_cmp<
         afterhours::texture_manager::HasSpritesheet>();
     if (!spritesheet_component) {
       return;
     }
+    const raylib::Texture2D &sheet = spritesheet_component->texture;
 
-    raylib::Texture2D sheet = spritesheet_component->texture;
+    for (size_t index = 0; index < kShaderCount; ++index) {
+      if (shader_batches[index].empty()) {
+        continue;
+      }
+      ShaderType shader_type = static_cast<ShaderType>(index);
+      if (!ShaderLibrary::get().contains(shader_type)) {
+        continue;
+      }
+      render_shader_batch(shader_type, shader_batches[index], sheet);
+    }
+  }
 
-    // Render each entity with its own shader state
-    for (const auto &entity_data : entities) {
-      render_backend::BeginShaderMode(shader);
+private:
+  // One shader pass per batch. entityColor is per sprite, and changing a
+  // uniform only applies to draws flushed after it, so the pass is split
+  // (End/Begin flushes raylib's batch) only where the color changes.
+  void render_shader_batch(ShaderType shader_type,
+                           const std::vector<EntityRenderData> &entities,
+                           const raylib::Texture2D &sheet) const {
+    const raylib::Shader &shader = ShaderLibrary::get().get(shader_type);
+    UniformState &state = uniform_states[static_cast<size_t>(shader_type)];
+    cache_uniform_locations(shader_type, state);
+
+    render_backend::BeginShaderMode(shader);
+    update_frame_uniforms(shader, state);
+
+    // Other renderers (MultipassRenderer) also set entityColor, so the
+    // cached color only holds within this pass
+    state.entity_color_set = false;
+    bool drawn_since_upload = false;
+    for (const EntityRenderData &entity_data : entities) {
+      raylib::Color color = entity_data.hasColor->color();
+      if (needs_color_upload(state, color)) {
+        if (drawn_since_upload) {
+          render_backend::EndShaderMode();
+          render_backend::BeginShaderMode(shader);
+          drawn_since_upload = false;
+        }
+        upload_entity_color(shader, state, color);
+      }
 
-      // Update common uniforms once per entity
-      update_shader_uniforms(shader, shader_type);
+      render_single_entity(entity_data, sheet);
+      drawn_since_upload = true;
+    }
 
-      // Render the entity with its specific uniforms
-      render_single_entity(entity_data, sheet, shader, shader_type);
+    render_backend::EndShaderMode();
+  }
 
-      render_backend::EndShaderMode();
+  static void cache_uniform_locations(ShaderType shader_type,
+                                      UniformState &state) {
+    if (state.locations_cached) {
+      return;
     }
+    const ShaderLibrary &library = ShaderLibrary::get();
+    state.time_loc =
+        library.get_uniform_location(shader_type, UniformLocation::Time);
+    state.resolution_loc =
+        library.get_uniform_location(shader_type, UniformLocation::Resolution);
+    state.entity_color_loc =
+        library.get_uniform_location(shader_type, UniformLocation::EntityColor);
+    state.uv_min_loc =
+        library.get_uniform_location(shader_type, UniformLocation::UvMin);
+    state.uv_max_loc =
+        library.get_uniform_location(shader_type, UniformLocation::UvMax);
+    if (state.entity_color_loc == -1) {
+      log_warn("entityColor uniform location not found in shader {}",
+               ShaderUtils::to_string(shader_type));
+    }
+    state.locations_cached = true;
   }
 
-  void update_shader_uniforms(const raylib::Shader &shader,
-                              ShaderType /* shader_type */) const {
-    float current_time = static_cast<float>(raylib::GetTime());
-
-    // Update time uniform if it changed
-    if (current_time != last_time) {
-      int timeLoc = raylib::GetShaderLocation(shader, "time");
-      if (timeLoc != -1) {
-        raylib::SetShaderValue(shader, timeLoc, &current_time,
-                               raylib::SHADER_UNIFORM_FLOAT);
-      }
-      last_time = current_time;
+  void update_frame_uniforms(const raylib::Shader &shader,
+                             UniformState &state) const {
+    if (state.time_loc != -1 && state.time != frame_time) {
+      raylib::SetShaderValue(shader, state.time_loc, &frame_time,
+                             raylib::SHADER_UNIFORM_FLOAT);
+      state.time = frame_time;
     }
 
-    // Update resolution uniform if it changed
-    auto rezCmp = EntityHelper::get_singleton_cmp<
-        window_manager::ProvidesCurrentResolution>();
-    if (rezCmp) {
-      vec2 current_resolution = {
-          static_cast<float>(rezCmp->current_resolution.width),
-          static_cast<float>(rezCmp->current_resolution.height)};
-      if (current_resolution.x != last_resolution.x ||
-          current_resolution.y != last_resolution.y) {
-        int rezLoc = raylib::GetShaderLocation(shader, "resolution");
-        if (rezLoc != -1) {
-          raylib::SetShaderValue(shader, rezLoc, &current_resolution,
-                                 raylib::SHADER_UNIFORM_VEC2);
-        }
-        last_resolution = current_resolution;
-      }
+    if (state.resolution_loc != -1 &&
+        (state.resolution.x != frame_resolution.x ||
+         state.resolution.y != frame_resolution.y)) {
+      raylib::SetShaderValue(shader, state.resolution_loc, &frame_resolution,
+                             raylib::SHADER_UNIFORM_VEC2);
+      state.resolution = frame_resolution;
     }
 
-    // Update UV bounds once per batch (they're the same for all sprites)
-    auto *spritesheet_component = EntityHelper::get_singleton_cmp<
-        afterhours::texture_manager::HasSpritesheet>();
-    if (spritesheet_component) {
-      // Using per-entity frames; default UVs to full sheet. If a shader needs
-      // exact UVs, compute them per-entity from hasSprite.frame.
+    // Sprites use per-entity frames, so the UV bounds are the full sheet
+    if (!state.uv_bounds_set) {
       float uvMin[2] = {0.f, 0.f};
       float uvMax[2] = {1.f, 1.f};
-
-      int uvMinLoc = raylib::GetShaderLocation(shader, "uvMin");
-      if (uvMinLoc != -1) {
-        raylib::SetShaderValue(shader, uvMinLoc, uvMin,
+      if (state.uv_min_loc != -1) {
+        raylib::SetShaderValue(shader, state.uv_min_loc, uvMin,
                                raylib::SHADER_UNIFORM_VEC2);
       }
-      int uvMaxLoc = raylib::GetShaderLocation(shader, "uvMax");
-      if (uvMaxLoc != -1) {
-        raylib::SetShaderValue(shader, uvMaxLoc, uvMax,
+      if (state.uv_max_loc != -1) {
+        raylib::SetShaderValue(shader, state.uv_max_loc, uvMax,
                                raylib::SHADER_UNIFORM_VEC2);
       }
+      state.uv_bounds_set = true;
+    }
+  }
+
+  static bool needs_color_upload(const UniformState &state,
+                                 raylib::Color color) {
+    if (state.entity_color_loc == -1) {
+      return false;
     }
+    return !state.entity_color_set || state.entity_color.r != color.r ||
+           state.entity_color.g != color.g || state.entity_color.b != color.b ||
+           state.entity_color.a != color.a;
+  }
+
+  static void upload_entity_color(const raylib::Shader &shader,
+                                  UniformState &state, raylib::Color color) {
+    float entityColorF[4] = {
+        color.r / 255.0f,
+        color.g / 255.0f,
+        color.b / 255.0f,
+        color.a / 255.0f,
+    };
+    raylib::SetShaderValue(shader, state.entity_color_loc, entityColorF,
+                           raylib::SHADER_UNIFORM_VEC4);
+    state.entity_color = color;
+    state.entity_color_set = true;
   }
 
   void render_single_entity(const EntityRenderData &entity_data,
-                            const raylib::Texture2D &sheet,
-                            const raylib::Shader &shader,
-                            ShaderType shader_type) const {
+                            const raylib::Texture2D &sheet) const {
     const auto &transform = *entity_data.transform;
     const auto &hasSprite = *entity_data.hasSprite;
-    const auto &hasColor = *entity_data.hasColor;
-    const auto &hasShader = *entity_data.hasShader;
-
-    // Update per-entity uniforms
-    update_per_entity_uniforms(shader, hasShader, hasColor, transform,
-                               shader_type);
 
-    // Calculate rendering parameters
     float dest_width = hasSprite.frame.width * hasSprite.scale;
     float dest_height = hasSprite.frame.height * hasSprite.scale;
 
-    float offset_x = 0.0f; // SPRITE_OFFSET_X
-    float offset_y = 0.0f; // SPRITE_OFFSET_Y
-
-    float rotated_x = offset_x * cosf(transform.angle * M_PI / 180.f) -
-                      offset_y * sinf(transform.angle * M_PI / 180.f);
-    float rotated_y = offset_x * sinf(transform.angle * M_PI / 180.f) +
-                      offset_y * cosf(transform.angle * M_PI / 180.f);
-
-    // Render the sprite
     render_backend::DrawTexturePro(
         sheet, hasSprite.frame,
         Rectangle{
-            transform.position.x + transform.size.x / 2.f + rotated_x,
-            transform.position.y + transform.size.y / 2.f + rotated_y,
+            transform.position.x + transform.size.x / 2.f,
+            transform.position.y + transform.size.y / 2.f,
             dest_width,
             dest_height,
         },
         vec2{dest_width / 2.f, dest_height / 2.f}, transform.angle,
         raylib::WHITE);
   }
-
-  void update_per_entity_uniforms(const raylib::Shader &shader,
-                                  const HasShader & /*hasShader*/,
-                                  const HasColor &hasColor,
-                                  const Transform & /*transform*/,
-                                  ShaderType /*shader_type*/) const {
-    // Update entity-specific uniforms
-    raylib::Color entityColor = hasColor.color();
-    float entityColorF[4] = {
-        entityColor.r / 255.0f,
-        entityColor.g / 255.0f,
-        entityColor.b / 255.0f,
-        entityColor.a / 255.0f,
-    };
-    int entityColorLoc = raylib::GetShaderLocation(shader, "entityColor");
-    if (entityColorLoc != -1) {
-      raylib::SetShaderValue(shader, entityColorLoc, entityColorF,
-                             raylib::SHADER_UNIFORM_VEC4);
-    } else {
-      log_warn("entityColor uniform location not found in shader!");
-    }
-  }
 };
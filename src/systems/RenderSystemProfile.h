@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../input_mapping.h"
+#include "../log.h"
+#include "../render_backend.h"
+#include "../ui/text_formatting.h"
+#include "../utils/system_profiler.h"
+#include <afterhours/ah.h>
+#include <algorithm>
+#include <fmt/format.h>
+
+// Text overlay under the FPS counter listing the slowest systems. F3 toggles
+// it (and profiling), F4 writes the recorded frames as a Chrome trace.
+struct RenderSystemProfile
+    : System<window_manager::ProvidesCurrentResolution> {
+  static constexpr size_t kRows = 12;
+
+  bool visible = false;
+
+  virtual bool should_run(float) override {
+    input::PossibleInputCollector inpc = input::get_input_collector();
+    if (inpc.has_value()) {
+      for (const auto &action : inpc.inputs_pressed()) {
+        if (action_matches(action.action, InputAction::ToggleSystemProfiler)) {
+          visible = !visible;
+          if (visible) {
+            SystemProfiler::get().set_enabled(true);
+          }
+        } else if (action_matches(action.action,
+                                  InputAction::SaveSystemTrace)) {
+          save_trace();
+        }
+      }
+    }
+    return visible;
+  }
+
+  static void save_trace() {
+    const std::string path = "output/profiles/system_trace.json";
+    if (SystemProfiler::get().write_chrome_trace(path)) {
+      log_info("Wrote system trace to {}", path);
+    } else {
+      log_warn("Failed to write system trace to {}", path);
+    }
+  }
+
+  virtual void for_each_with(
+      const Entity &,
+      const window_manager::ProvidesCurrentResolution &pCurrentResolution,
+      float) const override {
+    std::vector<SystemProfiler::SystemStats> rows =
+        SystemProfiler::get().stats();
+    std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) {
+      return a.smoothed_ns > b.smoothed_ns;
+    });
+
+    const int x = pCurrentResolution.width() - 520;
+    const float font_size = 14.0f;
+    const raylib::Color col = text_formatting::TextFormatting::get_color(
+        text_formatting::SemanticColor::Text,
+        text_formatting::FormattingContext::HUD);
+
+    int y = 18;
+    render_backend::DrawTextWithActiveFont("system          ms/frame  entities",
+                                           x, y, font_size, col);
+    for (size_t i = 0; i < std::min(rows.size(), kRows); ++i) {
+      const SystemProfiler::SystemStats &row = rows[i];
+      y += 16;
+      uint64_t runs = std::max<uint64_t>(row.runs, 1);
+      std::string line =
+          fmt::format("{:<28.28} {:6.3f} {:6}", row.name,
+                      row.smoothed_ns / 1e6, row.entities / runs);
+      render_backend::DrawTextWithActiveFont(line.c_str(), x, y, font_size,
+                                             col);
+    }
+  }
+};
@@ -135,7 +135,7 @@ struct RenderZingBodyOverlay : afterhours::System<HasRenderOrder, IsDish> {
         body = cs.baseBody;
       }
     } else {
-      auto dish_info = get_dish_info(is_dish.type);
+      const auto &dish_info = get_dish_info(is_dish.type);
       FlavorStats flavor = dish_info.flavor;
       if (has_deferred) {
         const auto &def = entity.get<DeferredFlavorMods>();
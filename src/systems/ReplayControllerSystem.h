@@ -5,6 +5,7 @@
 #include "../components/battle_session_tag.h"
 #include "../components/battle_team_tags.h"
 #include "../components/combat_queue.h"
+#include "../components/replay_snapshots.h"
 #include "../components/replay_state.h"
 #include "../components/trigger_queue.h"
 #include "../game_state_manager.h"
@@ -14,11 +15,17 @@
 #include "../rl.h"
 #include "../settings.h"
 #include "../shop.h"
+#include "../utils/battle_snapshot.h"
 #include <afterhours/ah.h>
+#include <algorithm>
 #include <cstdint>
 
 struct ReplayControllerSystem : afterhours::System<ReplayState> {
   static constexpr float kTickMs = 150.0f / 1000.0f;
+  // Battle time between snapshots when no course checkpoint comes sooner
+  static constexpr int64_t kSnapshotIntervalMs = 2000;
+  // Battle speed while fast-forwarding from a snapshot to a seek target
+  static constexpr float kSeekSpeed = 32.0f;
 
   virtual bool should_run(float) override {
     if (render_backend::is_headless_mode) {
@@ -26,13 +33,26 @@ struct ReplayControllerSystem : afterhours::System<ReplayState> {
     }
     auto &gsm = GameStateManager::get();
     if (gsm.active_screen != GameStateManager::Screen::Battle) {
+      // A seek past the end of the battle finishes on the results screen
+      auto replayState = afterhours::EntityHelper::get_singleton<ReplayState>();
+      if (replayState.get().has<ReplayState>() &&
+          replayState.get().get<ReplayState>().seeking()) {
+        finish_seek(replayState.get().get<ReplayState>());
+      }
       return false;
     }
     return true;
   }
 
-  void for_each_with(afterhours::Entity &, ReplayState &rs, float dt) override {
-    handle_inputs(rs);
+  void for_each_with(afterhours::Entity &entity, ReplayState &rs,
+                     float dt) override {
+    ReplaySnapshots &snapshots =
+        entity.addComponentIfMissing<ReplaySnapshots>();
+    handle_inputs(rs, snapshots);
+
+    if (rs.seeking()) {
+      update_seek(rs, snapshots);
+    }
 
     // When paused, battle systems will check isReplayPaused() and not run
     if (rs.paused) {
@@ -40,18 +60,136 @@ struct ReplayControllerSystem : afterhours::System<ReplayState> {
     }
 
     rs.targetMs += static_cast<int64_t>(dt * 1000.0f * rs.timeScale);
+    // dt is already scaled by the battle speed
+    rs.clockMs += static_cast<int64_t>(dt * 1000.0f);
     rs.currentFrame++; // Increment frame counter for progress tracking
+
+    capture_snapshot(rs, snapshots);
+  }
+
+  static int current_course() {
+    auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+    if (!cq_entity.get().has<CombatQueue>()) {
+      return 0;
+    }
+    return cq_entity.get().get<CombatQueue>().current_index;
   }
 
 private:
-  void handle_inputs(ReplayState &rs) {
+  // Snapshots are taken at every fingerprint checkpoint (battle start and
+  // course ends) and every kSnapshotIntervalMs in between. Replaying after
+  // a backwards seek doesn't add any, since later ones already exist.
+  void capture_snapshot(const ReplayState &rs, ReplaySnapshots &snapshots) {
+    auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+    if (!cq_entity.get().has<CombatQueue>()) {
+      return;
+    }
+    const CombatQueue &cq = cq_entity.get().get<CombatQueue>();
+    const BattleSnapshot *newest = snapshots.newest();
+    size_t checkpoints = cq.fingerprint_checkpoints.size();
+
+    bool new_checkpoint =
+        checkpoints > 0 &&
+        (!newest || checkpoints > newest->checkpoints.size());
+    bool interval_elapsed =
+        newest && rs.clockMs >= newest->clock_ms + kSnapshotIntervalMs;
+    if (!new_checkpoint && !interval_elapsed) {
+      return;
+    }
+
+    std::string label = new_checkpoint
+                            ? cq.fingerprint_checkpoints.back().label
+                            : "t" + std::to_string(rs.clockMs);
+    snapshots.snapshots.push_back(
+        BattleSnapshotter::capture(label, rs.clockMs, rs.currentFrame));
+  }
+
+  void update_seek(ReplayState &rs, ReplaySnapshots &snapshots) {
+    if (!rs.seekStarted) {
+      start_seek(rs, snapshots);
+      rs.seekStarted = true;
+    }
+    if (seek_reached(rs)) {
+      finish_seek(rs);
+    }
+  }
+
+  // Restores the closest snapshot at or before the target, unless the
+  // target is ahead and the current position is already closer to it, then
+  // runs the battle at kSeekSpeed until the target is reached
+  void start_seek(ReplayState &rs, ReplaySnapshots &snapshots) {
+    const BattleSnapshot *from =
+        rs.seekCourse ? snapshots.for_course(*rs.seekCourse)
+                      : snapshots.at_or_before(*rs.seekMs);
+    bool behind = rs.seekCourse ? *rs.seekCourse < current_course()
+                                : *rs.seekMs < rs.clockMs;
+
+    if (from && (behind || from->clock_ms > rs.clockMs)) {
+      log_info("REPLAY_SEEK restoring snapshot {} at {}ms", from->label,
+               from->clock_ms);
+      if (BattleSnapshotter::restore(*from)) {
+        rs.clockMs = from->clock_ms;
+        rs.targetMs = from->clock_ms;
+        rs.currentFrame = from->frame;
+      } else {
+        restart_replay(rs, snapshots);
+      }
+    } else if (behind) {
+      restart_replay(rs, snapshots);
+    }
+
+    if (!rs.fastForwarding) {
+      rs.speedBeforeSeek = render_backend::timing_speed_scale;
+      rs.pausedBeforeSeek = rs.paused;
+      rs.fastForwarding = true;
+    }
+    rs.paused = false;
+    render_backend::timing_speed_scale = kSeekSpeed;
+  }
+
+  static bool seek_reached(const ReplayState &rs) {
+    auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+    if (cq_entity.get().has<CombatQueue>() &&
+        cq_entity.get().get<CombatQueue>().complete) {
+      return true;
+    }
+    if (rs.seekCourse) {
+      return current_course() >= *rs.seekCourse;
+    }
+    return rs.clockMs >= *rs.seekMs;
+  }
+
+  static void finish_seek(ReplayState &rs) {
+    if (rs.fastForwarding) {
+      render_backend::timing_speed_scale = rs.speedBeforeSeek;
+      rs.paused = rs.pausedBeforeSeek;
+      rs.fastForwarding = false;
+    }
+    rs.seekMs.reset();
+    rs.seekCourse.reset();
+    rs.seekStarted = false;
+    log_info("REPLAY_SEEK done clock={}ms course={}", rs.clockMs,
+             current_course());
+  }
+
+  void handle_inputs(ReplayState &rs, ReplaySnapshots &snapshots) {
     if (raylib::IsKeyPressed(raylib::KEY_SPACE)) {
       rs.paused = !rs.paused;
       log_info("REPLAY_PAUSE {}", rs.paused);
     }
 
     if (raylib::IsKeyPressed(raylib::KEY_R)) {
-      restart_replay(rs);
+      restart_replay(rs, snapshots);
+    }
+
+    if (raylib::IsKeyPressed(raylib::KEY_LEFT_BRACKET)) {
+      rs.seek_to_course(std::max(current_course() - 1, 0));
+      log_info("REPLAY_SEEK course {}", *rs.seekCourse);
+    }
+
+    if (raylib::IsKeyPressed(raylib::KEY_RIGHT_BRACKET)) {
+      rs.seek_to_course(current_course() + 1);
+      log_info("REPLAY_SEEK course {}", *rs.seekCourse);
     }
 
     if (raylib::IsKeyPressed(raylib::KEY_ONE) ||
@@ -87,7 +225,7 @@ private:
     }
   }
 
-  void restart_replay(ReplayState &rs) {
+  void restart_replay(ReplayState &rs, ReplaySnapshots &snapshots) {
     log_info("REPLAY_RESTART seed={} playerJson={} opponentJson={}", rs.seed,
              rs.playerJsonPath, rs.opponentJsonPath);
 
@@ -99,9 +237,8 @@ private:
 
       int cleanup_count = 0;
       for (int entityId : reg.ownedEntityIds) {
-        if (auto opt =
-                afterhours::EntityQuery().whereID(entityId).gen_first()) {
-          afterhours::Entity &e = *opt.value();
+        if (auto opt = EQ::find_by_id(entityId)) {
+          afterhours::Entity &e = opt.asE();
           if (e.has<BattleSessionTag>()) {
             const BattleSessionTag &tag = e.get<BattleSessionTag>();
             if (tag.sessionId == oldSession) {
@@ -133,10 +270,19 @@ private:
       tq.get().get<TriggerQueue>().clear();
     }
 
+    // The snapshots and checkpoints refer to the entities cleaned up above
+    auto cq = afterhours::EntityHelper::get_singleton<CombatQueue>();
+    if (cq.get().has<CombatQueue>()) {
+      cq.get().get<CombatQueue>().reset();
+    }
+    snapshots.clear();
+
     log_info("REPLAY_INIT seed={} playerJson={} opponentJson={}", rs.seed,
              rs.playerJsonPath, rs.opponentJsonPath);
 
     // Reset frame counter on restart
     rs.currentFrame = 0;
+    rs.clockMs = 0;
+    rs.targetMs = 0;
   }
 };
@@ -85,15 +85,17 @@ private:
     // headless mode
     const float kFallbackDt = 1.0f / 60.0f;
     float effective_dt = dt > 0.0f ? dt : kFallbackDt;
-    dbs.bite_cadence_timer += effective_dt;
+    bool pre_pause = dbs.bite_cadence == DishBattleState::BiteCadence::PrePause;
+    bool pause_over =
+        BattleTiming::advance_timer(dbs.bite_cadence_timer, effective_dt,
+                                    BattleTiming::get_cadence_pause(pre_pause));
 
     DishBattleState &opponent_dbs = opponent.get<DishBattleState>();
     CombatStats &opponent_cs = opponent.get<CombatStats>();
 
     // Handle cadence state machine
     if (dbs.bite_cadence == DishBattleState::BiteCadence::PrePause) {
-      float scaled_pre_pause = BattleTiming::get_pre_pause();
-      if (dbs.bite_cadence_timer < scaled_pre_pause)
+      if (!pause_over)
         return;
 
       // Time to apply damage - both dishes attack simultaneously
@@ -146,8 +148,7 @@ private:
     }
 
     if (dbs.bite_cadence == DishBattleState::BiteCadence::PostPause) {
-      float scaled_post_pause = BattleTiming::get_post_pause();
-      if (dbs.bite_cadence_timer < scaled_post_pause)
+      if (!pause_over)
         return;
 
       // Advance to next simultaneous attack
@@ -5,31 +5,62 @@
 #include "../components/is_inventory_item.h"
 #include "../components/replay_state.h"
 #include "../game_state_manager.h"
+#include "../http_worker.h"
 #include "../log.h"
 #include "../server/file_storage.h"
+#include "../shop.h"
 #include "../systems/GameStateSaveSystem.h"
 #include "../utils/code_hash_generated.h"
 #include "../utils/http_helpers.h"
+#include "../utils/wire_format.h"
 #include <afterhours/ah.h>
 #include <filesystem>
 #include <fstream>
-#include <httplib.h>
 #include <magic_enum/magic_enum.hpp>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <vector>
 
 struct ServerBattleRequestSystem : afterhours::System<BattleLoadRequest> {
+  // Slightly longer than the HTTP read timeout so the worker normally
+  // reports the failure itself
+  static constexpr float kServerRequestTimeoutSeconds = 35.0f;
+
+  HttpTicket battle_ticket = kNoHttpTicket;
+  HttpTicket save_ticket = kNoHttpTicket;
+  float battle_wait_seconds = 0.0f;
+  nlohmann::json pending_player_team;
+  std::string pending_save_user_id;
+  std::string pending_save_url;
+  nlohmann::json pending_save_state;
+  // Last state the server acknowledged; later saves send a JSON Patch
+  // against it instead of the whole state
+  std::string synced_user_id;
+  std::string synced_checksum;
+  nlohmann::json synced_state;
+
   virtual bool should_run(float) override {
+    poll_save_response();
+
     auto &gsm = GameStateManager::get();
-    return gsm.active_screen == GameStateManager::Screen::Battle;
+    if (gsm.active_screen != GameStateManager::Screen::Battle) {
+      cancel_battle_request();
+      return false;
+    }
+    return true;
   }
 
   void for_each_with(afterhours::Entity &, BattleLoadRequest &request,
-                     float) override {
+                     float dt) override {
     if (request.serverUrl.empty()) {
       return;
     }
 
+    if (battle_ticket != kNoHttpTicket) {
+      poll_battle_response(request, dt);
+      return;
+    }
+
     if (request.serverRequestPending) {
       return;
     }
@@ -77,14 +108,54 @@ struct ServerBattleRequestSystem : afterhours::System<BattleLoadRequest> {
     log_info("SERVER_BATTLE_REQUEST: Connecting to server at {}:{}",
              url_parts.host, url_parts.port);
 
-    httplib::Client client(url_parts.host, url_parts.port);
-    client.set_read_timeout(30, 0);
-    client.set_connection_timeout(10, 0);
+    // CBOR both ways, gzipped when large; httplib inflates the response
+    HttpRequest http_request;
+    http_request.method = HttpRequest::Method::Post;
+    http_request.host = url_parts.host;
+    http_request.port = url_parts.port;
+    http_request.path = "/battle";
+    http_request.headers = {{"Accept", wire_format::kCborType}};
+    http_request.body =
+        wire_format::encode(player_team_json, wire_format::Encoding::Cbor);
+    if (wire_format::gzip_if_large(http_request.body,
+                                   wire_format::Encoding::Cbor)) {
+      http_request.headers.emplace("Content-Encoding", wire_format::kGzip);
+    }
+    http_request.content_type = wire_format::kCborType;
+    http_request.connect_timeout_ms = 10000;
+    http_request.read_timeout_ms = 30000;
 
-    std::string request_body = player_team_json.dump();
-    auto res = client.Post("/battle", request_body, "application/json");
+    battle_ticket = HttpWorker::get().submit(std::move(http_request));
+    if (battle_ticket == kNoHttpTicket) {
+      request.serverRequestPending = false;
+      return;
+    }
+    battle_wait_seconds = 0.0f;
+    pending_player_team = std::move(player_team_json);
+    make_toast("Waiting for server...");
+  }
 
+private:
+  void poll_battle_response(BattleLoadRequest &request, float dt) {
+    battle_wait_seconds += dt;
+    std::optional<HttpResponse> res = HttpWorker::get().poll(battle_ticket);
     if (!res) {
+      if (battle_wait_seconds > kServerRequestTimeoutSeconds) {
+        log_error("SERVER_BATTLE_REQUEST: Timed out after {:.1f}s waiting "
+                  "for server",
+                  battle_wait_seconds);
+        HttpWorker::get().cancel(battle_ticket);
+        battle_ticket = kNoHttpTicket;
+        request.serverRequestPending = false;
+      }
+      return;
+    }
+
+    battle_ticket = kNoHttpTicket;
+    log_info("SERVER_BATTLE_REQUEST: Server answered after {:.2f}s",
+             battle_wait_seconds);
+
+    if (!res->connected) {
       log_error("SERVER_BATTLE_REQUEST: Failed to connect to server");
       request.serverRequestPending = false;
       return;
@@ -98,7 +169,8 @@ struct ServerBattleRequestSystem : afterhours::System<BattleLoadRequest> {
       return;
     }
 
-    nlohmann::json battle_response = nlohmann::json::parse(res->body);
+    nlohmann::json battle_response =
+        wire_format::decode(res->body, res->content_type);
     uint64_t seed = battle_response["seed"].get<uint64_t>();
     std::string opponent_id = battle_response["opponentId"].get<std::string>();
     std::string checksum = battle_response.value("checksum", std::string(""));
@@ -108,18 +180,30 @@ struct ServerBattleRequestSystem : afterhours::System<BattleLoadRequest> {
     log_info("  Opponent ID: {}", opponent_id);
     log_info("  Checksum: {}", checksum);
 
+    if (!battle_response.contains("opponentTeam")) {
+      log_error("SERVER_BATTLE_REQUEST: Response is missing the opponent "
+                "team");
+      pending_player_team = nlohmann::json();
+      request.serverRequestPending = false;
+      return;
+    }
+
+    // The teams come back with the result; the paths only name the battle
+    // and keep a local copy so the History screen can replay it later
     request.playerJsonPath =
         "output/battles/temp_player_" + std::to_string(seed) + ".json";
     request.opponentJsonPath =
         "output/battles/temp_opponent_" + std::to_string(seed) + ".json";
+    request.playerTeamJson =
+        battle_response.value("playerTeam", pending_player_team);
+    request.opponentTeamJson = battle_response["opponentTeam"];
+    pending_player_team = nlohmann::json();
 
-    if (!std::filesystem::exists(request.playerJsonPath)) {
-      log_warn("SERVER_BATTLE_REQUEST: Player file not found, creating it...");
-      std::filesystem::create_directories("output/battles");
-      std::ofstream player_out(request.playerJsonPath);
-      player_out << player_team_json.dump(2);
-      player_out.close();
-    }
+    std::filesystem::create_directories("output/battles");
+    server::FileStorage::save_json_to_file(request.playerJsonPath,
+                                           request.playerTeamJson);
+    server::FileStorage::save_json_to_file(request.opponentJsonPath,
+                                           request.opponentTeamJson);
 
     auto replay_state_opt =
         afterhours::EntityHelper::get_singleton<ReplayState>();
@@ -134,6 +218,11 @@ struct ServerBattleRequestSystem : afterhours::System<BattleLoadRequest> {
     replay.playerJsonPath = request.playerJsonPath;
     replay.opponentJsonPath = request.opponentJsonPath;
     replay.serverChecksum = checksum;
+    replay.serverCheckpoints.clear();
+    for (const auto &cp : battle_response.value("checkpoints",
+                                                nlohmann::json::array())) {
+      replay.serverCheckpoints.push_back(cp.value("hash", std::string("")));
+    }
     replay.active = true;
     replay.paused = false;
     replay.timeScale = 1.0f;
@@ -141,46 +230,140 @@ struct ServerBattleRequestSystem : afterhours::System<BattleLoadRequest> {
     afterhours::EntityHelper::registerSingleton<ReplayState>(replay_entity);
 
     log_info("SERVER_BATTLE_REQUEST: Server request complete");
-    log_info("  Player file: {}", request.playerJsonPath);
-    log_info("  Opponent file: {}", request.opponentJsonPath);
+    log_info("  Player team: {} dishes",
+             request.playerTeamJson.value("team", nlohmann::json::array())
+                 .size());
+    log_info("  Opponent team: {} dishes",
+             request.opponentTeamJson.value("team", nlohmann::json::array())
+                 .size());
+
+    submit_game_state_save(request.serverUrl);
+  }
 
+  void submit_game_state_save(const std::string &server_url) {
+    GameStateSaveSystem save_system;
     auto save_result_after = save_system.save_game_state();
-    if (save_result_after.success) {
-      log_info("GAME_STATE_SAVE: Saving game state after battle response");
-
-      nlohmann::json save_request;
-      save_request["userId"] = save_result_after.gameState["userId"];
-      save_request["checksum"] = save_result_after.checksum;
-      save_request["gameState"] = save_result_after.gameState;
-      save_request["timestamp"] = save_result_after.gameState["timestamp"];
-
-      auto save_res = client.Post("/save-game-state", save_request.dump(),
-                                  "application/json");
-      if (save_res && save_res->status == 200) {
-        nlohmann::json save_response = nlohmann::json::parse(save_res->body);
-        bool match = save_response.value("match", false);
-        if (!match && save_response.contains("gameState")) {
-          log_info("GAME_STATE_SAVE: Server returned updated state, "
-                   "overwriting local save");
-          std::string userId =
-              save_result_after.gameState["userId"].get<std::string>();
-          server::FileStorage::save_json_to_file(
-              server::FileStorage::get_game_state_save_path(userId),
-              save_response["gameState"]);
-        } else {
-          log_info("GAME_STATE_SAVE: Server save successful, checksum match");
-        }
-      } else {
-        log_error("GAME_STATE_SAVE: Server save failed, continuing "
-                  "with local save only");
-      }
-    } else {
+    if (!save_result_after.success) {
       log_error(
           "GAME_STATE_SAVE: Failed to save game state after battle response");
+      return;
+    }
+    log_info("GAME_STATE_SAVE: Saving game state after battle response");
+
+    nlohmann::json state = save_result_after.gameState;
+    state.erase("checksum");
+    std::string user_id = state["userId"].get<std::string>();
+
+    nlohmann::json save_request;
+    save_request["userId"] = user_id;
+    save_request["checksum"] = save_result_after.checksum;
+    save_request["timestamp"] = state["timestamp"];
+    if (!synced_checksum.empty() && synced_user_id == user_id) {
+      save_request["baseChecksum"] = synced_checksum;
+      save_request["patch"] = nlohmann::json::diff(synced_state, state);
+    } else {
+      save_request["gameState"] = state;
+    }
+
+    pending_save_user_id = user_id;
+    pending_save_url = server_url;
+    pending_save_state = std::move(state);
+    send_save_request(save_request);
+  }
+
+  void send_save_request(const nlohmann::json &save_request) {
+    http_helpers::ServerUrlParts url_parts =
+        http_helpers::parse_server_url(pending_save_url);
+    HttpRequest http_request;
+    http_request.method = HttpRequest::Method::Post;
+    http_request.host = url_parts.host;
+    http_request.port = url_parts.port;
+    http_request.path = "/save-game-state";
+    http_request.headers = {{"Accept", wire_format::kCborType}};
+    http_request.body =
+        wire_format::encode(save_request, wire_format::Encoding::Cbor);
+    if (wire_format::gzip_if_large(http_request.body,
+                                   wire_format::Encoding::Cbor)) {
+      http_request.headers.emplace("Content-Encoding", wire_format::kGzip);
+    }
+    http_request.content_type = wire_format::kCborType;
+    http_request.connect_timeout_ms = 10000;
+    http_request.read_timeout_ms = 30000;
+
+    // A newer save supersedes one still in flight
+    if (save_ticket != kNoHttpTicket) {
+      HttpWorker::get().cancel(save_ticket);
+    }
+    save_ticket = HttpWorker::get().submit(std::move(http_request));
+  }
+
+  void poll_save_response() {
+    if (save_ticket == kNoHttpTicket) {
+      return;
+    }
+    std::optional<HttpResponse> save_res = HttpWorker::get().poll(save_ticket);
+    if (!save_res) {
+      return;
+    }
+    save_ticket = kNoHttpTicket;
+
+    // The server no longer holds the state the patch was made against
+    if (save_res->connected && save_res->status == 409) {
+      log_info("GAME_STATE_SAVE: Server state moved on, sending full state");
+      synced_checksum.clear();
+      synced_state = nlohmann::json();
+      send_save_request(
+          nlohmann::json{{"userId", pending_save_user_id},
+                         {"checksum",
+                          compute_game_state_checksum(pending_save_state)},
+                         {"timestamp", pending_save_state["timestamp"]},
+                         {"gameState", pending_save_state}});
+      return;
+    }
+
+    if (!save_res->connected || save_res->status != 200) {
+      log_error("GAME_STATE_SAVE: Server save failed, continuing "
+                "with local save only");
+      return;
+    }
+
+    nlohmann::json save_response =
+        wire_format::decode(save_res->body, save_res->content_type);
+    bool match = save_response.value("match", false);
+    synced_user_id = pending_save_user_id;
+    synced_checksum = save_response.value("checksum", std::string(""));
+    synced_state = std::move(pending_save_state);
+    if (!match && save_response.contains("gameState")) {
+      log_info("GAME_STATE_SAVE: Server returned updated state, "
+               "overwriting local save");
+      synced_state = save_response["gameState"];
+      nlohmann::json local_state = synced_state;
+      local_state["checksum"] = compute_game_state_checksum(local_state);
+      server::FileStorage::save_json_to_file(
+          server::FileStorage::get_game_state_save_path(pending_save_user_id),
+          local_state);
+    } else {
+      log_info("GAME_STATE_SAVE: Server save successful, checksum match");
+    }
+  }
+
+  // Leaving the battle screen abandons a request that hasn't answered yet
+  void cancel_battle_request() {
+    if (battle_ticket == kNoHttpTicket) {
+      return;
+    }
+    log_info("SERVER_BATTLE_REQUEST: Left battle screen, cancelling request");
+    HttpWorker::get().cancel(battle_ticket);
+    battle_ticket = kNoHttpTicket;
+    pending_player_team = nlohmann::json();
+
+    auto request_opt =
+        afterhours::EntityHelper::get_singleton<BattleLoadRequest>();
+    if (request_opt.get().has<BattleLoadRequest>()) {
+      request_opt.get().get<BattleLoadRequest>().serverRequestPending = false;
     }
   }
 
-private:
   nlohmann::json build_player_team_json() {
     std::vector<std::reference_wrapper<afterhours::Entity>> inventory_dishes;
     for (afterhours::Entity &entity : afterhours::EntityQuery()
@@ -117,16 +117,14 @@ struct StartCourseSystem : afterhours::System<CombatQueue> {
       if (!player_has_remaining && !opponent_has_remaining) {
         // Both teams exhausted - battle is a tie
         cq.complete = true;
-        uint64_t fp = BattleFingerprint::compute();
-        log_info("AUDIT_FP checkpoint=end hash={}", fp);
+        BattleFingerprint::checkpoint("end");
         log_info("COMBAT_START: Battle ending - both teams exhausted");
         GameStateManager::get().to_results();
         return;
       } else if (!player_has_remaining || !opponent_has_remaining) {
         // One team exhausted - battle ends
         cq.complete = true;
-        uint64_t fp = BattleFingerprint::compute();
-        log_info("AUDIT_FP checkpoint=end hash={}", fp);
+        BattleFingerprint::checkpoint("end");
         log_info("COMBAT_START: Battle ending - Player remaining: {}, Opponent remaining: {}", 
                  player_has_remaining, opponent_has_remaining);
         GameStateManager::get().to_results();
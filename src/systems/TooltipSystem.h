@@ -20,17 +20,64 @@
 #include "../ui/text_formatting.h"
 #include <afterhours/ah.h>
 #include <magic_enum/magic_enum.hpp>
-#include <map>
+#include <optional>
 #include <sstream>
-
+#include <string>
+#include <unordered_map>
+
+// Dish tooltips are built from the dish, its level, its tags and the
+// shop's synergy counts. The text is cached per entity and only rebuilt
+// when one of those changes, and the layout (parsed segments, line breaks
+// and widths) comes from TextLayoutCache, so hovering costs a key compare
+// and a few DrawText calls per frame.
 struct RenderTooltipSystem : afterhours::System<HasRenderOrder, HasTooltip> {
-  GameStateManager::Screen current_screen;
+  // Everything a dish tooltip's text depends on
+  struct DishTooltipKey {
+    DishType type = DishType::Potato;
+    int level = 0;
+    int merge_progress = 0;
+    int merges_needed = 0;
+    int course_flags = 0;
+    int cuisine_flags = 0;
+    int brand_flags = 0;
+    int archetype_flags = 0;
+    std::optional<DrinkType> drink;
+    bool has_synergy = false;
+    int cuisine_count = 0;
+    int brand_count = 0;
+    int archetype_count = 0;
+
+    bool operator==(const DishTooltipKey &) const = default;
+  };
+
+  struct CachedTooltip {
+    DishTooltipKey key;
+    std::string text;
+  };
+
+  GameStateManager::Screen current_screen = GameStateManager::Screen::Main;
+  mutable std::unordered_map<afterhours::EntityID, CachedTooltip>
+      dish_tooltips;
+
+  // Resolved once per frame
+  vec2 mouse_pos = {0, 0};
+  const SynergyCounts *synergy = nullptr;
 
 public:
   virtual bool should_run(float) override {
     auto &gsm = GameStateManager::get();
+    if (gsm.active_screen != current_screen) {
+      // Entities from the previous screen are gone or will be rebuilt
+      dish_tooltips.clear();
+    }
     current_screen = gsm.active_screen;
-    return GameStateManager::should_render_tooltips(gsm.active_screen);
+    if (!GameStateManager::should_render_tooltips(gsm.active_screen)) {
+      return false;
+    }
+    mouse_pos = afterhours::input::get_mouse_position();
+    synergy =
+        afterhours::EntityHelper::get_singleton_cmp<SynergyCounts>();
+    return true;
   }
 
   virtual void for_each_with(const afterhours::Entity &entity,
@@ -41,7 +88,6 @@ public:
 
     const auto &transform = entity.get<Transform>();
 
-    vec2 mouse_pos = afterhours::input::get_mouse_position();
     Rectangle entity_rect = transform.rect();
 
     bool mouse_over = CheckCollisionPointRec(
@@ -53,220 +99,21 @@ public:
       return;
 
     // Generate dynamic tooltip for dishes with level information
-    std::string tooltip_text = tooltip.text;
-    if (entity.has<IsDish>() && entity.has<DishLevel>()) {
-      const auto &dish = entity.get<IsDish>();
-      const auto &level = entity.get<DishLevel>();
-      tooltip_text = generate_dish_tooltip_with_level(
-          dish.type, level.level, level.merge_progress, level.merges_needed);
-
-      // Add tags and synergy information
-      std::ostringstream tag_info;
-      bool has_tags = false;
-
-      if (entity.has<CourseTag>()) {
-        const auto &tag = entity.get<CourseTag>();
-        bool first = true;
-        for (auto course : magic_enum::enum_values<CourseTagType>()) {
-          if (tag.has(course)) {
-            if (first) {
-              tag_info << "\n[COLOR:Gold]Course: [COLOR:Text]";
-              first = false;
-            } else {
-              tag_info << ", ";
-            }
-            tag_info << magic_enum::enum_name(course);
-          }
-        }
-        if (!first) {
-          tag_info << "\n";
-          has_tags = true;
-        }
-      }
-
-      if (entity.has<CuisineTag>()) {
-        const auto &tag = entity.get<CuisineTag>();
-        bool first = true;
-        CuisineTagType first_cuisine = CuisineTagType::Thai;
-        for (auto cuisine : magic_enum::enum_values<CuisineTagType>()) {
-          if (tag.has(cuisine)) {
-            if (first) {
-              tag_info << "[COLOR:Gold]Cuisine: [COLOR:Text]";
-              first_cuisine = cuisine;
-              first = false;
-            } else {
-              tag_info << ", ";
-            }
-            tag_info << magic_enum::enum_name(cuisine);
-          }
-        }
-        if (!first) {
-          tag_info << "\n";
-          has_tags = true;
-
-          // Add synergy count for first cuisine tag with all thresholds
-          auto synergy_entity =
-              afterhours::EntityHelper::get_singleton<SynergyCounts>();
-          if (synergy_entity.get().has<SynergyCounts>()) {
-            const auto &synergy = synergy_entity.get().get<SynergyCounts>();
-            int count = synergy.get_count(first_cuisine);
-            std::vector<int> thresholds =
-                synergy.get_all_thresholds(first_cuisine);
-            tag_info << "[COLOR:Info]Synergy: [COLOR:Text]" << count
-                     << " dishes (";
-            bool first_threshold = true;
-            for (int threshold : thresholds) {
-              if (!first_threshold) {
-                tag_info << ", ";
-              }
-              if (count >= threshold) {
-                // Current or achieved threshold - normal color
-                tag_info << threshold;
-              } else {
-                // Future threshold - grayed out
-                tag_info << "[COLOR:TextMuted]" << threshold << "[COLOR:Text]";
-              }
-              first_threshold = false;
-            }
-            tag_info << ")\n";
-          }
-        }
-      }
-
-      if (entity.has<BrandTag>()) {
-        const auto &tag = entity.get<BrandTag>();
-        bool first = true;
-        BrandTagType first_brand = BrandTagType::LocalFarm;
-        for (auto brand : magic_enum::enum_values<BrandTagType>()) {
-          if (tag.has(brand)) {
-            if (first) {
-              tag_info << "[COLOR:Gold]Brand: [COLOR:Text]";
-              first_brand = brand;
-              first = false;
-            } else {
-              tag_info << ", ";
-            }
-            tag_info << magic_enum::enum_name(brand);
-          }
-        }
-        if (!first) {
-          tag_info << "\n";
-          has_tags = true;
-
-          // Add synergy count for first brand tag
-          auto synergy_entity =
-              afterhours::EntityHelper::get_singleton<SynergyCounts>();
-          if (synergy_entity.get().has<SynergyCounts>()) {
-            const auto &synergy = synergy_entity.get().get<SynergyCounts>();
-            int count = synergy.get_count(first_brand);
-            std::vector<int> thresholds =
-                synergy.get_all_thresholds(first_brand);
-            tag_info << "[COLOR:Info]Synergy: [COLOR:Text]" << count
-                     << " dishes (";
-            bool first_threshold = true;
-            for (int threshold : thresholds) {
-              if (!first_threshold) {
-                tag_info << ", ";
-              }
-              if (count >= threshold) {
-                tag_info << threshold;
-              } else {
-                tag_info << "[COLOR:TextMuted]" << threshold << "[COLOR:Text]";
-              }
-              first_threshold = false;
-            }
-            tag_info << ")\n";
-          }
-        }
-      }
+    const std::string &tooltip_text =
+        entity.has<IsDish>() && entity.has<DishLevel>()
+            ? dish_tooltip_text(entity)
+            : tooltip.text;
 
-      if (entity.has<DishArchetypeTag>()) {
-        const auto &tag = entity.get<DishArchetypeTag>();
-        bool first = true;
-        DishArchetypeTagType first_archetype = DishArchetypeTagType::Bread;
-        for (auto archetype : magic_enum::enum_values<DishArchetypeTagType>()) {
-          if (tag.has(archetype)) {
-            if (first) {
-              tag_info << "[COLOR:Gold]Archetype: [COLOR:Text]";
-              first_archetype = archetype;
-              first = false;
-            } else {
-              tag_info << ", ";
-            }
-            tag_info << magic_enum::enum_name(archetype);
-          }
-        }
-        if (!first) {
-          tag_info << "\n";
-          has_tags = true;
-
-          // Add synergy count for first archetype tag
-          auto synergy_entity =
-              afterhours::EntityHelper::get_singleton<SynergyCounts>();
-          if (synergy_entity.get().has<SynergyCounts>()) {
-            const auto &synergy = synergy_entity.get().get<SynergyCounts>();
-            int count = synergy.get_count(first_archetype);
-            std::vector<int> thresholds =
-                synergy.get_all_thresholds(first_archetype);
-            tag_info << "[COLOR:Info]Synergy: [COLOR:Text]" << count
-                     << " dishes (";
-            bool first_threshold = true;
-            for (int threshold : thresholds) {
-              if (!first_threshold) {
-                tag_info << ", ";
-              }
-              if (count >= threshold) {
-                tag_info << threshold;
-              } else {
-                tag_info << "[COLOR:TextMuted]" << threshold << "[COLOR:Text]";
-              }
-              first_threshold = false;
-            }
-            tag_info << ")\n";
-          }
-        }
-      }
-
-      if (has_tags) {
-        tooltip_text += tag_info.str();
-      }
-
-      // Add drink pairing information
-      if (entity.has<DrinkPairing>()) {
-        const auto &drink_pairing = entity.get<DrinkPairing>();
-        if (drink_pairing.drink.has_value()) {
-          DrinkType drink_type = drink_pairing.drink.value();
-          DrinkInfo drink_info = get_drink_info(drink_type);
-          // TODO add information about the drink
-          tooltip_text += "\n[COLOR:Info]Drink: [COLOR:Text]" + drink_info.name + "\n";
-        }
-      }
-    }
+    const text_formatting::TextLayout &layout =
+        text_formatting::TextLayoutCache::get().layout(
+            tooltip_text, text_formatting::FormattingContext::Tooltip,
+            tooltip.font_size, tooltip.text_color);
 
     float tooltip_x = mouse_pos.x + 10; // Offset from mouse
     float tooltip_y = mouse_pos.y - 30; // Above mouse
 
-    // Calculate tooltip dimensions by measuring each line separately
-    std::istringstream measure_stream(tooltip_text);
-    std::string measure_line;
-    float max_line_width = 0.0f;
-    int line_count = 0;
-
-    while (std::getline(measure_stream, measure_line)) {
-      line_count++;
-      // Remove color markers for width calculation using formatting system
-      std::string clean_line =
-          text_formatting::TextFormatting::strip_formatting_codes(measure_line);
-      float line_width = render_backend::MeasureTextWithActiveFont(
-          clean_line.c_str(), tooltip.font_size);
-      if (line_width > max_line_width) {
-        max_line_width = line_width;
-      }
-    }
-
-    float tooltip_width = max_line_width + tooltip.padding * 2;
-    float tooltip_height =
-        (tooltip.font_size * line_count) + tooltip.padding * 2;
+    float tooltip_width = layout.width + tooltip.padding * 2;
+    float tooltip_height = layout.height() + tooltip.padding * 2;
 
     // Get screen dimensions
     float screen_width = static_cast<float>(raylib::GetScreenWidth());
@@ -318,9 +165,174 @@ public:
                                static_cast<int>(tooltip_height), raylib::WHITE);
 
     // Draw tooltip text with color support using formatting system
-    text_formatting::render_formatted_text_multiline(
-        tooltip_text, static_cast<int>(tooltip_x + tooltip.padding),
-        static_cast<int>(tooltip_y + tooltip.padding), tooltip.font_size,
-        text_formatting::FormattingContext::Tooltip, tooltip.text_color);
+    text_formatting::draw_text_layout(
+        layout, static_cast<int>(tooltip_x + tooltip.padding),
+        static_cast<int>(tooltip_y + tooltip.padding));
+  }
+
+private:
+  template <typename TagType> static TagType first_tag(int flags) {
+    return static_cast<TagType>(flags & -flags);
+  }
+
+  DishTooltipKey dish_tooltip_key(const afterhours::Entity &entity) const {
+    const auto &level = entity.get<DishLevel>();
+    DishTooltipKey key;
+    key.type = entity.get<IsDish>().type;
+    key.level = level.level;
+    key.merge_progress = level.merge_progress;
+    key.merges_needed = level.merges_needed;
+    if (entity.has<CourseTag>()) {
+      key.course_flags = entity.get<CourseTag>().flags;
+    }
+    if (entity.has<CuisineTag>()) {
+      key.cuisine_flags = entity.get<CuisineTag>().flags;
+    }
+    if (entity.has<BrandTag>()) {
+      key.brand_flags = entity.get<BrandTag>().flags;
+    }
+    if (entity.has<DishArchetypeTag>()) {
+      key.archetype_flags = entity.get<DishArchetypeTag>().flags;
+    }
+    if (entity.has<DrinkPairing>()) {
+      key.drink = entity.get<DrinkPairing>().drink;
+    }
+
+    // Only the first tag of each kind shows a synergy count
+    key.has_synergy = synergy != nullptr;
+    if (synergy) {
+      if (key.cuisine_flags) {
+        key.cuisine_count =
+            synergy->get_count(first_tag<CuisineTagType>(key.cuisine_flags));
+      }
+      if (key.brand_flags) {
+        key.brand_count =
+            synergy->get_count(first_tag<BrandTagType>(key.brand_flags));
+      }
+      if (key.archetype_flags) {
+        key.archetype_count = synergy->get_count(
+            first_tag<DishArchetypeTagType>(key.archetype_flags));
+      }
+    }
+    return key;
+  }
+
+  const std::string &dish_tooltip_text(const afterhours::Entity &entity) const {
+    DishTooltipKey key = dish_tooltip_key(entity);
+    auto it = dish_tooltips.find(entity.id);
+    if (it != dish_tooltips.end() && it->second.key == key) {
+      return it->second.text;
+    }
+
+    CachedTooltip &cached = dish_tooltips[entity.id];
+    cached.key = key;
+    cached.text = build_dish_tooltip(key);
+    return cached.text;
+  }
+
+  template <typename TagType>
+  static void append_synergy(std::ostringstream &tag_info,
+                             const SynergyCounts &synergy, TagType tag,
+                             int count) {
+    std::vector<int> thresholds = synergy.get_all_thresholds(tag);
+    tag_info << "[COLOR:Info]Synergy: [COLOR:Text]" << count << " dishes (";
+    bool first_threshold = true;
+    for (int threshold : thresholds) {
+      if (!first_threshold) {
+        tag_info << ", ";
+      }
+      if (count >= threshold) {
+        // Current or achieved threshold - normal color
+        tag_info << threshold;
+      } else {
+        // Future threshold - grayed out
+        tag_info << "[COLOR:TextMuted]" << threshold << "[COLOR:Text]";
+      }
+      first_threshold = false;
+    }
+    tag_info << ")\n";
+  }
+
+  // Lists the tags set in flags; returns false if there were none
+  template <typename TagType>
+  static bool append_tag_names(std::ostringstream &tag_info, int flags,
+                               const char *label) {
+    bool first = true;
+    for (auto tag : magic_enum::enum_values<TagType>()) {
+      if ((flags & static_cast<int>(tag)) == 0) {
+        continue;
+      }
+      if (first) {
+        tag_info << label;
+        first = false;
+      } else {
+        tag_info << ", ";
+      }
+      tag_info << magic_enum::enum_name(tag);
+    }
+    return !first;
+  }
+
+  std::string build_dish_tooltip(const DishTooltipKey &key) const {
+    std::string tooltip_text = generate_dish_tooltip_with_level(
+        key.type, key.level, key.merge_progress, key.merges_needed);
+
+    // Add tags and synergy information
+    std::ostringstream tag_info;
+    bool has_tags = false;
+
+    if (append_tag_names<CourseTagType>(
+            tag_info, key.course_flags,
+            "\n[COLOR:Gold]Course: [COLOR:Text]")) {
+      tag_info << "\n";
+      has_tags = true;
+    }
+
+    if (append_tag_names<CuisineTagType>(tag_info, key.cuisine_flags,
+                                         "[COLOR:Gold]Cuisine: [COLOR:Text]")) {
+      tag_info << "\n";
+      has_tags = true;
+      if (synergy) {
+        append_synergy(tag_info, *synergy,
+                       first_tag<CuisineTagType>(key.cuisine_flags),
+                       key.cuisine_count);
+      }
+    }
+
+    if (append_tag_names<BrandTagType>(tag_info, key.brand_flags,
+                                       "[COLOR:Gold]Brand: [COLOR:Text]")) {
+      tag_info << "\n";
+      has_tags = true;
+      if (synergy) {
+        append_synergy(tag_info, *synergy,
+                       first_tag<BrandTagType>(key.brand_flags),
+                       key.brand_count);
+      }
+    }
+
+    if (append_tag_names<DishArchetypeTagType>(
+            tag_info, key.archetype_flags,
+            "[COLOR:Gold]Archetype: [COLOR:Text]")) {
+      tag_info << "\n";
+      has_tags = true;
+      if (synergy) {
+        append_synergy(tag_info, *synergy,
+                       first_tag<DishArchetypeTagType>(key.archetype_flags),
+                       key.archetype_count);
+      }
+    }
+
+    if (has_tags) {
+      tooltip_text += tag_info.str();
+    }
+
+    // Add drink pairing information
+    if (key.drink.has_value()) {
+      const DrinkInfo &drink_info = get_drink_info(key.drink.value());
+      // TODO add information about the drink
+      tooltip_text +=
+          "\n[COLOR:Info]Drink: [COLOR:Text]" + drink_info.name + "\n";
+    }
+    return tooltip_text;
   }
 };
@@ -121,9 +121,7 @@ private:
     int get_entity_zing(int sourceEntityId) const {
       if (sourceEntityId <= 0)
         return 0;
-      if (auto ea = EQ({.ignore_temp_warning = true})
-                        .whereID(sourceEntityId)
-                        .gen_first()) {
+      if (auto ea = EQ::find_by_id(sourceEntityId)) {
         if (ea->has<CombatStats>()) {
           return ea->get<CombatStats>().baseZing;
         } else {
@@ -31,7 +31,8 @@ struct AnimationSchedulerSystem
     // Schedule animation using consistent timer-based approach
     switch (ev.type) {
     case AnimationEventType::SlideIn: {
-      log_info("ANIM schedule: SlideIn (event id={})", e.id);
+      log_info_c(LogCategory::ANIM, "ANIM schedule: SlideIn (event id={})",
+                 e.id);
       e.addComponent<AnimationTimer>();
       auto &timer = e.get<AnimationTimer>();
       timer.duration = BattleTiming::get_slide_in_duration();
@@ -42,7 +43,8 @@ struct AnimationSchedulerSystem
       if (!e.has<AnimationEvent>()) {
         break;
       }
-      log_info("ANIM schedule: StatBoost (event id={})", e.id);
+      log_info_c(LogCategory::ANIM, "ANIM schedule: StatBoost (event id={})",
+                 e.id);
       e.addComponent<AnimationTimer>();
       auto &timer = e.get<AnimationTimer>();
       timer.duration = BattleTiming::get_stat_boost_duration();
@@ -53,7 +55,8 @@ struct AnimationSchedulerSystem
       if (!e.has<AnimationEvent>()) {
         break;
       }
-      log_info("ANIM schedule: FreshnessChain (event id={})", e.id);
+      log_info_c(LogCategory::ANIM,
+                 "ANIM schedule: FreshnessChain (event id={})", e.id);
       e.addComponent<AnimationTimer>();
       auto &timer = e.get<AnimationTimer>();
       timer.duration = BattleTiming::get_freshness_chain_duration();
@@ -92,7 +95,7 @@ struct AnimationTimerSystem : afterhours::System<AnimationTimer> {
                 }
 
                 if (timer.elapsed >= timer.duration) {
-                  log_info("ANIM complete: Timer-based animation (event id={}), elapsed={}, duration={}", 
+                  log_info_c(LogCategory::ANIM, "ANIM complete: Timer-based animation (event id={}), elapsed={}, duration={}", 
                            (int)e.id, timer.elapsed, timer.duration);
 
                   // Clean up animation components
@@ -84,6 +84,8 @@ TestApp &TestApp::launch_game(const std::source_location &loc) {
       req.loaded = false;
       req.playerJsonPath = "";
       req.opponentJsonPath = "";
+      req.playerTeamJson = nlohmann::json();
+      req.opponentTeamJson = nlohmann::json();
       log_info("TEST_APP: launch_game - Reset BattleLoadRequest");
     }
   }
@@ -13,9 +13,11 @@
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
 TEST(validate_server_checksum_match) {
   static std::string server_checksum;
+  static std::vector<std::string> server_checkpoints;
 
   app.launch_game();
   app.wait_for_ui_exists("Play");
@@ -71,6 +73,11 @@ TEST(validate_server_checksum_match) {
                   "server response should contain seed");
 
   server_checksum = battle_response["checksum"].get<std::string>();
+  server_checkpoints.clear();
+  for (const auto &cp : battle_response.value("checkpoints",
+                                              nlohmann::json::array())) {
+    server_checkpoints.push_back(cp.value("hash", std::string("")));
+  }
   uint64_t server_seed = battle_response["seed"].get<uint64_t>();
 
   log_info("CHECKSUM_TEST: Server checksum: {}", server_checksum);
@@ -91,10 +98,15 @@ TEST(validate_server_checksum_match) {
 
   // Compute client checksum
   app.wait_for_frames(1); // Entities will be merged by system loop
-  uint64_t client_fingerprint = BattleFingerprint::compute();
+  uint64_t client_fingerprint = BattleFingerprint::final_hash();
   std::string client_checksum =
       test_server_helpers::format_checksum(client_fingerprint);
 
+  int divergence = BattleFingerprint::first_divergence(
+      BattleFingerprint::checkpoint_hashes(), server_checkpoints);
+  app.expect_eq(divergence, -1,
+                "client and server fingerprint checkpoints should match");
+
   log_info("CHECKSUM_TEST: Client checksum: {}", client_checksum);
   log_info("CHECKSUM_TEST: Server checksum: {}", server_checksum);
 
@@ -60,8 +60,8 @@ TEST(validate_server_opponent_match) {
   app.expect_false(req.opponentJsonPath.empty(),
                    "opponentJsonPath should be set by server");
 
-  log_info("OPPONENT_MATCH_TEST: Reading opponent JSON from: {}",
-           req.opponentJsonPath);
+  app.expect_false(req.opponentTeamJson.is_null(),
+                   "opponentTeamJson should be set from the server response");
 
   // Wait for battle to initialize
   app.wait_for_battle_initialized(30.0f);
@@ -73,9 +73,7 @@ TEST(validate_server_opponent_match) {
   // Also need to wait for all opponent dishes to be created and assigned
   app.wait_for_frames(60);
 
-  // Read opponent JSON file
-  nlohmann::json opponent_json =
-      test_server_helpers::read_json_file(app, req.opponentJsonPath);
+  const nlohmann::json &opponent_json = req.opponentTeamJson;
 
   app.expect_true(opponent_json.contains("team"),
                   "opponent JSON should contain 'team' array");
@@ -19,6 +19,10 @@ struct TextureLibrary {
   void load(const char *const filename, const char *const name) {
     impl.load(filename, name);
   }
+  // For textures already uploaded by AssetLoader
+  void add(const char *const name, raylib::Texture2D texture) {
+    impl.add(name, texture);
+  }
 
   void unload_all() { impl.unload_all(); }
 
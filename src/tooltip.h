@@ -111,7 +111,7 @@ static std::string format_effect_description(const DishEffect &effect) {
   }
   case EffectOperation::SummonDish: {
     if (effect.summonDishType.has_value()) {
-      auto dish_info = get_dish_info(effect.summonDishType.value());
+      const auto &dish_info = get_dish_info(effect.summonDishType.value());
       desc << "Summon " << dish_info.name << " to " << target;
     } else {
       desc << "Summon dish to " << target;
@@ -130,7 +130,7 @@ static std::string format_effect_description(const DishEffect &effect) {
 }
 
 inline std::string generate_dish_tooltip(DishType dishType) {
-  auto dishInfo = get_dish_info(dishType);
+  const auto &dishInfo = get_dish_info(dishType);
   std::ostringstream tooltip;
 
   tooltip << "[COLOR:Gold]" << dishInfo.name << "\n";
@@ -167,7 +167,7 @@ inline std::string generate_dish_tooltip_with_level(DishType dishType,
                                                     int level,
                                                     int merge_progress,
                                                     int merges_needed) {
-  auto dishInfo = get_dish_info(dishType, level);
+  const auto &dishInfo = get_dish_info(dishType, level);
   std::ostringstream tooltip;
 
   tooltip << "[COLOR:Gold]" << dishInfo.name << "\n";
@@ -5,9 +5,13 @@
 #include "../rl.h"
 #include <afterhours/src/plugins/color.h>
 #include <afterhours/src/plugins/ui/theme.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace text_formatting {
@@ -376,6 +380,231 @@ private:
   }
 };
 
+// A formatted string split into lines, with every segment measured and
+// positioned once so drawing it is only DrawText calls
+struct LayoutSegment {
+  FormattedSegment segment;
+  float x = 0.0f;
+  float width = 0.0f;
+};
+
+struct LayoutLine {
+  std::vector<LayoutSegment> segments;
+  float width = 0.0f;
+};
+
+struct TextLayout {
+  std::vector<LayoutLine> lines;
+  float width = 0.0f;
+  float font_size = 0.0f;
+
+  float height() const {
+    return font_size * static_cast<float>(lines.size());
+  }
+};
+
+inline void append_layout_segment(LayoutLine &line,
+                                  const FormattedSegment &style,
+                                  const std::string &text, float font_size) {
+  if (text.empty()) {
+    return;
+  }
+  float width =
+      render_backend::MeasureTextWithActiveFont(text.c_str(), font_size);
+  line.segments.push_back(
+      {FormattedSegment(text, style.color, style.is_bold, style.is_italic),
+       line.width, width});
+  line.width += width;
+}
+
+// Word-wraps one segment onto the layout, starting new lines whenever the
+// next word would run past wrap_width
+inline void layout_wrapped_segment(TextLayout &layout,
+                                   const FormattedSegment &segment,
+                                   float font_size, float wrap_width) {
+  const std::string &text = segment.text;
+  std::string pending;
+  float pending_width = 0.0f;
+  bool line_wrapped = false;
+  size_t pos = 0;
+
+  while (pos < text.length()) {
+    size_t word_end = text.find(' ', pos);
+    if (word_end == std::string::npos) {
+      word_end = text.length();
+    }
+    size_t token_end = text.find_first_not_of(' ', word_end);
+    if (token_end == std::string::npos) {
+      token_end = text.length();
+    }
+
+    std::string word = text.substr(pos, word_end - pos);
+    float word_width =
+        render_backend::MeasureTextWithActiveFont(word.c_str(), font_size);
+    float used = layout.lines.back().width + pending_width;
+    if (used > 0.0f && used + word_width > wrap_width) {
+      pending.erase(pending.find_last_not_of(' ') + 1);
+      append_layout_segment(layout.lines.back(), segment, pending, font_size);
+      layout.lines.emplace_back();
+      pending.clear();
+      pending_width = 0.0f;
+      line_wrapped = true;
+    }
+
+    // Wrapped lines don't start with the space that split them
+    std::string token = text.substr(pos, token_end - pos);
+    if (line_wrapped && pending.empty() && word.empty()) {
+      pos = token_end;
+      continue;
+    }
+    pending += token;
+    pending_width +=
+        render_backend::MeasureTextWithActiveFont(token.c_str(), font_size);
+    pos = token_end;
+  }
+
+  append_layout_segment(layout.lines.back(), segment, pending, font_size);
+}
+
+// Lines are split like std::getline, so a trailing newline doesn't add an
+// empty line. wrap_width <= 0 disables word wrapping.
+inline TextLayout build_text_layout(const std::string &text,
+                                    FormattingContext context, float font_size,
+                                    raylib::Color default_color,
+                                    float wrap_width = 0.0f) {
+  TextLayout layout;
+  layout.font_size = font_size;
+
+  size_t line_start = 0;
+  while (line_start < text.length()) {
+    size_t line_end = text.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = text.length();
+    }
+
+    layout.lines.emplace_back();
+    std::vector<FormattedSegment> segments =
+        TextFormatting::parse_formatting_codes(
+            text.substr(line_start, line_end - line_start), context,
+            default_color);
+    for (const auto &segment : segments) {
+      if (wrap_width > 0.0f) {
+        layout_wrapped_segment(layout, segment, font_size, wrap_width);
+      } else {
+        append_layout_segment(layout.lines.back(), segment, segment.text,
+                              font_size);
+      }
+    }
+
+    line_start = line_end + 1;
+  }
+
+  for (const auto &line : layout.lines) {
+    layout.width = std::max(layout.width, line.width);
+  }
+  return layout;
+}
+
+// Layouts keyed by (text hash, context, font, size, wrap width, default
+// color). Tooltips and HUD strings are mostly the same from frame to
+// frame, so after the first frame drawing one skips parsing, line
+// splitting and measuring entirely. The stored text is compared on a hit,
+// so a hash collision only costs a rebuild.
+class TextLayoutCache {
+public:
+  static constexpr size_t kMaxEntries = 512;
+
+  static TextLayoutCache &get() {
+    static TextLayoutCache instance;
+    return instance;
+  }
+
+  // The reference stays valid until the next call to layout() or clear()
+  const TextLayout &layout(const std::string &text, FormattingContext context,
+                           float font_size,
+                           raylib::Color default_color = raylib::WHITE,
+                           float wrap_width = 0.0f) {
+    Key key{std::hash<std::string>{}(text),
+            context,
+            get_active_font_id(),
+            font_size,
+            wrap_width,
+            pack_color(default_color)};
+
+    auto it = entries.find(key);
+    if (it != entries.end() && it->second.text == text) {
+      return it->second.layout;
+    }
+
+    // Strings with counters in them (gold, timers) never repeat, so the
+    // cache is dropped wholesale rather than growing without bound
+    if (it == entries.end() && entries.size() >= kMaxEntries) {
+      entries.clear();
+    }
+
+    Entry &entry = entries[key];
+    entry.text = text;
+    entry.layout = build_text_layout(text, context, font_size, default_color,
+                                     wrap_width);
+    return entry.layout;
+  }
+
+  void clear() { entries.clear(); }
+  size_t size() const { return entries.size(); }
+
+private:
+  struct Key {
+    size_t text_hash;
+    FormattingContext context;
+    FontID font;
+    float font_size;
+    float wrap_width;
+    uint32_t default_color;
+
+    bool operator==(const Key &) const = default;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      size_t hash = key.text_hash;
+      auto combine = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+      };
+      combine(static_cast<size_t>(key.context));
+      combine(static_cast<size_t>(key.font));
+      combine(std::hash<float>{}(key.font_size));
+      combine(std::hash<float>{}(key.wrap_width));
+      combine(key.default_color);
+      return hash;
+    }
+  };
+
+  struct Entry {
+    std::string text;
+    TextLayout layout;
+  };
+
+  static uint32_t pack_color(raylib::Color color) {
+    return (static_cast<uint32_t>(color.r) << 24) |
+           (static_cast<uint32_t>(color.g) << 16) |
+           (static_cast<uint32_t>(color.b) << 8) | color.a;
+  }
+
+  std::unordered_map<Key, Entry, KeyHash> entries;
+};
+
+inline void draw_text_layout(const TextLayout &layout, int posX, int posY) {
+  float current_y = static_cast<float>(posY);
+  for (const auto &line : layout.lines) {
+    for (const auto &placed : line.segments) {
+      render_backend::DrawTextWithActiveFont(
+          placed.segment.text.c_str(), static_cast<int>(posX + placed.x),
+          static_cast<int>(current_y), layout.font_size, placed.segment.color);
+    }
+    current_y += layout.font_size;
+  }
+}
+
 inline std::string format_stat_change(int value) {
   if (value > 0) {
     return "[COLOR:Positive]+" + std::to_string(value) + "[/COLOR]";
@@ -410,21 +639,9 @@ format_health(int current, int max,
 inline void render_formatted_text(const std::string &text, int posX, int posY,
                                   float fontSize, FormattingContext context,
                                   raylib::Color default_color = raylib::WHITE) {
-  std::vector<FormattedSegment> segments =
-      TextFormatting::parse_formatting_codes(text, context, default_color);
-
-  float current_x = static_cast<float>(posX);
-  float current_y = static_cast<float>(posY);
-
-  for (const auto &segment : segments) {
-    if (!segment.text.empty()) {
-      render_backend::DrawTextWithActiveFont(
-          segment.text.c_str(), static_cast<int>(current_x),
-          static_cast<int>(current_y), fontSize, segment.color);
-      current_x += render_backend::MeasureTextWithActiveFont(
-          segment.text.c_str(), fontSize);
-    }
-  }
+  draw_text_layout(TextLayoutCache::get().layout(text, context, fontSize,
+                                                 default_color),
+                   posX, posY);
 }
 
 inline float measure_formatted_text(const std::string &text, float fontSize) {
@@ -436,29 +653,11 @@ inline float measure_formatted_text(const std::string &text, float fontSize) {
 inline void
 render_formatted_text_multiline(const std::string &text, int posX, int posY,
                                 float fontSize, FormattingContext context,
-                                raylib::Color default_color = raylib::WHITE) {
-  float current_y = static_cast<float>(posY);
-  std::istringstream text_stream(text);
-  std::string line;
-
-  while (std::getline(text_stream, line)) {
-    float current_x = static_cast<float>(posX);
-
-    std::vector<FormattedSegment> segments =
-        TextFormatting::parse_formatting_codes(line, context, default_color);
-
-    for (const auto &segment : segments) {
-      if (!segment.text.empty()) {
-        render_backend::DrawTextWithActiveFont(
-            segment.text.c_str(), static_cast<int>(current_x),
-            static_cast<int>(current_y), fontSize, segment.color);
-        current_x += render_backend::MeasureTextWithActiveFont(
-            segment.text.c_str(), fontSize);
-      }
-    }
-
-    current_y += fontSize;
-  }
+                                raylib::Color default_color = raylib::WHITE,
+                                float wrap_width = 0.0f) {
+  draw_text_layout(TextLayoutCache::get().layout(text, context, fontSize,
+                                                 default_color, wrap_width),
+                   posX, posY);
 }
 
 } // namespace text_formatting
@@ -11,6 +11,7 @@
 
 #include "../components/battle_history.h"
 #include "../components/battle_load_request.h"
+#include "../components/combat_queue.h"
 #include "../components/continue_button_disabled.h"
 #include "../components/continue_game_request.h"
 #include "../components/is_draggable.h"
@@ -41,6 +42,7 @@
 #include "metrics.h"
 #include "navigation.h"
 #include <afterhours/src/plugins/texture_manager.h>
+#include <cmath>
 #include <cstdlib>
 #include <filesystem>
 #include <fmt/format.h>
@@ -682,23 +684,34 @@ Screen ScheduleMainMenuUI::battle_screen(Entity &entity,
           0, "replay_play_pause_button"); // Unique debug name for test
                                           // identification
 
-      // Progress slider (read-only for now - calculate progress from frames)
-      // totalFrames is captured from the server simulation when it completes
-      float progress = rs.totalFrames > 0
-                           ? std::clamp(static_cast<float>(rs.currentFrame) /
-                                            static_cast<float>(rs.totalFrames),
-                                        0.0f, 1.0f)
-                           : 0.0f;
-
-      // Use a local variable for the slider value (non-modifiable)
-      float progress_display = progress;
-      // Create slider but don't handle changes (makes it read-only)
-      slider(context, mk(replay_bar.ent(), 1), progress_display,
-             ComponentConfig{}
-                 .with_debug_name("replay_progress")
-                 .with_disabled(true),
-             SliderHandleValueLabelPosition::OnHandle);
-      // Slider is disabled to prevent dragging
+      // Scrub bar over the courses. The server's checkpoints are the start,
+      // one per course and the end, so they give the battle's course count.
+      int courses = rs.serverCheckpoints.size() > 2
+                        ? static_cast<int>(rs.serverCheckpoints.size()) - 2
+                        : rs.totalCourses;
+      auto combatQueue = afterhours::EntityHelper::get_singleton<CombatQueue>();
+      int course = rs.seekCourse.value_or(
+          combatQueue.get().has<CombatQueue>()
+              ? combatQueue.get().get<CombatQueue>().current_index
+              : 0);
+      float progress =
+          courses > 1 ? std::clamp(static_cast<float>(course) /
+                                       static_cast<float>(courses - 1),
+                                   0.0f, 1.0f)
+                      : 0.0f;
+
+      if (auto result = slider(
+              context, mk(replay_bar.ent(), 1), progress,
+              ComponentConfig{}.with_debug_name("replay_progress"),
+              SliderHandleValueLabelPosition::OnHandle)) {
+        int target = static_cast<int>(
+            std::lround(result.template as<float>() *
+                        static_cast<float>(std::max(courses - 1, 0))));
+        if (target != course) {
+          replayState.get().get<ReplayState>().seek_to_course(target);
+          log_info("REPLAY_SEEK (from scrub bar) course {}", target);
+        }
+      }
 
       // Speed indicator (text label) - show battle speed, not replay timeScale
       std::string speed_text =
@@ -981,6 +994,10 @@ Screen ScheduleMainMenuUI::history_screen(Entity &entity,
                       request.opponentJsonPath =
                           "output/battles/temp_opponent_" +
                           std::to_string(report_seed) + ".json";
+                      // Replays read the saved files, not the last battle's
+                      // in-memory teams
+                      request.playerTeamJson = nlohmann::json();
+                      request.opponentTeamJson = nlohmann::json();
                       request.loaded = false;
                     }
                   } else {
@@ -0,0 +1,270 @@
+#include "battle_event_log.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <magic_enum/magic_enum.hpp>
+
+namespace {
+constexpr std::array<uint8_t, 4> kMagic = {'M', 'N', 'C', 'E'};
+constexpr uint8_t kHookMask = 0x07;
+constexpr uint8_t kOpponentSide = 0x08;
+constexpr uint8_t kSameTimestamp = 0x10;
+constexpr uint8_t kHasPayloadFloat = 0x20;
+static_assert(magic_enum::enum_count<TriggerHook>() <= kHookMask + 1,
+              "TriggerHook no longer fits in the event log flags byte");
+
+constexpr char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void write_varint(std::vector<uint8_t> &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+void write_u32(std::vector<uint8_t> &out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+struct Reader {
+  const std::vector<uint8_t> &bytes;
+  size_t pos = 0;
+
+  bool varint(uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos >= bytes.size()) {
+        return false;
+      }
+      uint8_t byte = bytes[pos++];
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool signed_varint(int &value) {
+    uint64_t raw = 0;
+    if (!varint(raw)) {
+      return false;
+    }
+    value = static_cast<int>(unzigzag(raw));
+    return true;
+  }
+
+  bool u32(uint32_t &value) {
+    if (pos + 4 > bytes.size()) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      value |= static_cast<uint32_t>(bytes[pos++]) << (8 * i);
+    }
+    return true;
+  }
+};
+} // namespace
+
+void BattleEventLog::clear() {
+  data.assign(kMagic.begin(), kMagic.end());
+  data.push_back(kVersion);
+  count = 0;
+  last_timestamp_bits = 0;
+}
+
+void BattleEventLog::append(const server::async::DebugBattleEvent &ev) {
+  uint32_t timestamp_bits = std::bit_cast<uint32_t>(ev.timestamp);
+  uint32_t payload_float_bits = std::bit_cast<uint32_t>(ev.payloadFloat);
+
+  uint8_t flags = static_cast<uint8_t>(static_cast<uint8_t>(ev.hook) &
+                                       kHookMask);
+  if (ev.teamSide == DishBattleState::TeamSide::Opponent) {
+    flags |= kOpponentSide;
+  }
+  bool same_timestamp = count > 0 && timestamp_bits == last_timestamp_bits;
+  if (same_timestamp) {
+    flags |= kSameTimestamp;
+  }
+  if (payload_float_bits != 0) {
+    flags |= kHasPayloadFloat;
+  }
+  data.push_back(flags);
+
+  if (!same_timestamp) {
+    write_varint(data, zigzag(static_cast<int64_t>(timestamp_bits) -
+                              static_cast<int64_t>(last_timestamp_bits)));
+    last_timestamp_bits = timestamp_bits;
+  }
+  write_varint(data, zigzag(ev.sourceEntityId));
+  write_varint(data, zigzag(ev.slotIndex));
+  write_varint(data, zigzag(ev.courseIndex));
+  write_varint(data, zigzag(ev.payloadInt));
+  if (payload_float_bits != 0) {
+    write_u32(data, payload_float_bits);
+  }
+  count++;
+}
+
+std::optional<std::vector<server::async::DebugBattleEvent>>
+BattleEventLog::decode(const std::vector<uint8_t> &bytes) {
+  if (bytes.size() < kMagic.size() + 1 ||
+      !std::equal(kMagic.begin(), kMagic.end(), bytes.begin()) ||
+      bytes[kMagic.size()] != kVersion) {
+    return std::nullopt;
+  }
+
+  std::vector<server::async::DebugBattleEvent> events;
+  Reader reader{bytes, kMagic.size() + 1};
+  uint32_t timestamp_bits = 0;
+
+  while (reader.pos < bytes.size()) {
+    uint8_t flags = bytes[reader.pos++];
+    auto hook = magic_enum::enum_cast<TriggerHook>(flags & kHookMask);
+    if (!hook) {
+      return std::nullopt;
+    }
+
+    server::async::DebugBattleEvent ev{};
+    ev.hook = *hook;
+    ev.teamSide = (flags & kOpponentSide) ? DishBattleState::TeamSide::Opponent
+                                          : DishBattleState::TeamSide::Player;
+
+    if (!(flags & kSameTimestamp)) {
+      uint64_t delta = 0;
+      if (!reader.varint(delta)) {
+        return std::nullopt;
+      }
+      timestamp_bits = static_cast<uint32_t>(
+          static_cast<int64_t>(timestamp_bits) + unzigzag(delta));
+    }
+    ev.timestamp = std::bit_cast<float>(timestamp_bits);
+
+    if (!reader.signed_varint(ev.sourceEntityId) ||
+        !reader.signed_varint(ev.slotIndex) ||
+        !reader.signed_varint(ev.courseIndex) ||
+        !reader.signed_varint(ev.payloadInt)) {
+      return std::nullopt;
+    }
+
+    uint32_t payload_float_bits = 0;
+    if ((flags & kHasPayloadFloat) && !reader.u32(payload_float_bits)) {
+      return std::nullopt;
+    }
+    ev.payloadFloat = std::bit_cast<float>(payload_float_bits);
+
+    events.push_back(ev);
+  }
+
+  return events;
+}
+
+std::string BattleEventLog::to_base64(const std::vector<uint8_t> &bytes) {
+  std::string out;
+  out.reserve((bytes.size() + 2) / 3 * 4);
+  for (size_t i = 0; i < bytes.size(); i += 3) {
+    uint32_t chunk = static_cast<uint32_t>(bytes[i]) << 16;
+    if (i + 1 < bytes.size())
+      chunk |= static_cast<uint32_t>(bytes[i + 1]) << 8;
+    if (i + 2 < bytes.size())
+      chunk |= bytes[i + 2];
+
+    out.push_back(kBase64Chars[(chunk >> 18) & 0x3f]);
+    out.push_back(kBase64Chars[(chunk >> 12) & 0x3f]);
+    out.push_back(i + 1 < bytes.size() ? kBase64Chars[(chunk >> 6) & 0x3f]
+                                       : '=');
+    out.push_back(i + 2 < bytes.size() ? kBase64Chars[chunk & 0x3f] : '=');
+  }
+  return out;
+}
+
+std::optional<std::vector<uint8_t>>
+BattleEventLog::from_base64(const std::string &text) {
+  if (text.size() % 4 != 0) {
+    return std::nullopt;
+  }
+
+  auto sextet = [](char c) -> int {
+    if (c >= 'A' && c <= 'Z')
+      return c - 'A';
+    if (c >= 'a' && c <= 'z')
+      return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+      return c - '0' + 52;
+    if (c == '+')
+      return 62;
+    if (c == '/')
+      return 63;
+    return -1;
+  };
+
+  std::vector<uint8_t> out;
+  out.reserve(text.size() / 4 * 3);
+  for (size_t i = 0; i < text.size(); i += 4) {
+    uint32_t chunk = 0;
+    int padding = 0;
+    for (size_t j = 0; j < 4; ++j) {
+      char c = text[i + j];
+      int value = 0;
+      if (c == '=' && i + 4 == text.size() && j >= 2) {
+        padding++;
+      } else if (padding > 0 || (value = sextet(c)) < 0) {
+        return std::nullopt;
+      }
+      chunk = (chunk << 6) | static_cast<uint32_t>(value);
+    }
+
+    out.push_back(static_cast<uint8_t>(chunk >> 16));
+    if (padding < 2)
+      out.push_back(static_cast<uint8_t>(chunk >> 8));
+    if (padding < 1)
+      out.push_back(static_cast<uint8_t>(chunk));
+  }
+  return out;
+}
+
+nlohmann::json BattleEventLog::to_json(
+    const std::vector<server::async::DebugBattleEvent> &events) {
+  nlohmann::json events_array = nlohmann::json::array();
+
+  for (const server::async::DebugBattleEvent &ev : events) {
+    nlohmann::json event_json;
+    event_json["hook"] = std::string(magic_enum::enum_name(ev.hook));
+    event_json["sourceEntityId"] = ev.sourceEntityId;
+    event_json["slotIndex"] = ev.slotIndex;
+
+    std::string team_side_str;
+    switch (ev.teamSide) {
+    case DishBattleState::TeamSide::Player:
+      team_side_str = "Player";
+      break;
+    case DishBattleState::TeamSide::Opponent:
+      team_side_str = "Opponent";
+      break;
+    }
+    event_json["teamSide"] = team_side_str;
+
+    event_json["timestamp"] = ev.timestamp;
+    event_json["courseIndex"] = ev.courseIndex;
+    event_json["payloadInt"] = ev.payloadInt;
+    event_json["payloadFloat"] = ev.payloadFloat;
+
+    events_array.push_back(event_json);
+  }
+
+  return events_array;
+}
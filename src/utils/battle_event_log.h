@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../server/async/battle_event.h"
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Compact binary battle-event log, appended to as events are tracked.
+//
+// Layout: "MNCE", a version byte, then one record per event:
+//   flags byte  bits 0-2 hook, bit 3 opponent side, bit 4 timestamp repeats
+//               the previous event, bit 5 payloadFloat present
+//   varint      timestamp delta (float bit pattern, zigzag), unless repeated
+//   varint      sourceEntityId, slotIndex, courseIndex, payloadInt (zigzag)
+//   4 bytes     payloadFloat (little endian), if present
+struct BattleEventLog {
+  static constexpr uint8_t kVersion = 1;
+
+  BattleEventLog() { clear(); }
+
+  void append(const server::async::DebugBattleEvent &ev);
+  void clear();
+
+  const std::vector<uint8_t> &bytes() const { return data; }
+  size_t size() const { return count; }
+
+  static std::optional<std::vector<server::async::DebugBattleEvent>>
+  decode(const std::vector<uint8_t> &bytes);
+
+  static std::string to_base64(const std::vector<uint8_t> &bytes);
+  static std::optional<std::vector<uint8_t>>
+  from_base64(const std::string &text);
+
+  // Opt-in JSON rendering, one object per event
+  static nlohmann::json
+  to_json(const std::vector<server::async::DebugBattleEvent> &events);
+
+private:
+  std::vector<uint8_t> data;
+  size_t count = 0;
+  uint32_t last_timestamp_bits = 0;
+};
@@ -1,98 +1,76 @@
 #pragma once
 
+#include "../components/combat_queue.h"
 #include "../components/combat_stats.h"
 #include "../components/dish_battle_state.h"
 #include "../components/dish_level.h"
 #include "../components/is_dish.h"
 #include "../components/pairing_clash_modifiers.h"
 #include "../components/persistent_combat_modifiers.h"
+#include "../components/replay_state.h"
 #include "../components/trigger_queue.h"
 #include "../query.h"
+#include "game_state_checksum.h"
 #include <afterhours/ah.h>
 #include <algorithm>
-#include <functional>
 #include <iomanip>
 #include <nlohmann/json.hpp>
 #include <sstream>
 #include <string>
 #include <vector>
 
+// Hash of the battle-relevant dish state. Checkpoints are recorded on the
+// CombatQueue at the start, after each course and at the end, and folded
+// into a rolling hash that serves as the battle checksum, so the client and
+// server can find the first checkpoint where their simulations diverged.
 struct BattleFingerprint {
   static uint64_t compute() {
+    // Per-dish hashes are mixed and summed, so the result doesn't depend on
+    // query order and needs no copy or sort of the dish list
     uint64_t hash = 0;
 
-    std::vector<struct DishData> dishes;
-
     for (afterhours::Entity &e : afterhours::EntityQuery()
                                      .whereHasComponent<IsDish>()
                                      .whereHasComponent<DishBattleState>()
                                      .gen()) {
-      DishData data;
-      data.entityId = e.id;
-
-      const IsDish &dish = e.get<IsDish>();
-      data.dishType = static_cast<int>(dish.type);
-
-      if (e.has<DishLevel>()) {
-        const DishLevel &lvl = e.get<DishLevel>();
-        data.level = lvl.level;
+      // Already gone as far as the battle is concerned, e.g. dishes a
+      // snapshot restore dropped
+      if (e.cleanup) {
+        continue;
       }
-
       const DishBattleState &dbs = e.get<DishBattleState>();
-      data.teamSide = static_cast<int>(dbs.team_side);
-      data.queueIndex = dbs.queue_index;
-      data.phase = static_cast<int>(dbs.phase);
-      data.onServeFired = dbs.onserve_fired;
+      uint64_t dish = 0;
+      dish = combine_hash(dish, static_cast<uint64_t>(e.id));
+      dish = combine_hash(dish, static_cast<int>(e.get<IsDish>().type));
+      dish = combine_hash(dish, e.has<DishLevel>() ? e.get<DishLevel>().level
+                                                   : 1);
+      dish = combine_hash(dish, static_cast<int>(dbs.team_side));
+      dish = combine_hash(dish, dbs.queue_index);
+      dish = combine_hash(dish, static_cast<int>(dbs.phase));
+      dish = combine_hash(dish, dbs.onserve_fired ? 1 : 0);
 
       if (e.has<CombatStats>()) {
         const CombatStats &cs = e.get<CombatStats>();
-        data.baseZing = cs.baseZing;
-        data.baseBody = cs.baseBody;
-        data.currentZing = cs.currentZing;
-        data.currentBody = cs.currentBody;
+        dish = combine_hash(dish, cs.baseZing);
+        dish = combine_hash(dish, cs.baseBody);
+        dish = combine_hash(dish, cs.currentZing);
+        dish = combine_hash(dish, cs.currentBody);
       }
 
       if (e.has<PairingClashModifiers>()) {
         const PairingClashModifiers &pcm = e.get<PairingClashModifiers>();
-        data.pairingZing = pcm.zingDelta;
-        data.pairingBody = pcm.bodyDelta;
+        dish = combine_hash(dish, pcm.zingDelta);
+        dish = combine_hash(dish, pcm.bodyDelta);
       }
 
       if (e.has<PersistentCombatModifiers>()) {
         const PersistentCombatModifiers &pcm =
             e.get<PersistentCombatModifiers>();
-        data.persistZing = pcm.zingDelta;
-        data.persistBody = pcm.bodyDelta;
+        dish = combine_hash(dish, pcm.zingDelta);
+        dish = combine_hash(dish, pcm.bodyDelta);
       }
 
-      dishes.push_back(data);
-    }
-
-    std::sort(dishes.begin(), dishes.end(),
-              [](const DishData &a, const DishData &b) {
-                if (a.teamSide != b.teamSide)
-                  return a.teamSide < b.teamSide;
-                if (a.queueIndex != b.queueIndex)
-                  return a.queueIndex < b.queueIndex;
-                return a.entityId < b.entityId;
-              });
-
-    for (const auto &dish : dishes) {
-      hash = combine_hash(hash, dish.entityId);
-      hash = combine_hash(hash, dish.dishType);
-      hash = combine_hash(hash, dish.level);
-      hash = combine_hash(hash, dish.teamSide);
-      hash = combine_hash(hash, dish.queueIndex);
-      hash = combine_hash(hash, dish.phase);
-      hash = combine_hash(hash, dish.onServeFired ? 1 : 0);
-      hash = combine_hash(hash, dish.baseZing);
-      hash = combine_hash(hash, dish.baseBody);
-      hash = combine_hash(hash, dish.currentZing);
-      hash = combine_hash(hash, dish.currentBody);
-      hash = combine_hash(hash, dish.pairingZing);
-      hash = combine_hash(hash, dish.pairingBody);
-      hash = combine_hash(hash, dish.persistZing);
-      hash = combine_hash(hash, dish.persistBody);
+      hash += mix(dish);
     }
 
     if (auto tq = afterhours::EntityHelper::get_singleton<TriggerQueue>();
@@ -104,40 +82,107 @@ struct BattleFingerprint {
     return hash;
   }
 
+  // Hashes the current state and appends it to the CombatQueue checkpoints
+  static uint64_t checkpoint(const std::string &label) {
+    uint64_t fp = compute();
+    log_info("AUDIT_FP checkpoint={} hash={}", label, fp);
+
+    auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+    if (!cq_entity.get().has<CombatQueue>()) {
+      return fp;
+    }
+    CombatQueue &cq = cq_entity.get().get<CombatQueue>();
+    cq.fingerprint_checkpoints.push_back({label, fp});
+    cq.fingerprint = combine_hash(cq.fingerprint, fp);
+
+    report_divergence(cq);
+    return fp;
+  }
+
+  // Rolling hash over every checkpoint, recording the "end" checkpoint if
+  // the battle finished without one
+  static uint64_t final_hash() {
+    auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+    if (!cq_entity.get().has<CombatQueue>()) {
+      return compute();
+    }
+    const CombatQueue &cq = cq_entity.get().get<CombatQueue>();
+    if (cq.fingerprint_checkpoints.empty() ||
+        cq.fingerprint_checkpoints.back().label != "end") {
+      checkpoint("end");
+    }
+    return cq.fingerprint;
+  }
+
+  static std::vector<std::string> checkpoint_hashes() {
+    std::vector<std::string> hashes;
+    auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+    if (!cq_entity.get().has<CombatQueue>()) {
+      return hashes;
+    }
+    for (const FingerprintCheckpoint &cp :
+         cq_entity.get().get<CombatQueue>().fingerprint_checkpoints) {
+      hashes.push_back(to_hex(cp.hash));
+    }
+    return hashes;
+  }
+
+  // Index of the first checkpoint that differs, or -1 if the lists match
+  static int first_divergence(const std::vector<std::string> &a,
+                              const std::vector<std::string> &b) {
+    size_t common = std::min(a.size(), b.size());
+    for (size_t i = 0; i < common; ++i) {
+      if (a[i] != b[i]) {
+        return static_cast<int>(i);
+      }
+    }
+    return a.size() == b.size() ? -1 : static_cast<int>(common);
+  }
+
+  static std::string to_hex(uint64_t hash) {
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << hash;
+    return ss.str();
+  }
+
   static uint64_t combine_hash(uint64_t hash, uint64_t value) {
     hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
     return hash;
   }
 
 private:
-  struct DishData {
-    int entityId = 0;
-    int dishType = 0;
-    int level = 1;
-    int teamSide = 0;
-    int queueIndex = 0;
-    int phase = 0;
-    bool onServeFired = false;
-    int baseZing = 0;
-    int baseBody = 0;
-    int currentZing = 0;
-    int currentBody = 0;
-    int pairingZing = 0;
-    int pairingBody = 0;
-    int persistZing = 0;
-    int persistBody = 0;
-  };
-};
+  // splitmix64 finalizer
+  static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+  }
 
-constexpr const char *GAME_STATE_CLIENT_VERSION = "0.1.0";
+  // Warns once, at the first client checkpoint that doesn't match the
+  // server's. The server has no serverCheckpoints, so this is a no-op there.
+  static void report_divergence(const CombatQueue &cq) {
+    auto replay_entity = afterhours::EntityHelper::get_singleton<ReplayState>();
+    if (!replay_entity.get().has<ReplayState>()) {
+      return;
+    }
+    const ReplayState &replay = replay_entity.get().get<ReplayState>();
+    size_t index = cq.fingerprint_checkpoints.size() - 1;
+    if (index >= replay.serverCheckpoints.size()) {
+      return;
+    }
 
-inline std::string compute_game_state_checksum(const nlohmann::json &state) {
-  std::string json_str = state.dump();
-  uint64_t hash = 0;
-  for (char c : json_str) {
-    hash = BattleFingerprint::combine_hash(hash, static_cast<uint64_t>(c));
+    std::vector<std::string> ours = checkpoint_hashes();
+    std::vector<std::string> theirs(replay.serverCheckpoints.begin(),
+                                    replay.serverCheckpoints.begin() +
+                                        static_cast<long>(index) + 1);
+    if (first_divergence(ours, theirs) == static_cast<int>(index)) {
+      log_warn("AUDIT_FP diverged from server at checkpoint {} ({}): "
+               "client={} server={}",
+               index, cq.fingerprint_checkpoints[index].label, ours[index],
+               theirs[index]);
+    }
   }
-  std::stringstream ss;
-  ss << std::hex << std::setfill('0') << std::setw(16) << hash;
-  return ss.str();
-}
+};
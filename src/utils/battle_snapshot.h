@@ -0,0 +1,362 @@
+#pragma once
+
+#include "../components/animation_event.h"
+#include "../components/battle_processor.h"
+#include "../components/combat_queue.h"
+#include "../components/combat_stats.h"
+#include "../components/deferred_flavor_mods.h"
+#include "../components/dish_battle_state.h"
+#include "../components/next_damage_effect.h"
+#include "../components/pairing_clash_modifiers.h"
+#include "../components/pending_combat_mods.h"
+#include "../components/persistent_combat_modifiers.h"
+#include "../components/pre_battle_modifiers.h"
+#include "../components/replay_snapshots.h"
+#include "../components/status_effects.h"
+#include "../components/transform.h"
+#include "../components/trigger_queue.h"
+#include "../query.h"
+#include "../seeded_rng.h"
+#include "../shop.h"
+#include "../systems/SimplifiedOnServeSystem.h"
+#include "battle_fingerprint.h"
+#include <afterhours/ah.h>
+#include <optional>
+#include <set>
+#include <string>
+
+// Captures the battle state that the combat systems read and write (dish
+// phases and stats, modifiers, the combat and trigger queues, pending
+// animations and the RNG) and writes it back onto the same entities, so a
+// replay can jump to a snapshot instead of re-simulating from the start.
+struct BattleSnapshotter {
+  static BattleSnapshot capture(const std::string &label, int64_t clock_ms,
+                                int64_t frame) {
+    BattleSnapshot snapshot;
+    snapshot.label = label;
+    snapshot.clock_ms = clock_ms;
+    snapshot.frame = frame;
+    snapshot.fingerprint = BattleFingerprint::compute();
+
+    if (auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+        cq_entity.get().has<CombatQueue>()) {
+      const CombatQueue &cq = cq_entity.get().get<CombatQueue>();
+      snapshot.course = cq.current_index;
+      snapshot.total_courses = cq.total_courses;
+      snapshot.complete = cq.complete;
+      snapshot.current_player_dish_id = cq.current_player_dish_id;
+      snapshot.current_opponent_dish_id = cq.current_opponent_dish_id;
+      snapshot.checkpoints = cq.fingerprint_checkpoints;
+      snapshot.checkpoint_hash = cq.fingerprint;
+    }
+
+    if (auto tq = afterhours::EntityHelper::get_singleton<TriggerQueue>();
+        tq.get().has<TriggerQueue>()) {
+      for (const TriggerEvent &ev : tq.get().get<TriggerQueue>().events) {
+        snapshot.triggers.push_back({ev.hook, ev.sourceEntityId, ev.slotIndex,
+                                     ev.teamSide, ev.payloadInt,
+                                     ev.payloadFloat});
+      }
+    }
+
+    for (afterhours::Entity &e :
+         afterhours::EntityQuery({.ignore_temp_warning = true})
+             .whereHasComponent<OnServeState>()
+             .gen()) {
+      snapshot.onserve_all_fired = e.get<OnServeState>().allFired;
+      break;
+    }
+
+    SeededRng &rng = SeededRng::get();
+    snapshot.rng = rng.gen;
+    snapshot.rng_seed = rng.seed;
+
+    for (afterhours::Entity &e :
+         afterhours::EntityQuery({.ignore_temp_warning = true})
+             .whereHasComponent<DishBattleState>()
+             .gen()) {
+      snapshot.dishes.push_back(capture_dish(e));
+    }
+
+    for (afterhours::Entity &e :
+         afterhours::EntityQuery({.ignore_temp_warning = true})
+             .whereHasComponent<AnimationEvent>()
+             .gen()) {
+      const AnimationEvent &ev = e.get<AnimationEvent>();
+      snapshot.animations.push_back({ev.type, ev.slotIndex, ev.entityId,
+                                     ev.data,
+                                     e.has<IsBlockingAnimationEvent>()});
+    }
+
+    if (afterhours::EntityHelper::has_singleton<BattleProcessor>()) {
+      const BattleProcessor &processor =
+          afterhours::EntityHelper::get_singleton<BattleProcessor>()
+              .get()
+              .get<BattleProcessor>();
+      BattleSnapshot::Processor saved;
+      saved.playerDishes = processor.playerDishes;
+      saved.opponentDishes = processor.opponentDishes;
+      saved.outcomes = processor.outcomes;
+      saved.currentCourse = processor.currentCourse;
+      saved.totalCourses = processor.totalCourses;
+      saved.simulationComplete = processor.simulationComplete;
+      saved.playerWins = processor.playerWins;
+      saved.opponentWins = processor.opponentWins;
+      saved.ties = processor.ties;
+      saved.simulationStarted = processor.simulationStarted;
+      saved.simulationTime = processor.simulationTime;
+      saved.finished = processor.finished;
+      snapshot.processor = std::move(saved);
+    }
+
+    return snapshot;
+  }
+
+  // Returns false, leaving the world partly restored, if a dish from the
+  // snapshot no longer exists or the restored state doesn't hash the same;
+  // callers fall back to reloading the battle.
+  static bool restore(const BattleSnapshot &snapshot) {
+    std::set<int> ids;
+    for (const BattleSnapshot::Dish &dish : snapshot.dishes) {
+      auto opt = EQ::find_by_id(dish.id);
+      if (!opt) {
+        log_warn("REPLAY_SEEK snapshot {} dish {} no longer exists",
+                 snapshot.label, dish.id);
+        return false;
+      }
+      restore_dish(opt.asE(), dish);
+      ids.insert(dish.id);
+    }
+
+    // Dishes created after the snapshot was taken
+    for (afterhours::Entity &e :
+         afterhours::EntityQuery({.ignore_temp_warning = true})
+             .whereHasComponent<DishBattleState>()
+             .gen()) {
+      if (!ids.contains(e.id)) {
+        e.cleanup = true;
+      }
+    }
+
+    if (auto cq_entity = afterhours::EntityHelper::get_singleton<CombatQueue>();
+        cq_entity.get().has<CombatQueue>()) {
+      CombatQueue &cq = cq_entity.get().get<CombatQueue>();
+      cq.current_index = snapshot.course;
+      cq.total_courses = snapshot.total_courses;
+      cq.complete = snapshot.complete;
+      cq.current_player_dish_id = snapshot.current_player_dish_id;
+      cq.current_opponent_dish_id = snapshot.current_opponent_dish_id;
+      cq.fingerprint_checkpoints = snapshot.checkpoints;
+      cq.fingerprint = snapshot.checkpoint_hash;
+    }
+
+    if (auto tq = afterhours::EntityHelper::get_singleton<TriggerQueue>();
+        tq.get().has<TriggerQueue>()) {
+      TriggerQueue &queue = tq.get().get<TriggerQueue>();
+      queue.clear();
+      for (const BattleSnapshot::Trigger &trigger : snapshot.triggers) {
+        queue.add_event(trigger.hook, trigger.sourceEntityId,
+                        trigger.slotIndex, trigger.teamSide);
+        queue.events.back().payloadInt = trigger.payloadInt;
+        queue.events.back().payloadFloat = trigger.payloadFloat;
+      }
+    }
+
+    bool has_onserve = false;
+    for (afterhours::Entity &e :
+         afterhours::EntityQuery({.ignore_temp_warning = true})
+             .whereHasComponent<OnServeState>()
+             .gen()) {
+      if (snapshot.onserve_all_fired) {
+        e.get<OnServeState>().allFired = *snapshot.onserve_all_fired;
+        has_onserve = true;
+      } else {
+        e.removeComponent<OnServeState>();
+      }
+    }
+    if (snapshot.onserve_all_fired && !has_onserve) {
+      afterhours::Entity &e = afterhours::EntityHelper::createEntity();
+      e.addComponent<OnServeState>();
+      e.get<OnServeState>().allFired = *snapshot.onserve_all_fired;
+    }
+
+    SeededRng &rng = SeededRng::get();
+    rng.gen = snapshot.rng;
+    rng.seed = snapshot.rng_seed;
+
+    if (snapshot.processor &&
+        afterhours::EntityHelper::has_singleton<BattleProcessor>()) {
+      BattleProcessor &processor =
+          afterhours::EntityHelper::get_singleton<BattleProcessor>()
+              .get()
+              .get<BattleProcessor>();
+      const BattleSnapshot::Processor &saved = *snapshot.processor;
+      processor.playerDishes = saved.playerDishes;
+      processor.opponentDishes = saved.opponentDishes;
+      processor.outcomes = saved.outcomes;
+      processor.currentCourse = saved.currentCourse;
+      processor.totalCourses = saved.totalCourses;
+      processor.simulationComplete = saved.simulationComplete;
+      processor.playerWins = saved.playerWins;
+      processor.opponentWins = saved.opponentWins;
+      processor.ties = saved.ties;
+      processor.simulationStarted = saved.simulationStarted;
+      processor.simulationTime = saved.simulationTime;
+      processor.finished = saved.finished;
+    }
+
+    // In-flight animations are restarted from the beginning
+    for (afterhours::Entity &e :
+         afterhours::EntityQuery({.ignore_temp_warning = true})
+             .whereHasComponent<AnimationEvent>()
+             .gen()) {
+      e.cleanup = true;
+    }
+    for (const BattleSnapshot::Animation &animation : snapshot.animations) {
+      afterhours::Entity &e =
+          make_animation_event(animation.type, animation.blocking);
+      AnimationEvent &ev = e.get<AnimationEvent>();
+      ev.slotIndex = animation.slotIndex;
+      ev.entityId = animation.entityId;
+      ev.data = animation.data;
+    }
+
+    uint64_t fingerprint = BattleFingerprint::compute();
+    if (fingerprint != snapshot.fingerprint) {
+      log_warn("REPLAY_SEEK snapshot {} restored with hash {} but was "
+               "captured with {}",
+               snapshot.label, fingerprint, snapshot.fingerprint);
+      return false;
+    }
+    return true;
+  }
+
+private:
+  template <typename T>
+  static std::optional<BattleSnapshot::StatDelta>
+  capture_delta(const afterhours::Entity &e) {
+    if (!e.has<T>()) {
+      return std::nullopt;
+    }
+    const T &mods = e.get<T>();
+    return BattleSnapshot::StatDelta{mods.zingDelta, mods.bodyDelta};
+  }
+
+  template <typename T>
+  static void
+  restore_delta(afterhours::Entity &e,
+                const std::optional<BattleSnapshot::StatDelta> &delta) {
+    if (!delta) {
+      if (e.has<T>()) {
+        e.removeComponent<T>();
+      }
+      return;
+    }
+    T &mods = e.addComponentIfMissing<T>();
+    mods.zingDelta = delta->zing;
+    mods.bodyDelta = delta->body;
+  }
+
+  static BattleSnapshot::Dish capture_dish(const afterhours::Entity &e) {
+    BattleSnapshot::Dish dish;
+    dish.id = e.id;
+    const DishBattleState &dbs = e.get<DishBattleState>();
+    dish.team_side = dbs.team_side;
+    dish.queue_index = dbs.queue_index;
+    dish.phase = dbs.phase;
+    dish.enter_progress = dbs.enter_progress;
+    dish.bite_timer = dbs.bite_timer;
+    dish.players_turn = dbs.players_turn;
+    dish.first_bite_decided = dbs.first_bite_decided;
+    dish.onserve_fired = dbs.onserve_fired;
+    dish.bite_cadence = dbs.bite_cadence;
+    dish.bite_cadence_timer = dbs.bite_cadence_timer;
+
+    if (e.has<CombatStats>()) {
+      const CombatStats &cs = e.get<CombatStats>();
+      dish.stats = BattleSnapshot::Stats{cs.baseZing, cs.baseBody,
+                                         cs.currentZing, cs.currentBody};
+    }
+    dish.pre_battle = capture_delta<PreBattleModifiers>(e);
+    dish.pairing_clash = capture_delta<PairingClashModifiers>(e);
+    dish.persistent = capture_delta<PersistentCombatModifiers>(e);
+    dish.pending = capture_delta<PendingCombatMods>(e);
+
+    if (e.has<NextDamageEffect>()) {
+      const NextDamageEffect &nde = e.get<NextDamageEffect>();
+      dish.next_damage = BattleSnapshot::NextDamage{
+          nde.multiplier, nde.flatModifier, nde.count};
+    }
+    if (e.has<DeferredFlavorMods>()) {
+      const DeferredFlavorMods &dfm = e.get<DeferredFlavorMods>();
+      dish.flavor_mods = BattleSnapshot::FlavorMods{
+          dfm.satiety, dfm.sweetness, dfm.spice,    dfm.acidity,
+          dfm.umami,   dfm.richness,  dfm.freshness};
+    }
+    if (e.has<StatusEffects>()) {
+      dish.status_effects = e.get<StatusEffects>().effects;
+    }
+    if (e.has<Transform>()) {
+      dish.position = e.get<Transform>().position;
+    }
+    return dish;
+  }
+
+  static void restore_dish(afterhours::Entity &e,
+                           const BattleSnapshot::Dish &dish) {
+    DishBattleState &dbs = e.get<DishBattleState>();
+    dbs.team_side = dish.team_side;
+    dbs.queue_index = dish.queue_index;
+    dbs.phase = dish.phase;
+    dbs.enter_progress = dish.enter_progress;
+    dbs.bite_timer = dish.bite_timer;
+    dbs.players_turn = dish.players_turn;
+    dbs.first_bite_decided = dish.first_bite_decided;
+    dbs.onserve_fired = dish.onserve_fired;
+    dbs.bite_cadence = dish.bite_cadence;
+    dbs.bite_cadence_timer = dish.bite_cadence_timer;
+
+    if (dish.stats) {
+      CombatStats &cs = e.addComponentIfMissing<CombatStats>();
+      cs.baseZing = dish.stats->baseZing;
+      cs.baseBody = dish.stats->baseBody;
+      cs.currentZing = dish.stats->currentZing;
+      cs.currentBody = dish.stats->currentBody;
+    } else if (e.has<CombatStats>()) {
+      e.removeComponent<CombatStats>();
+    }
+    restore_delta<PreBattleModifiers>(e, dish.pre_battle);
+    restore_delta<PairingClashModifiers>(e, dish.pairing_clash);
+    restore_delta<PersistentCombatModifiers>(e, dish.persistent);
+    restore_delta<PendingCombatMods>(e, dish.pending);
+
+    if (dish.next_damage) {
+      NextDamageEffect &nde = e.addComponentIfMissing<NextDamageEffect>();
+      nde.multiplier = dish.next_damage->multiplier;
+      nde.flatModifier = dish.next_damage->flatModifier;
+      nde.count = dish.next_damage->count;
+    } else if (e.has<NextDamageEffect>()) {
+      e.removeComponent<NextDamageEffect>();
+    }
+    if (dish.flavor_mods) {
+      DeferredFlavorMods &dfm = e.addComponentIfMissing<DeferredFlavorMods>();
+      dfm.satiety = dish.flavor_mods->satiety;
+      dfm.sweetness = dish.flavor_mods->sweetness;
+      dfm.spice = dish.flavor_mods->spice;
+      dfm.acidity = dish.flavor_mods->acidity;
+      dfm.umami = dish.flavor_mods->umami;
+      dfm.richness = dish.flavor_mods->richness;
+      dfm.freshness = dish.flavor_mods->freshness;
+    } else if (e.has<DeferredFlavorMods>()) {
+      e.removeComponent<DeferredFlavorMods>();
+    }
+    if (dish.status_effects) {
+      e.addComponentIfMissing<StatusEffects>().effects = *dish.status_effects;
+    } else if (e.has<StatusEffects>()) {
+      e.removeComponent<StatusEffects>();
+    }
+    if (dish.position && e.has<Transform>()) {
+      e.get<Transform>().position = *dish.position;
+    }
+  }
+};
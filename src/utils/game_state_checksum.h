@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <string>
+
+// Bumped whenever the checksum changes. 0.1.0 hashed the whole state in one
+// pass; its checksums don't match this algorithm's.
+constexpr const char *GAME_STATE_CLIENT_VERSION = "0.2.0";
+
+// Checksum of a saved game state shared by the client and the server. Each
+// top-level member is hashed on its own and the mixed hashes are summed, so
+// the server can update the checksum after a delta by rehashing only the
+// members the delta touched. A top-level "checksum" member is ignored.
+struct GameStateChecksum {
+  static uint64_t member_hash(const std::string &key,
+                              const nlohmann::json &value) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto feed = [&hash](const std::string &bytes) {
+      for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+      }
+    };
+    feed(key);
+    hash ^= 0xff;
+    hash *= 0x100000001b3ULL;
+    feed(value.dump());
+    return mix(hash);
+  }
+
+  static uint64_t hash(const nlohmann::json &state) {
+    if (!state.is_object()) {
+      return member_hash("", state);
+    }
+    uint64_t total = 0;
+    for (auto it = state.begin(); it != state.end(); ++it) {
+      if (it.key() != "checksum") {
+        total += member_hash(it.key(), it.value());
+      }
+    }
+    return total;
+  }
+
+  static std::string to_hex(uint64_t hash) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx",
+                  static_cast<unsigned long long>(hash));
+    return buffer;
+  }
+
+private:
+  // splitmix64 finalizer
+  static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+  }
+};
+
+inline std::string compute_game_state_checksum(const nlohmann::json &state) {
+  return GameStateChecksum::to_hex(GameStateChecksum::hash(state));
+}
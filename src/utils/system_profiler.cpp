@@ -0,0 +1,306 @@
+#include "system_profiler.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+constexpr double kSmoothing = 0.05;
+
+void add_into(SystemProfiler::SystemStats &into,
+              const SystemProfiler::SystemStats &from) {
+  into.runs += from.runs;
+  into.should_run_ns += from.should_run_ns;
+  into.once_ns += from.once_ns;
+  into.for_each_ns += from.for_each_ns;
+  into.after_ns += from.after_ns;
+  into.entities += from.entities;
+  into.max_frame_ns = std::max(into.max_frame_ns, from.max_frame_ns);
+  into.smoothed_ns = std::max(into.smoothed_ns, from.smoothed_ns);
+}
+
+void clear_counters(SystemProfiler::SystemStats &stats) {
+  std::string name = std::move(stats.name);
+  double smoothed = stats.smoothed_ns;
+  stats = SystemProfiler::SystemStats{};
+  stats.name = std::move(name);
+  stats.smoothed_ns = smoothed;
+}
+
+double to_us(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+} // namespace
+
+nlohmann::json SystemProfiler::SystemStats::to_json() const {
+  return nlohmann::json{{"name", name},
+                        {"runs", runs},
+                        {"shouldRunNs", should_run_ns},
+                        {"onceNs", once_ns},
+                        {"forEachNs", for_each_ns},
+                        {"afterNs", after_ns},
+                        {"totalNs", total_ns()},
+                        {"entities", entities},
+                        {"maxFrameNs", max_frame_ns}};
+}
+
+SystemProfiler::SystemProfiler() : epoch(std::chrono::steady_clock::now()) {
+  for (uint32_t slot = 0; slot < kMaxSystems; ++slot) {
+    current[slot].system = slot;
+  }
+}
+
+SystemProfiler &SystemProfiler::get() {
+  static SystemProfiler instance;
+  return instance;
+}
+
+// Samples left over from before profiling was switched off are cleared by
+// the recording thread in begin_frame
+void SystemProfiler::set_enabled(bool enable) {
+  on.store(enable, std::memory_order_relaxed);
+}
+
+void SystemProfiler::clear_samples() {
+  uint32_t count = registered.load(std::memory_order_acquire);
+  for (uint32_t slot = 0; slot < count; ++slot) {
+    current[slot] = Sample{};
+    current[slot].system = slot;
+  }
+}
+
+uint32_t SystemProfiler::register_system(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto existing = slots.find(name);
+  if (existing != slots.end()) {
+    return existing->second;
+  }
+
+  if (totals.size() >= kMaxSystems) {
+    slots[name] = kMaxSystems - 1;
+    return kMaxSystems - 1;
+  }
+
+  uint32_t slot = static_cast<uint32_t>(totals.size());
+  slots[name] = slot;
+  SystemStats stats;
+  stats.name = name;
+  totals.push_back(std::move(stats));
+  registered.store(slot + 1, std::memory_order_release);
+  return slot;
+}
+
+uint64_t SystemProfiler::now_ns() const {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - epoch)
+          .count());
+}
+
+void SystemProfiler::begin_frame() {
+  bool enabled_now = enabled();
+  if (enabled_now && !was_on) {
+    clear_samples();
+  }
+  was_on = enabled_now;
+  if (enabled_now) {
+    frame_start_ns = now_ns();
+  }
+}
+
+void SystemProfiler::record_should_run(uint32_t slot, uint64_t start_ns,
+                                       uint64_t end_ns, bool ran) {
+  Sample &sample = current[slot];
+  if (!sample.seen) {
+    sample.seen = true;
+    sample.start_ns = start_ns;
+  }
+  sample.should_run_ns += end_ns - start_ns;
+  sample.ran = sample.ran || ran;
+}
+
+void SystemProfiler::record_once(uint32_t slot, uint64_t start_ns,
+                                 uint64_t end_ns) {
+  current[slot].once_ns += end_ns - start_ns;
+  once_end_ns[slot] = end_ns;
+}
+
+void SystemProfiler::record_after(uint32_t slot, uint64_t start_ns,
+                                  uint64_t end_ns) {
+  Sample &sample = current[slot];
+  // Everything between once returning and after starting is the for_each
+  // pass, so entities aren't timed one by one
+  sample.for_each_ns += start_ns - once_end_ns[slot];
+  sample.after_ns += end_ns - start_ns;
+}
+
+void SystemProfiler::end_frame() {
+  if (!enabled()) {
+    return;
+  }
+
+  uint32_t count = registered.load(std::memory_order_acquire);
+  Frame frame;
+  frame.index = frame_index++;
+  frame.start_ns = frame_start_ns;
+  frame.end_ns = now_ns();
+  for (uint32_t i = 0; i < count; ++i) {
+    if (current[i].seen) {
+      frame.samples.push_back(current[i]);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (size_t i = 0; i < count; ++i) {
+      const Sample &sample = current[i];
+      SystemStats &stats = totals[i];
+      uint64_t frame_ns = sample.seen ? sample.total_ns() : 0;
+      stats.smoothed_ns = stats.smoothed_ns * (1.0 - kSmoothing) +
+                          static_cast<double>(frame_ns) * kSmoothing;
+      if (!sample.seen) {
+        continue;
+      }
+      stats.runs += sample.ran ? 1 : 0;
+      stats.should_run_ns += sample.should_run_ns;
+      stats.once_ns += sample.once_ns;
+      stats.for_each_ns += sample.for_each_ns;
+      stats.after_ns += sample.after_ns;
+      stats.entities += sample.entities;
+      stats.max_frame_ns = std::max(stats.max_frame_ns, frame_ns);
+    }
+
+    frames.push_back(std::move(frame));
+    if (frames.size() > kTraceFrames) {
+      frames.pop_front();
+    }
+  }
+
+  clear_samples();
+  frame_start_ns = now_ns();
+}
+
+std::vector<SystemProfiler::SystemStats> SystemProfiler::stats() const {
+  std::vector<SystemStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::map<std::string, SystemStats> by_name = merged;
+    for (const SystemStats &stats : totals) {
+      SystemStats &into = by_name[stats.name];
+      into.name = stats.name;
+      add_into(into, stats);
+    }
+    for (auto &[name, stats] : by_name) {
+      result.push_back(std::move(stats));
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const SystemStats &a, const SystemStats &b) {
+              return a.total_ns() > b.total_ns();
+            });
+  return result;
+}
+
+nlohmann::json SystemProfiler::summary() const {
+  nlohmann::json systems = nlohmann::json::array();
+  for (const SystemStats &stats : this->stats()) {
+    systems.push_back(stats.to_json());
+  }
+  return systems;
+}
+
+nlohmann::json SystemProfiler::drain_summary() {
+  std::lock_guard<std::mutex> lock(mtx);
+  nlohmann::json systems = nlohmann::json::array();
+  for (SystemStats &stats : totals) {
+    if (stats.total_ns() > 0) {
+      systems.push_back(stats.to_json());
+    }
+    clear_counters(stats);
+  }
+  return systems;
+}
+
+void SystemProfiler::merge(const nlohmann::json &summary) {
+  if (!summary.is_array()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mtx);
+  for (const auto &item : summary) {
+    SystemStats from;
+    from.name = item.value("name", std::string(""));
+    from.runs = item.value("runs", uint64_t{0});
+    from.should_run_ns = item.value("shouldRunNs", uint64_t{0});
+    from.once_ns = item.value("onceNs", uint64_t{0});
+    from.for_each_ns = item.value("forEachNs", uint64_t{0});
+    from.after_ns = item.value("afterNs", uint64_t{0});
+    from.entities = item.value("entities", uint64_t{0});
+    from.max_frame_ns = item.value("maxFrameNs", uint64_t{0});
+
+    SystemStats &into = merged[from.name];
+    into.name = from.name;
+    add_into(into, from);
+  }
+}
+
+void SystemProfiler::reset() {
+  std::lock_guard<std::mutex> lock(mtx);
+  for (SystemStats &stats : totals) {
+    clear_counters(stats);
+    stats.smoothed_ns = 0.0;
+  }
+  merged.clear();
+  frames.clear();
+}
+
+nlohmann::json SystemProfiler::chrome_trace() const {
+  nlohmann::json events = nlohmann::json::array();
+  events.push_back({{"name", "thread_name"},
+                    {"ph", "M"},
+                    {"pid", 1},
+                    {"tid", 1},
+                    {"args", {{"name", "systems"}}}});
+
+  std::lock_guard<std::mutex> lock(mtx);
+  for (const Frame &frame : frames) {
+    events.push_back({{"name", "frame"},
+                      {"cat", "frame"},
+                      {"ph", "X"},
+                      {"ts", to_us(frame.start_ns)},
+                      {"dur", to_us(frame.end_ns - frame.start_ns)},
+                      {"pid", 1},
+                      {"tid", 1},
+                      {"args", {{"index", frame.index}}}});
+    for (const Sample &sample : frame.samples) {
+      if (!sample.ran) {
+        continue;
+      }
+      events.push_back({{"name", totals[sample.system].name},
+                        {"cat", "system"},
+                        {"ph", "X"},
+                        {"ts", to_us(sample.start_ns)},
+                        {"dur", to_us(sample.total_ns())},
+                        {"pid", 1},
+                        {"tid", 1},
+                        {"args",
+                         {{"entities", sample.entities},
+                          {"shouldRunUs", to_us(sample.should_run_ns)},
+                          {"onceUs", to_us(sample.once_ns)},
+                          {"forEachUs", to_us(sample.for_each_ns)},
+                          {"afterUs", to_us(sample.after_ns)}}}});
+    }
+  }
+  return nlohmann::json{{"traceEvents", std::move(events)},
+                        {"displayTimeUnit", "ms"}};
+}
+
+bool SystemProfiler::write_chrome_trace(const std::string &path) const {
+  std::filesystem::path file_path(path);
+  std::error_code ec;
+  if (file_path.has_parent_path()) {
+    std::filesystem::create_directories(file_path.parent_path(), ec);
+  }
+  std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    return false;
+  }
+  file << chrome_trace().dump();
+  return file.good();
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+// Per-system frame timings. ProfiledSystem wrappers report should_run, once,
+// the for_each pass and after for every system, plus how many entities the
+// for_each pass visited. Frames are aggregated into per-system totals, kept
+// for a few hundred frames for Chrome trace export (chrome://tracing or
+// Perfetto), and smoothed for the in-game overlay.
+//
+// Recording happens on the thread that runs the SystemManager; summaries,
+// merges, registration and toggling may come from any thread.
+struct SystemProfiler {
+  static constexpr size_t kTraceFrames = 600;
+  // Recording slots are allocated up front so registering a system never
+  // moves a slot another thread is recording into. Past this many, systems
+  // share the last slot.
+  static constexpr uint32_t kMaxSystems = 512;
+
+  struct Sample {
+    uint32_t system = 0;
+    uint64_t start_ns = 0;
+    uint64_t should_run_ns = 0;
+    uint64_t once_ns = 0;
+    uint64_t for_each_ns = 0;
+    uint64_t after_ns = 0;
+    uint64_t entities = 0;
+    bool seen = false;
+    bool ran = false;
+
+    uint64_t total_ns() const {
+      return should_run_ns + once_ns + for_each_ns + after_ns;
+    }
+  };
+
+  struct Frame {
+    uint64_t index = 0;
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+    std::vector<Sample> samples;
+  };
+
+  struct SystemStats {
+    std::string name;
+    // Frames in which should_run returned true
+    uint64_t runs = 0;
+    uint64_t should_run_ns = 0;
+    uint64_t once_ns = 0;
+    uint64_t for_each_ns = 0;
+    uint64_t after_ns = 0;
+    uint64_t entities = 0;
+    uint64_t max_frame_ns = 0;
+    // Exponential moving average of per-frame time, for the overlay
+    double smoothed_ns = 0.0;
+
+    uint64_t total_ns() const {
+      return should_run_ns + once_ns + for_each_ns + after_ns;
+    }
+    nlohmann::json to_json() const;
+  };
+
+  static SystemProfiler &get();
+
+  bool enabled() const { return on.load(std::memory_order_relaxed); }
+  void set_enabled(bool enable);
+
+  // Returns the slot a wrapper records into. Systems with the same name,
+  // such as one per pooled battle context, share a slot.
+  uint32_t register_system(const std::string &name);
+
+  void begin_frame();
+  void end_frame();
+
+  uint64_t now_ns() const;
+  void record_should_run(uint32_t slot, uint64_t start_ns, uint64_t end_ns,
+                         bool ran);
+  void record_once(uint32_t slot, uint64_t start_ns, uint64_t end_ns);
+  void record_entity(uint32_t slot) { current[slot].entities++; }
+  void record_after(uint32_t slot, uint64_t start_ns, uint64_t end_ns);
+
+  // Totals sorted by total time, slowest first
+  std::vector<SystemStats> stats() const;
+  nlohmann::json summary() const;
+  // Returns summary() and clears the totals
+  nlohmann::json drain_summary();
+  // Adds a summary from another process (a battle world) into the totals
+  void merge(const nlohmann::json &summary);
+  void reset();
+
+  nlohmann::json chrome_trace() const;
+  bool write_chrome_trace(const std::string &path) const;
+
+private:
+  SystemProfiler();
+
+  std::atomic<bool> on{false};
+  std::chrono::steady_clock::time_point epoch;
+  // Recording thread only
+  bool was_on = false;
+  uint64_t frame_index = 0;
+  uint64_t frame_start_ns = 0;
+  // Samples of the frame being recorded, one per slot; recording thread only
+  std::array<Sample, kMaxSystems> current{};
+  std::array<uint64_t, kMaxSystems> once_end_ns{};
+  // Slots in use, published after registration fills in totals
+  std::atomic<uint32_t> registered{0};
+
+  void clear_samples();
+
+  mutable std::mutex mtx;
+  // Systems run by this process, indexed by slot
+  std::vector<SystemStats> totals;
+  // Totals reported by other processes, by name
+  std::map<std::string, SystemStats> merged;
+  std::map<std::string, uint32_t> slots;
+  std::deque<Frame> frames;
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+
+// Body encodings the battle API speaks. JSON stays the default; CBOR and
+// MessagePack are negotiated per request through Content-Type and Accept.
+// httplib only gzips text-like responses (JSON included) and never request
+// bodies, so large CBOR and MessagePack bodies are gzipped here and sent with
+// Content-Encoding: gzip. httplib inflates those on receipt in both
+// directions.
+namespace wire_format {
+
+enum struct Encoding { Json, Cbor, MsgPack };
+
+constexpr const char *kJsonType = "application/json";
+constexpr const char *kCborType = "application/cbor";
+constexpr const char *kMsgPackType = "application/msgpack";
+constexpr const char *kGzip = "gzip";
+// Smaller bodies fit in a packet or two either way, so gzip costs more CPU
+// than it saves
+constexpr size_t kGzipMinBytes = 1024;
+
+inline const char *content_type(Encoding encoding) {
+  switch (encoding) {
+  case Encoding::Json:
+    return kJsonType;
+  case Encoding::Cbor:
+    return kCborType;
+  case Encoding::MsgPack:
+    return kMsgPackType;
+  }
+  return kJsonType;
+}
+
+// Maps a single media type (parameters like "; charset=utf-8" ignored)
+inline std::optional<Encoding> from_media_type(const std::string &media_type) {
+  if (media_type.find(kJsonType) != std::string::npos) {
+    return Encoding::Json;
+  }
+  if (media_type.find(kCborType) != std::string::npos) {
+    return Encoding::Cbor;
+  }
+  if (media_type.find(kMsgPackType) != std::string::npos ||
+      media_type.find("application/x-msgpack") != std::string::npos) {
+    return Encoding::MsgPack;
+  }
+  return std::nullopt;
+}
+
+// Picks the first supported type listed in an Accept header, falling back
+// when the header is missing or only lists wildcards
+inline Encoding from_accept(const std::string &accept, Encoding fallback) {
+  size_t start = 0;
+  while (start < accept.size()) {
+    size_t end = accept.find(',', start);
+    if (end == std::string::npos) {
+      end = accept.size();
+    }
+    auto encoding = from_media_type(accept.substr(start, end - start));
+    if (encoding) {
+      return *encoding;
+    }
+    start = end + 1;
+  }
+  return fallback;
+}
+
+inline std::string encode(const nlohmann::json &body, Encoding encoding) {
+  std::vector<uint8_t> bytes;
+  switch (encoding) {
+  case Encoding::Json:
+    return body.dump();
+  case Encoding::Cbor:
+    bytes = nlohmann::json::to_cbor(body);
+    break;
+  case Encoding::MsgPack:
+    bytes = nlohmann::json::to_msgpack(body);
+    break;
+  }
+  return std::string(bytes.begin(), bytes.end());
+}
+
+// Throws nlohmann::json::exception on malformed bodies, like json::parse
+inline nlohmann::json decode(const std::string &body, Encoding encoding) {
+  switch (encoding) {
+  case Encoding::Json:
+    return nlohmann::json::parse(body);
+  case Encoding::Cbor:
+    return nlohmann::json::from_cbor(body.begin(), body.end());
+  case Encoding::MsgPack:
+    return nlohmann::json::from_msgpack(body.begin(), body.end());
+  }
+  return nlohmann::json::parse(body);
+}
+
+// Decodes a body using its Content-Type, treating unknown types as JSON
+inline nlohmann::json decode(const std::string &body,
+                             const std::string &content_type) {
+  return decode(body, from_media_type(content_type).value_or(Encoding::Json));
+}
+
+// Whether an Accept-Encoding header allows gzip. Like httplib, q-values
+// aren't parsed.
+inline bool accepts_gzip(const std::string &accept_encoding) {
+  return accept_encoding.find(kGzip) != std::string::npos;
+}
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+inline std::optional<std::string> gzip(const std::string &body) {
+  z_stream strm{};
+  // 15 window bits plus 16 asks zlib for a gzip header instead of zlib's
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return std::nullopt;
+  }
+  std::string out(deflateBound(&strm, static_cast<uLong>(body.size())), '\0');
+  strm.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(body.data()));
+  strm.avail_in = static_cast<uInt>(body.size());
+  strm.next_out = reinterpret_cast<Bytef *>(out.data());
+  strm.avail_out = static_cast<uInt>(out.size());
+  int ret = deflate(&strm, Z_FINISH);
+  size_t written = strm.total_out;
+  deflateEnd(&strm);
+  if (ret != Z_STREAM_END) {
+    return std::nullopt;
+  }
+  out.resize(written);
+  return out;
+}
+
+inline std::optional<std::string> gunzip(const std::string &body) {
+  z_stream strm{};
+  if (inflateInit2(&strm, 15 + 16) != Z_OK) {
+    return std::nullopt;
+  }
+  strm.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(body.data()));
+  strm.avail_in = static_cast<uInt>(body.size());
+  std::string out;
+  char buffer[16384];
+  int ret = Z_OK;
+  while (ret == Z_OK) {
+    strm.next_out = reinterpret_cast<Bytef *>(buffer);
+    strm.avail_out = sizeof(buffer);
+    ret = inflate(&strm, Z_NO_FLUSH);
+    out.append(buffer, sizeof(buffer) - strm.avail_out);
+  }
+  inflateEnd(&strm);
+  if (ret != Z_STREAM_END) {
+    return std::nullopt;
+  }
+  return out;
+}
+#endif
+
+// Gzips a binary body in place when it's large enough to be worth it.
+// Returns true when the body should be sent with Content-Encoding: gzip.
+// JSON is left alone since httplib already compresses JSON responses.
+inline bool gzip_if_large(std::string &body, Encoding encoding) {
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+  if (encoding == Encoding::Json || body.size() < kGzipMinBytes) {
+    return false;
+  }
+  std::optional<std::string> compressed = gzip(body);
+  if (!compressed || compressed->size() >= body.size()) {
+    return false;
+  }
+  body = std::move(*compressed);
+  return true;
+#else
+  (void)body;
+  (void)encoding;
+  return false;
+#endif
+}
+
+} // namespace wire_format